@@ -36,6 +36,7 @@ int main(int argc, const char **argv)
 	string devicename = "cpu";
 	bool list = false;
 	int threads = 0;
+	int cache_size = 1024;
 
 	vector<DeviceType>& types = Device::available_types();
 
@@ -53,6 +54,7 @@ int main(int argc, const char **argv)
 		"--device %s", &devicename, ("Devices to use: " + devicelist).c_str(),
 		"--list-devices", &list, "List information about all available devices",
 		"--threads %d", &threads, "Number of threads to use for CPU device",
+		"--cache-size %d", &cache_size, "Memory in MB for caching scene data between renders (default 1024)",
 		NULL);
 
 	if(ap.parse(argc, argv) < 0) {
@@ -92,7 +94,7 @@ int main(int argc, const char **argv)
 		Stats stats;
 		Device *device = Device::create(device_info, stats, true);
 		printf("Cycles Server with device: %s\n", device->info.description.c_str());
-		device->server_run();
+		device->server_run((cache_size > 0)? (size_t)cache_size << 20: 0);
 		delete device;
 	}
 
@@ -21,11 +21,14 @@
 #include "device.h"
 #include "scene.h"
 #include "session.h"
+#include "shader.h"
 
 #include "util_args.h"
 #include "util_foreach.h"
 #include "util_function.h"
+#include "util_image.h"
 #include "util_path.h"
+#include "util_profiling.h"
 #include "util_progress.h"
 #include "util_string.h"
 #include "util_time.h"
@@ -46,6 +49,11 @@ struct Options {
 	int width, height;
 	SceneParams scene_params;
 	SessionParams session_params;
+	string profile_path;
+	string stream_path;
+	string foveated_map_path;
+	TileOutput *tile_output;
+	bool stream;
 	bool quiet;
 	bool show_help, interactive, pause;
 } options;
@@ -103,6 +111,20 @@ static void session_init()
 	options.session->reset(session_buffer_params(), options.session_params.samples);
 	options.session->scene = options.scene;
 
+	if(options.stream) {
+		/* write tiles to the output file as they finish */
+		options.tile_output = new TileOutput(options.stream_path, options.width, options.height,
+			options.session_params.tile_size, options.scene->film->exposure);
+
+		if(!options.tile_output->open()) {
+			fprintf(stderr, "Failed to open %s: %s\n", options.stream_path.c_str(),
+				options.tile_output->error.c_str());
+			exit(EXIT_FAILURE);
+		}
+
+		options.session->write_render_tile_cb = function_bind(&TileOutput::write, options.tile_output, _1);
+	}
+
 	if(options.session_params.background && !options.quiet)
 		options.session->progress.set_update_callback(function_bind(&session_print_status));
 #ifdef WITH_CYCLES_STANDALONE_GUI
@@ -136,12 +158,180 @@ static void scene_init()
 	options.scene->camera->compute_auto_viewplane();
 }
 
+static bool foveated_map_load(const string& filepath, SessionParams& params)
+{
+	ImageInput *in = ImageInput::open(filepath);
+
+	if(!in)
+		return false;
+
+	const ImageSpec& spec = in->spec();
+	int width = spec.width;
+	int height = spec.height;
+	int components = spec.nchannels;
+	vector<float> pixels(width*height*components);
+
+	bool ok = in->read_image(TypeDesc::FLOAT, &pixels[0]);
+
+	in->close();
+	delete in;
+
+	if(!ok)
+		return false;
+
+	/* use the first channel as density, flipped so the bottom row is first
+	 * like the render buffers */
+	params.foveated_map.resize(width*height);
+	params.foveated_map_size = make_int2(width, height);
+
+	for(int y = 0; y < height; y++)
+		for(int x = 0; x < width; x++)
+			params.foveated_map[x + y*width] = pixels[(x + (height - 1 - y)*width)*components];
+
+	params.foveated = true;
+
+	return true;
+}
+
+static string json_escape(const string& str)
+{
+	string result;
+
+	foreach(char c, str) {
+		if(c == '"' || c == '\\')
+			result += '\\';
+		if((unsigned char)c >= 0x20)
+			result += c;
+	}
+
+	return result;
+}
+
+static void session_write_profile()
+{
+	Profiler& profiler = options.session->stats.profiler;
+	Scene *scene = options.session->scene;
+	double interval = profiler.sample_interval;
+	string json = "{\n";
+
+	/* time per kernel phase, over all threads */
+	json += "\t\"events\": {";
+
+	for(int i = 0; i < PROFILING_NUM_EVENTS; i++) {
+		ProfilingEvent event = (ProfilingEvent)i;
+		json += string_printf("%s\n\t\t\"%s\": %.3f", (i)? ",": "",
+			Profiler::event_name(event), profiler.get_event(event)*interval);
+	}
+
+	json += "\n\t},\n";
+
+	/* ray counts */
+	json += "\t\"rays\": {";
+
+	for(int i = 0; i < PROFILING_NUM_RAYS; i++) {
+		ProfilingRay type = (ProfilingRay)i;
+		json += string_printf("%s\n\t\t\"%s\": %llu", (i)? ",": "",
+			Profiler::ray_name(type), (unsigned long long)profiler.get_rays(type));
+	}
+
+	json += "\n\t},\n";
+
+	/* shader evaluation time per shader and per SVM node type */
+	vector<uint64_t> samples;
+	bool first = true;
+
+	profiler.get_shaders(samples);
+	json += "\t\"shaders\": {";
+
+	for(size_t i = 0; i < samples.size(); i++) {
+		if(samples[i] == 0 || i >= scene->shaders.size())
+			continue;
+
+		json += string_printf("%s\n\t\t\"%s\": %.3f", (first)? "": ",",
+			json_escape(scene->shaders[i]->name).c_str(), samples[i]*interval);
+		first = false;
+	}
+
+	json += "\n\t},\n";
+
+	profiler.get_svm_nodes(samples);
+	first = true;
+	json += "\t\"svm_nodes\": {";
+
+	for(size_t i = 0; i < samples.size(); i++) {
+		if(samples[i] == 0)
+			continue;
+
+		json += string_printf("%s\n\t\t\"%d\": %.3f", (first)? "": ",", (int)i, samples[i]*interval);
+		first = false;
+	}
+
+	json += "\n\t},\n";
+
+	/* shader graph optimization */
+	ShaderGraphStats& graph_stats = scene->shader_manager->graph_stats;
+	json += string_printf("\t\"shader_graph\": {\"folded\": %d, \"bypassed\": %d, "
+		"\"deduplicated\": %d, \"removed\": %d},\n",
+		(int)graph_stats.nodes_folded, (int)graph_stats.nodes_bypassed,
+		(int)graph_stats.nodes_deduplicated, (int)graph_stats.nodes_removed);
+
+	/* per thread */
+	vector<ProfilingThread> threads;
+	profiler.get_threads(threads);
+	json += "\t\"threads\": [";
+
+	for(size_t i = 0; i < threads.size(); i++) {
+		json += string_printf("%s\n\t\t{\"thread\": %d", (i)? ",": "", threads[i].thread_index);
+
+		for(int j = 0; j < PROFILING_NUM_EVENTS; j++)
+			json += string_printf(", \"%s\": %.3f", Profiler::event_name((ProfilingEvent)j),
+				threads[i].event_samples[j]*interval);
+
+		json += "}";
+	}
+
+	json += "\n\t],\n";
+
+	/* per tile */
+	vector<ProfilingTile> tiles;
+	profiler.get_tiles(tiles);
+	json += "\t\"tiles\": [";
+
+	for(size_t i = 0; i < tiles.size(); i++) {
+		const ProfilingTile& tile = tiles[i];
+
+		json += string_printf("%s\n\t\t{\"x\": %d, \"y\": %d, \"w\": %d, \"h\": %d, \"samples\": %d, \"thread\": %d, \"time\": %.4f",
+			(i)? ",": "", tile.x, tile.y, tile.w, tile.h, tile.samples, tile.thread_index, tile.time);
+
+		for(int j = 0; j < PROFILING_NUM_RAYS; j++)
+			json += string_printf(", \"%s\": %llu", Profiler::ray_name((ProfilingRay)j), (unsigned long long)tile.rays[j]);
+
+		json += "}";
+	}
+
+	json += "\n\t]\n}\n";
+
+	if(!path_write_text(options.profile_path, json))
+		fprintf(stderr, "Failed to write profile to %s\n", options.profile_path.c_str());
+}
+
 static void session_exit()
 {
+	if(options.session && options.profile_path != "")
+		session_write_profile();
+
 	if(options.session) {
 		delete options.session;
 		options.session = NULL;
 	}
+	if(options.tile_output) {
+		if(options.tile_output->error != "")
+			fprintf(stderr, "Failed to write %s: %s\n", options.stream_path.c_str(),
+				options.tile_output->error.c_str());
+
+		delete options.tile_output;
+		options.tile_output = NULL;
+	}
 	if(options.scene) {
 		delete options.scene;
 		options.scene = NULL;
@@ -310,6 +500,8 @@ static void options_parse(int argc, const char **argv)
 	options.height = 0;
 	options.filepath = "";
 	options.session = NULL;
+	options.tile_output = NULL;
+	options.stream = false;
 	options.quiet = false;
 
 	/* device names */
@@ -343,7 +535,15 @@ static void options_parse(int argc, const char **argv)
 		"--quiet", &options.quiet, "In background mode, don't print progress messages",
 		"--samples %d", &options.session_params.samples, "Number of samples to render",
 		"--output %s", &options.session_params.output_path, "File path to write output image",
+		"--stream", &options.stream, "In background mode, write tiles to the output file as they finish, without keeping the full image in memory (tiled formats only, such as EXR)",
+		"--foveated", &options.session_params.foveated, "Use fewer samples for pixels further away from the center of view",
+		"--foveated-center %f %f", &options.session_params.foveated_center.x, &options.session_params.foveated_center.y, "Center of view for foveated sampling, in 0..1 image coordinates",
+		"--foveated-radius %f", &options.session_params.foveated_radius, "Size of the region around the center that gets all samples, relative to the image width or to 180 degrees for panoramas",
+		"--foveated-min-density %f", &options.session_params.foveated_min_density, "Fraction of samples that pixels furthest from the center still get",
+		"--foveated-map %s", &options.foveated_map_path, "Image with the sample density per pixel, instead of the falloff from the center",
+		"--tile-size %d %d", &options.session_params.tile_size.x, &options.session_params.tile_size.y, "Width and height of render tiles in pixels",
 		"--threads %d", &options.session_params.threads, "CPU Rendering Threads",
+		"--profile %s", &options.profile_path, "Write CPU kernel profiling statistics to a JSON file",
 		"--width  %d", &options.width, "Window width in pixel",
 		"--height %d", &options.height, "Window height in pixel",
 		"--list-devices", &list, "List information about all available devices",
@@ -384,6 +584,15 @@ static void options_parse(int argc, const char **argv)
 	/* Use progressive rendering */
 	options.session_params.progressive = true;
 
+	/* Streaming output renders tiles with all samples at once into temporary
+	 * buffers that are freed after writing, the session itself then has no
+	 * output path and allocates no full size buffers */
+	if(options.stream) {
+		options.stream_path = options.session_params.output_path;
+		options.session_params.output_path = "";
+		options.session_params.progressive = false;
+	}
+
 	/* find matching device */
 	DeviceType device_type = Device::type_from_string(devicename.c_str());
 	vector<DeviceInfo>& devices = Device::available_devices();
@@ -421,10 +630,25 @@ static void options_parse(int argc, const char **argv)
 		fprintf(stderr, "No file path specified\n");
 		exit(EXIT_FAILURE);
 	}
+	else if(options.stream && (!options.session_params.background || options.stream_path == "")) {
+		fprintf(stderr, "Streaming output requires background mode and an output file\n");
+		exit(EXIT_FAILURE);
+	}
+	else if(options.foveated_map_path != "" && !foveated_map_load(options.foveated_map_path, options.session_params)) {
+		fprintf(stderr, "Failed to load foveated sampling map: %s\n", options.foveated_map_path.c_str());
+		exit(EXIT_FAILURE);
+	}
+	else if(options.session_params.tile_size.x <= 0 || options.session_params.tile_size.y <= 0) {
+		fprintf(stderr, "Invalid tile size: %d %d\n", options.session_params.tile_size.x, options.session_params.tile_size.y);
+		exit(EXIT_FAILURE);
+	}
 
 	/* For smoother Viewport */
 	options.session_params.start_resolution = 64;
 
+	/* Kernel profiling */
+	options.session_params.profiling = (options.profile_path != "");
+
 	/* load scene */
 	scene_init();
 }
@@ -16,6 +16,15 @@
 
 #include <stdio.h>
 
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #include <sstream>
 #include <algorithm>
 #include <iterator>
@@ -343,9 +352,12 @@ static void xml_read_camera(const XMLReadState& state, pugi::xml_node node)
 		cam->panorama_type = PANORAMA_FISHEYE_EQUIDISTANT;
 	else if(xml_equal_string(node, "panorama_type", "fisheye_equisolid"))
 		cam->panorama_type = PANORAMA_FISHEYE_EQUISOLID;
+	else if(xml_equal_string(node, "panorama_type", "ods"))
+		cam->panorama_type = PANORAMA_ODS;
 
 	xml_read_float(&cam->fisheye_fov, node, "fisheye_fov");
 	xml_read_float(&cam->fisheye_lens, node, "fisheye_lens");
+	xml_read_float(&cam->interocular_distance, node, "interocular_distance");
 
 	xml_read_float(&cam->sensorwidth, node, "sensorwidth");
 	xml_read_float(&cam->sensorheight, node, "sensorheight");
@@ -829,8 +841,318 @@ static Mesh *xml_add_mesh(Scene *scene, const Transform& tfm)
 	return mesh;
 }
 
+/* Binary Geometry
+ *
+ * Large meshes can be stored in a sidecar file referenced as <mesh src="..."/>
+ * to avoid parsing text arrays. The file is memory mapped and arrays are
+ * copied straight into the mesh. All data is little endian:
+ *
+ * header: char magic[4] = "CGEO", uint32 version, uint32 num_blocks, uint32 pad
+ * blocks: num_blocks block headers as in XMLGeomBlock, followed by the data
+ *         for each block at its offset, aligned to 16 bytes.
+ *
+ * Known blocks are "P" (float3 per vertex), "triangles" (int3 per face),
+ * "smooth" (uchar per face) and "tfm" (16 floats, same layout as the matrix
+ * attribute of a transform node). Other float blocks with 1 or 3 components
+ * per vertex or corner are added as attributes by name. */
+
+#define XML_GEOM_MAGIC "CGEO"
+#define XML_GEOM_VERSION 1
+#define XML_GEOM_ALIGN 16
+
+enum XMLGeomType {
+	XML_GEOM_FLOAT = 0,
+	XML_GEOM_INT = 1,
+	XML_GEOM_UCHAR = 2
+};
+
+enum XMLGeomElement {
+	XML_GEOM_MESH = 0,
+	XML_GEOM_VERTEX = 1,
+	XML_GEOM_FACE = 2,
+	XML_GEOM_CORNER = 3
+};
+
+struct XMLGeomHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t num_blocks;
+	uint32_t pad;
+};
+
+struct XMLGeomBlock {
+	char name[32];
+	uint32_t type;
+	uint32_t components;
+	uint32_t element;
+	uint32_t pad;
+	uint64_t offset;
+	uint64_t count;
+};
+
+class XMLMappedFile {
+public:
+	XMLMappedFile(const string& path)
+	: data(NULL), size(0)
+	{
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		mapping = NULL;
+
+		if(file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER file_size;
+
+		if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+			return;
+
+		mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if(!mapping)
+			return;
+
+		data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		size = (data)? (size_t)file_size.QuadPart: 0;
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+
+		if(fd == -1)
+			return;
+
+		struct stat st;
+
+		if(fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if(mem != MAP_FAILED) {
+				data = (const uint8_t*)mem;
+				size = st.st_size;
+			}
+		}
+
+		/* mapping stays valid after closing */
+		close(fd);
+#endif
+	}
+
+	~XMLMappedFile()
+	{
+#ifdef _WIN32
+		if(data)
+			UnmapViewOfFile(data);
+		if(mapping)
+			CloseHandle(mapping);
+		if(file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+#else
+		if(data)
+			munmap((void*)data, size);
+#endif
+	}
+
+	const uint8_t *data;
+	size_t size;
+
+protected:
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+};
+
+static size_t xml_geom_type_size(uint32_t type)
+{
+	switch(type) {
+		case XML_GEOM_FLOAT: return sizeof(float);
+		case XML_GEOM_INT: return sizeof(int);
+		case XML_GEOM_UCHAR: return sizeof(uchar);
+		default: return 0;
+	}
+}
+
+/* check that a block has a known type, is aligned and lies within the file,
+ * the sizes come from the file so the multiplications are checked for overflow */
+static bool xml_geom_block_valid(const XMLMappedFile& file, const XMLGeomBlock *block)
+{
+	size_t type_size = xml_geom_type_size(block->type);
+
+	if(type_size == 0 || block->components == 0)
+		return false;
+	if(block->offset % XML_GEOM_ALIGN != 0 || block->offset > file.size)
+		return false;
+
+	size_t available = file.size - block->offset;
+
+	if(block->components > available / type_size)
+		return false;
+	if(block->count > available / (type_size*block->components))
+		return false;
+
+	return true;
+}
+
+static const XMLGeomBlock *xml_geom_find_block(const XMLMappedFile& file, const XMLGeomHeader *header,
+	const char *name, uint32_t type, uint32_t components)
+{
+	const XMLGeomBlock *blocks = (const XMLGeomBlock*)(file.data + sizeof(XMLGeomHeader));
+
+	for(uint32_t i = 0; i < header->num_blocks; i++)
+		if(strncmp(blocks[i].name, name, sizeof(blocks[i].name)) == 0)
+			return (blocks[i].type == type && blocks[i].components == components)? &blocks[i]: NULL;
+
+	return NULL;
+}
+
+static void xml_read_mesh_binary(const XMLReadState& state, const string& filepath)
+{
+	XMLMappedFile file(filepath);
+
+	if(!file.data) {
+		fprintf(stderr, "%s read error: can't map file.\n", filepath.c_str());
+		return;
+	}
+
+	/* validate header and block table */
+	const XMLGeomHeader *header = (const XMLGeomHeader*)file.data;
+
+	if(file.size < sizeof(XMLGeomHeader) ||
+	   memcmp(header->magic, XML_GEOM_MAGIC, sizeof(header->magic)) != 0 ||
+	   header->version != XML_GEOM_VERSION ||
+	   header->num_blocks > (file.size - sizeof(XMLGeomHeader))/sizeof(XMLGeomBlock))
+	{
+		fprintf(stderr, "%s read error: not a binary geometry file.\n", filepath.c_str());
+		return;
+	}
+
+	const XMLGeomBlock *blocks = (const XMLGeomBlock*)(file.data + sizeof(XMLGeomHeader));
+
+	for(uint32_t i = 0; i < header->num_blocks; i++) {
+		if(!xml_geom_block_valid(file, &blocks[i])) {
+			fprintf(stderr, "%s read error: invalid block %u.\n", filepath.c_str(), i);
+			return;
+		}
+	}
+
+	const XMLGeomBlock *block_P = xml_geom_find_block(file, header, "P", XML_GEOM_FLOAT, 3);
+	const XMLGeomBlock *block_tri = xml_geom_find_block(file, header, "triangles", XML_GEOM_INT, 3);
+	const XMLGeomBlock *block_smooth = xml_geom_find_block(file, header, "smooth", XML_GEOM_UCHAR, 1);
+	const XMLGeomBlock *block_tfm = xml_geom_find_block(file, header, "tfm", XML_GEOM_FLOAT, 16);
+
+	if(!block_P || !block_tri) {
+		fprintf(stderr, "%s read error: missing P or triangles.\n", filepath.c_str());
+		return;
+	}
+
+	size_t numverts = block_P->count;
+	size_t numtris = block_tri->count;
+	const int *tri = (const int*)(file.data + block_tri->offset);
+
+	for(size_t i = 0; i < numtris*3; i++) {
+		if(tri[i] < 0 || (size_t)tri[i] >= numverts) {
+			fprintf(stderr, "%s read error: triangle index out of range.\n", filepath.c_str());
+			return;
+		}
+	}
+
+	/* add mesh */
+	Transform tfm = state.tfm;
+
+	if(block_tfm && block_tfm->count == 1)
+		tfm = tfm * transform_transpose(*(const Transform*)(file.data + block_tfm->offset));
+
+	Mesh *mesh = xml_add_mesh(state.scene, tfm);
+	mesh->used_shaders.push_back(state.shader);
+	mesh->displacement_method = state.displacement_method;
+
+	mesh->reserve(numverts, numtris, 0, 0);
+
+	/* vertices, float3 may be padded so copy per element */
+	const float *P = (const float*)(file.data + block_P->offset);
+
+	for(size_t i = 0; i < numverts; i++)
+		mesh->verts[i] = make_float3(P[i*3+0], P[i*3+1], P[i*3+2]);
+
+	/* triangles match the file layout */
+	if(numtris)
+		memcpy(&mesh->triangles[0], tri, sizeof(Mesh::Triangle)*numtris);
+
+	const uchar *smooth = (block_smooth && block_smooth->count == numtris)?
+		(const uchar*)(file.data + block_smooth->offset): NULL;
+
+	for(size_t i = 0; i < numtris; i++) {
+		mesh->shader[i] = state.shader;
+		mesh->smooth[i] = (smooth)? smooth[i] != 0: state.smooth;
+	}
+
+	/* attributes */
+	for(uint32_t i = 0; i < header->num_blocks; i++) {
+		const XMLGeomBlock *block = &blocks[i];
+
+		if(block == block_P || block == block_tfm || block->type != XML_GEOM_FLOAT)
+			continue;
+		if(!(block->components == 1 || block->components == 3))
+			continue;
+
+		AttributeElement element;
+		size_t size;
+
+		if(block->element == XML_GEOM_VERTEX) {
+			element = ATTR_ELEMENT_VERTEX;
+			size = numverts;
+		}
+		else if(block->element == XML_GEOM_CORNER) {
+			element = ATTR_ELEMENT_CORNER;
+			size = numtris*3;
+		}
+		else
+			continue;
+
+		if(block->count != size) {
+			fprintf(stderr, "%s: attribute size mismatch.\n", filepath.c_str());
+			continue;
+		}
+
+		string name(block->name, strnlen(block->name, sizeof(block->name)));
+		AttributeStandard std = Attribute::name_standard(name.c_str());
+		TypeDesc type = (block->components == 3)? TypeDesc::TypePoint: TypeDesc::TypeFloat;
+		Attribute *attr;
+
+		if(std != ATTR_STD_NONE) {
+			attr = mesh->attributes.add(std, ustring(name));
+
+			if(attr->element != element || attr->data_sizeof() != ((block->components == 3)? sizeof(float3): sizeof(float))) {
+				mesh->attributes.remove(std);
+				fprintf(stderr, "%s: attribute %s has wrong type.\n", filepath.c_str(), name.c_str());
+				continue;
+			}
+		}
+		else
+			attr = mesh->attributes.add(ustring(name), type, element);
+
+		const float *fdata = (const float*)(file.data + block->offset);
+
+		if(block->components == 3) {
+			float3 *data = attr->data_float3();
+
+			for(size_t j = 0; j < size; j++)
+				data[j] = make_float3(fdata[j*3+0], fdata[j*3+1], fdata[j*3+2]);
+		}
+		else
+			memcpy(attr->data_float(), fdata, sizeof(float)*size);
+	}
+}
+
 static void xml_read_mesh(const XMLReadState& state, pugi::xml_node node)
 {
+	/* binary geometry file */
+	string src;
+
+	if(xml_read_string(&src, node, "src")) {
+		xml_read_mesh_binary(state, path_join(state.base, src));
+		return;
+	}
+
 	/* add mesh */
 	Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
 	mesh->used_shaders.push_back(state.shader);
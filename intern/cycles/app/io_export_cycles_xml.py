@@ -17,12 +17,14 @@
 # XML exporter for generating test files, not intended for end users
 
 import os
+import struct
+import array
 import xml.etree.ElementTree as etree
 import xml.dom.minidom as dom
 
 import bpy
 from bpy_extras.io_utils import ExportHelper
-from bpy.props import PointerProperty, StringProperty
+from bpy.props import BoolProperty, PointerProperty, StringProperty
 
 def strip(root):
     root.text = None
@@ -39,7 +41,42 @@ def write(node, fname):
 
     f = open(fname, "w")
     f.write(s)
-    
+
+# Binary geometry file, see "Binary Geometry" in cycles_xml.cpp
+GEOM_FLOAT = 0
+GEOM_INT = 1
+GEOM_UCHAR = 2
+
+GEOM_MESH = 0
+GEOM_VERTEX = 1
+GEOM_FACE = 2
+GEOM_CORNER = 3
+
+def write_geom(blocks, fname):
+    # blocks are (name, type, components, element, array) tuples
+    header_size = 16 + 64 * len(blocks)
+    offset = (header_size + 15) & ~15
+
+    table = struct.pack("<4sIII", b"CGEO", 1, len(blocks), 0)
+    datas = []
+
+    for name, type, components, element, data in blocks:
+        count = len(data) // components
+        table += struct.pack("<32sIIIIQQ", name.encode("utf-8"), type, components, element, 0, offset, count)
+
+        data = data.tobytes()
+        datas.append((offset, data))
+        offset = (offset + len(data) + 15) & ~15
+
+    f = open(fname, "wb")
+    f.write(table)
+
+    for offset, data in datas:
+        f.seek(offset)
+        f.write(data)
+
+    f.close()
+
 class CyclesXMLSettings(bpy.types.PropertyGroup):
     @classmethod
     def register(cls):
@@ -89,6 +126,13 @@ class ExportCyclesXML(bpy.types.Operator, ExportHelper):
 
     filename_ext = ".xml"
 
+    use_binary = BoolProperty(
+            name="Binary Geometry",
+            description="Write mesh data to a binary file next to the .xml file, "
+                        "much faster to load for large meshes",
+            default=False,
+            )
+
     @classmethod
     def poll(cls, context):
         return (context.active_object is not None)
@@ -108,6 +152,9 @@ class ExportCyclesXML(bpy.types.Operator, ExportHelper):
         if not mesh:
             raise Exception("No mesh data in active object")
 
+        if self.use_binary:
+            return self.execute_binary(filepath, object, mesh)
+
         # generate mesh node
         nverts = ""
         verts = ""
@@ -130,6 +177,57 @@ class ExportCyclesXML(bpy.types.Operator, ExportHelper):
 
         return {'FINISHED'}
 
+    def execute_binary(self, filepath, object, mesh):
+        geompath = os.path.splitext(filepath)[0] + ".cgeo"
+
+        P = array.array('f')
+        triangles = array.array('i')
+        smooth = array.array('B')
+        uv = array.array('f')
+
+        for v in mesh.vertices:
+            P.extend(v.co)
+
+        uv_layer = mesh.tessface_uv_textures.active
+
+        # triangulate as a fan, same as the text format
+        for i, f in enumerate(mesh.tessfaces):
+            vi = f.vertices
+
+            if uv_layer:
+                fuv = uv_layer.data[i]
+                corners = (fuv.uv1, fuv.uv2, fuv.uv3, fuv.uv4)
+
+            for j in range(len(vi) - 2):
+                triangles.extend((vi[0], vi[j + 1], vi[j + 2]))
+                smooth.append(f.use_smooth)
+
+                if uv_layer:
+                    for c in (0, j + 1, j + 2):
+                        uv.extend((corners[c][0], corners[c][1], 0.0))
+
+        # same layout as the matrix attribute of a transform node
+        tfm = array.array('f')
+
+        for column in object.matrix_world.col:
+            tfm.extend(column)
+
+        blocks = [("P", GEOM_FLOAT, 3, GEOM_VERTEX, P),
+                  ("triangles", GEOM_INT, 3, GEOM_FACE, triangles),
+                  ("smooth", GEOM_UCHAR, 1, GEOM_FACE, smooth),
+                  ("tfm", GEOM_FLOAT, 16, GEOM_MESH, tfm)]
+
+        if uv_layer:
+            blocks.append(("uv", GEOM_FLOAT, 3, GEOM_CORNER, uv))
+
+        write_geom(blocks, geompath)
+
+        # mesh node referencing the geometry file
+        node = etree.Element('mesh', attrib={'src': os.path.basename(geompath)})
+        write(node, filepath)
+
+        return {'FINISHED'}
+
 def register():
     bpy.utils.register_module(__name__)
 
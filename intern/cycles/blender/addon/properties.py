@@ -66,6 +66,8 @@ enum_panorama_types = (
     ('FISHEYE_EQUIDISTANT', "Fisheye Equidistant", "Ideal for fulldomes, ignore the sensor dimensions"),
     ('FISHEYE_EQUISOLID', "Fisheye Equisolid",
                           "Similar to most fisheye modern lens, takes sensor dimensions into consideration"),
+    ('ODS', "Omnidirectional Stereo",
+            "Equirectangular stereo panorama with the left eye on top and the right eye at the bottom of the image"),
     )
 
 enum_curve_primitives = (
@@ -405,6 +407,27 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default=0.0,
                 )
 
+        cls.use_foveated_sampling = BoolProperty(
+                name="Foveated Sampling",
+                description="Use fewer samples for pixels further away from the center of view, "
+                            "for faster previews of panoramas and VR content",
+                default=False,
+                )
+        cls.foveated_radius = FloatProperty(
+                name="Foveated Radius",
+                description="Size of the region in the center that gets all samples, "
+                            "relative to the image width, or to 180 degrees for panoramas",
+                min=0.001, max=1.0,
+                default=0.1,
+                )
+        cls.foveated_min_density = FloatProperty(
+                name="Foveated Minimum Density",
+                description="Fraction of samples that pixels furthest away from the center still get",
+                min=0.001, max=1.0,
+                default=0.1,
+                subtype='FACTOR',
+                )
+
         cls.debug_tile_size = IntProperty(
                 name="Tile Size",
                 description="",
@@ -450,6 +473,18 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.debug_use_hair_bvh = BoolProperty(
+                name="Use Hair BVH",
+                description="Use oriented bounds around hair strands in the BVH: slightly longer build time, faster hair render",
+                default=True,
+                )
+        cls.debug_hair_merge_segments = IntProperty(
+                name="Merge Hair Segments",
+                description="Keep up to this many adjacent segments of a hair strand together in the BVH, "
+                            "for fewer traversal steps (1 to disable)",
+                min=1, max=16,
+                default=1,
+                )
         cls.use_cache = BoolProperty(
                 name="Cache BVH",
                 description="Cache last built BVH to disk for faster re-render if no geometry changed",
@@ -569,6 +604,13 @@ class CyclesCameraSettings(bpy.types.PropertyGroup):
                 min=0.01, soft_max=15.0, max=100.0,
                 default=10.5,
                 )
+        cls.interocular_distance = FloatProperty(
+                name="Interocular Distance",
+                description="Distance between the eyes for stereo panoramas",
+                min=0.0, soft_max=1.0,
+                subtype='DISTANCE',
+                default=0.065,
+                )
 
     @classmethod
     def unregister(cls):
@@ -157,6 +157,13 @@ class CyclesRender_PT_sampling(CyclesButtonsPanel, Panel):
         if cscene.feature_set == 'EXPERIMENTAL' and use_cpu(context):
             layout.row().prop(cscene, "sampling_pattern", text="Pattern")
 
+        row = layout.row()
+        row.prop(cscene, "use_foveated_sampling")
+        sub = row.row(align=True)
+        sub.active = cscene.use_foveated_sampling
+        sub.prop(cscene, "foveated_radius", text="Radius")
+        sub.prop(cscene, "foveated_min_density", text="Min Density")
+
         for rl in scene.render.layers:
             if rl.samples > 0:
                 layout.separator()
@@ -318,12 +325,14 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
 
         col.label(text="Final Render:")
         col.prop(cscene, "use_cache")
-        col.prop(rd, "use_persistent_data", text="Persistent Images")
+        col.prop(rd, "use_persistent_data", text="Persistent Data")
 
         col.separator()
 
         col.label(text="Acceleration structure:")
         col.prop(cscene, "debug_use_spatial_splits")
+        col.prop(cscene, "debug_use_hair_bvh")
+        col.prop(cscene, "debug_hair_merge_segments")
 
 
 class CyclesRender_PT_layer_options(CyclesButtonsPanel, Panel):
@@ -27,6 +27,7 @@
 #include "subd_split.h"
 
 #include "util_foreach.h"
+#include "util_task.h"
 
 #include "mikktspace.h"
 
@@ -477,6 +478,106 @@ static void create_subd_mesh(Scene *scene, Mesh *mesh, BL::Mesh b_mesh, PointerR
 	sdmesh.tessellate(&dsplit);
 }
 
+/* Parallel Export
+ *
+ * Creating and freeing blender meshes is not thread safe, but once a derived
+ * mesh exists converting it only reads RNA data. So sync_mesh() only creates
+ * the blender mesh and the meshes found in the object loop are converted in
+ * parallel in batches, each into its own preallocated arrays. A batch holds a
+ * few meshes per thread, so not all derived meshes are in memory at once. */
+
+struct BlenderSync::MeshExport {
+	MeshExport(Mesh *mesh_, BL::Object b_ob_, BL::Mesh b_mesh_, bool hide_tris_)
+	: mesh(mesh_), b_ob(b_ob_), b_mesh(b_mesh_), hide_tris(hide_tris_), use_subdivision(false)
+	{
+	}
+
+	Mesh *mesh;
+	BL::Object b_ob;
+	BL::Mesh b_mesh;
+	bool hide_tris;
+	bool use_subdivision;
+	PointerRNA cmesh;
+
+	/* to detect if the BVH needs to be rebuilt */
+	vector<Mesh::Triangle> oldtriangle;
+	vector<float4> oldcurve_keys;
+};
+
+static bool mesh_need_rebuild(Mesh *mesh, const vector<Mesh::Triangle>& oldtriangle, const vector<float4>& oldcurve_keys)
+{
+	if(oldtriangle.size() != mesh->triangles.size())
+		return true;
+	else if(oldtriangle.size()) {
+		if(memcmp(&oldtriangle[0], &mesh->triangles[0], sizeof(Mesh::Triangle)*oldtriangle.size()) != 0)
+			return true;
+	}
+
+	if(oldcurve_keys.size() != mesh->curve_keys.size())
+		return true;
+	else if(oldcurve_keys.size()) {
+		if(memcmp(&oldcurve_keys[0], &mesh->curve_keys[0], sizeof(float4)*oldcurve_keys.size()) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+void BlenderSync::export_mesh(MeshExport *mexport)
+{
+	if(progress.get_cancel())
+		return;
+
+	if(render_layer.use_surfaces && !mexport->hide_tris) {
+		Mesh *mesh = mexport->mesh;
+
+		if(mexport->use_subdivision)
+			create_subd_mesh(scene, mesh, mexport->b_mesh, &mexport->cmesh, mesh->used_shaders);
+		else
+			create_mesh(scene, mesh, mexport->b_mesh, mesh->used_shaders);
+	}
+}
+
+void BlenderSync::sync_mesh_exports()
+{
+	if(mesh_exports.size() == 0)
+		return;
+
+	progress.set_sync_status("Exporting meshes");
+
+	TaskPool pool;
+
+	foreach(MeshExport *mexport, mesh_exports)
+		pool.push(function_bind(&BlenderSync::export_mesh, this, mexport));
+
+	pool.wait_work();
+
+	/* image slots, hair and freeing blender meshes must be done serially */
+	bool cancel = progress.get_cancel();
+
+	foreach(MeshExport *mexport, mesh_exports) {
+		Mesh *mesh = mexport->mesh;
+
+		if(!cancel) {
+			if(render_layer.use_surfaces && !mexport->hide_tris)
+				create_mesh_volume_attributes(scene, mexport->b_ob, mesh);
+
+			if(render_layer.use_hair)
+				sync_curves(mesh, mexport->b_mesh, mexport->b_ob, false);
+
+			if(mesh_need_rebuild(mesh, mexport->oldtriangle, mexport->oldcurve_keys))
+				mesh->tag_update(scene, true);
+		}
+
+		/* free derived mesh */
+		b_data.meshes.remove(mexport->b_mesh);
+
+		delete mexport;
+	}
+
+	mesh_exports.clear();
+}
+
 /* Sync */
 
 Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tris)
@@ -547,6 +648,8 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 	mesh->used_shaders = used_shaders;
 	mesh->name = ustring(b_ob_data.name().c_str());
 
+	MeshExport *mexport = NULL;
+
 	if(render_layer.use_surfaces || render_layer.use_hair) {
 		if(preview)
 			b_ob.update_from_editmode();
@@ -555,20 +658,14 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 		BL::Mesh b_mesh = object_to_mesh(b_data, b_ob, b_scene, true, !preview, need_undeformed);
 
 		if(b_mesh) {
-			if(render_layer.use_surfaces && !hide_tris) {
-				if(cmesh.data && experimental && RNA_boolean_get(&cmesh, "use_subdivision"))
-					create_subd_mesh(scene, mesh, b_mesh, &cmesh, used_shaders);
-				else
-					create_mesh(scene, mesh, b_mesh, used_shaders);
-
-				create_mesh_volume_attributes(scene, b_ob, mesh);
-			}
-
-			if(render_layer.use_hair)
-				sync_curves(mesh, b_mesh, b_ob, false);
-
-			/* free derived mesh */
-			b_data.meshes.remove(b_mesh);
+			/* converted after the object loop, see sync_mesh_exports() */
+			mexport = new MeshExport(mesh, b_ob, b_mesh, hide_tris);
+			mexport->cmesh = cmesh;
+			mexport->use_subdivision = cmesh.data && experimental && RNA_boolean_get(&cmesh, "use_subdivision");
+			mexport->oldtriangle.swap(oldtriangle);
+			mexport->oldcurve_keys.swap(oldcurve_keys);
+
+			mesh_exports.push_back(mexport);
 		}
 	}
 
@@ -584,25 +681,17 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 			mesh->displacement_method = Mesh::DISPLACE_BOTH;
 	}
 
-	/* tag update */
+	/* tag update, for exported meshes the rebuild test is done after export */
 	bool rebuild = false;
 
-	if(oldtriangle.size() != mesh->triangles.size())
-		rebuild = true;
-	else if(oldtriangle.size()) {
-		if(memcmp(&oldtriangle[0], &mesh->triangles[0], sizeof(Mesh::Triangle)*oldtriangle.size()) != 0)
-			rebuild = true;
-	}
-
-	if(oldcurve_keys.size() != mesh->curve_keys.size())
-		rebuild = true;
-	else if(oldcurve_keys.size()) {
-		if(memcmp(&oldcurve_keys[0], &mesh->curve_keys[0], sizeof(float4)*oldcurve_keys.size()) != 0)
-			rebuild = true;
-	}
+	if(!mexport)
+		rebuild = mesh_need_rebuild(mesh, oldtriangle, oldcurve_keys);
 	
 	mesh->tag_update(scene, rebuild);
 
+	if(mesh_exports.size() >= (size_t)(2 * max(TaskScheduler::num_threads(), 1)))
+		sync_mesh_exports();
+
 	return mesh;
 }
 
@@ -522,6 +522,10 @@ void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, float motion_time)
 		}
 	}
 
+	/* convert meshes created in the object loop, also frees them on cancel */
+	if(!motion)
+		sync_mesh_exports();
+
 	progress.set_sync_status("");
 
 	if(!cancel && !motion) {
@@ -152,6 +152,11 @@ void BlenderSession::reset_session(BL::BlendData b_data_, BL::Scene b_scene_)
 		 * them rather than trying to distinguish which settings need to be updated
 		 */
 
+		if(sync) {
+			delete sync;
+			sync = NULL;
+		}
+
 		delete session;
 
 		create_session();
@@ -160,7 +165,23 @@ void BlenderSession::reset_session(BL::BlendData b_data_, BL::Scene b_scene_)
 	}
 
 	session->progress.reset();
-	scene->reset();
+
+	if(sync) {
+		/* scene data was kept from the previous render, only data that
+		 * changed is resynced, see BlenderSync::reset */
+		scene->camera->tag_update();
+		scene->film->tag_update(scene);
+		scene->background->tag_update(scene);
+		scene->integrator->tag_update(scene);
+
+		sync->reset(b_data, b_scene);
+	}
+	else {
+		scene->reset();
+
+		/* sync object should be re-created */
+		sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress, session_params.device.type == DEVICE_CPU);
+	}
 
 	session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -169,9 +190,6 @@ void BlenderSession::reset_session(BL::BlendData b_data_, BL::Scene b_scene_)
 	 */
 	session->stats.mem_peak = session->stats.mem_used;
 
-	/* sync object should be re-created */
-	sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress, session_params.device.type == DEVICE_CPU);
-
 	/* for final render we will do full data sync per render layer, only
 	 * do some basic syncing here, no objects or materials for speed */
 	sync->sync_render_layers(b_v3d, NULL);
@@ -472,13 +490,19 @@ void BlenderSession::render()
 	session->update_render_tile_cb = NULL;
 
 	/* free all memory used (host and device), so we wouldn't leave render
-	 * engine with extra memory allocated
+	 * engine with extra memory allocated. with persistent data the scene is
+	 * kept on the device and synced incrementally for the next frame
 	 */
 
-	session->device_free();
+	if(scene->params.persistent_data) {
+		session->device_free(false);
+	}
+	else {
+		session->device_free();
 
-	delete sync;
-	sync = NULL;
+		delete sync;
+		sync = NULL;
+	}
 }
 
 static void populate_bake_data(BakeData *data, BL::BakePixel pixel_array, const int num_pixels)
@@ -563,21 +587,22 @@ void BlenderSession::bake(BL::Object b_object, const string& pass_type, BL::Bake
 
 	populate_bake_data(bake_data, pixel_array, num_pixels);
 
-	/* set number of samples */
-	session->tile_manager.set_samples(session_params.samples);
-	session->reset(buffer_params, session_params.samples);
-	session->update_scene();
-
 	scene->bake_manager->bake(scene->device, &scene->dscene, scene, session->progress, shader_type, bake_data, result);
 
 	/* free all memory used (host and device), so we wouldn't leave render
-	 * engine with extra memory allocated
+	 * engine with extra memory allocated. with persistent data the scene is
+	 * kept, so baking the next object reuses the synced scene and BVH
 	 */
 
-	session->device_free();
+	if(scene->params.persistent_data) {
+		session->device_free(false);
+	}
+	else {
+		session->device_free();
 
-	delete sync;
-	sync = NULL;
+		delete sync;
+		sync = NULL;
+	}
 }
 
 void BlenderSession::do_write_update_render_result(BL::RenderResult b_rr, BL::RenderLayer b_rlay, RenderTile& rtile, bool do_update_only)
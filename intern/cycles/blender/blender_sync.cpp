@@ -56,6 +56,11 @@ BlenderSync::BlenderSync(BL::RenderEngine b_engine_, BL::BlendData b_data_, BL::
 	scene = scene_;
 	preview = preview_;
 	is_cpu = is_cpu_;
+
+	/* store the data hashes of the first render, the next one only resyncs
+	 * what changed. the tags this adds don't matter since nothing is synced yet */
+	if(scene->params.persistent_data)
+		reset(b_data, b_scene);
 }
 
 BlenderSync::~BlenderSync()
@@ -135,6 +140,74 @@ bool BlenderSync::sync_recalc()
 	return recalc;
 }
 
+/* Persistent Data
+ *
+ * Final renders clear the depsgraph recalc flags before the render engine
+ * sees them, so when the scene is kept in memory between renders is_updated()
+ * can't be used. Instead a hash of the data of each material, lamp, world and
+ * mesh is kept from the previous render, and only data with a different hash
+ * is tagged. Objects and lights are cheap to sync and their motion blur
+ * depends on the frame, so these are always tagged, as are meshes evaluated
+ * by the depsgraph: those of modified objects, curves and metaballs. */
+
+bool BlenderSync::data_hash_changed(BL::ID b_id, int frame)
+{
+	uint hash = BKE_id_data_hash(b_id.ptr.data, frame);
+	map<void*, uint>::iterator it = data_hashes.find(b_id.ptr.data);
+
+	if(it != data_hashes.end() && it->second == hash)
+		return false;
+
+	data_hashes[b_id.ptr.data] = hash;
+	return true;
+}
+
+void BlenderSync::reset(BL::BlendData b_data_, BL::Scene b_scene_)
+{
+	b_data = b_data_;
+	b_scene = b_scene_;
+
+	int frame = b_scene.frame_current();
+
+	BL::BlendData::materials_iterator b_mat;
+
+	for(b_data.materials.begin(b_mat); b_mat != b_data.materials.end(); ++b_mat)
+		if(data_hash_changed(*b_mat, frame))
+			shader_map.set_recalc(*b_mat);
+
+	BL::BlendData::lamps_iterator b_lamp;
+
+	for(b_data.lamps.begin(b_lamp); b_lamp != b_data.lamps.end(); ++b_lamp)
+		if(data_hash_changed(*b_lamp, frame))
+			shader_map.set_recalc(*b_lamp);
+
+	/* a different world is detected by sync_world */
+	BL::World b_world = b_scene.world();
+
+	if(b_world && data_hash_changed(b_world, frame))
+		world_recalc = true;
+
+	BL::BlendData::objects_iterator b_ob;
+
+	for(b_data.objects.begin(b_ob); b_ob != b_data.objects.end(); ++b_ob) {
+		object_map.set_recalc(*b_ob);
+		light_map.set_recalc(*b_ob);
+
+		if(object_is_mesh(*b_ob)) {
+			BL::ID b_ob_data = b_ob->data();
+
+			/* modified objects have their own mesh in the mesh map */
+			if(BKE_object_is_modified(*b_ob))
+				mesh_map.set_recalc(*b_ob);
+			else if(!b_ob_data.is_a(&RNA_Mesh) || data_hash_changed(b_ob_data, frame))
+				mesh_map.set_recalc(b_ob_data);
+		}
+
+		if(b_ob->particle_systems.length())
+			particle_system_map.set_recalc(*b_ob);
+	}
+}
+
 void BlenderSync::sync_data(BL::SpaceView3D b_v3d, BL::Object b_override, void **python_thread_state, const char *layer)
 {
 	sync_render_layers(b_v3d, layer);
@@ -361,19 +434,23 @@ SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background)
 	else if(shadingsystem == 1)
 		params.shadingsystem = SceneParams::OSL;
 	
+	if(background && params.shadingsystem != SceneParams::OSL)
+		params.persistent_data = r.use_persistent_data();
+	else
+		params.persistent_data = false;
+
+	/* with persistent data, object level BVHs let unchanged meshes be reused
+	 * for the next frame, only the top level BVH is rebuilt */
 	if(background)
-		params.bvh_type = SceneParams::BVH_STATIC;
+		params.bvh_type = (params.persistent_data)? SceneParams::BVH_DYNAMIC: SceneParams::BVH_STATIC;
 	else
 		params.bvh_type = (SceneParams::BVHType)RNA_enum_get(&cscene, "debug_bvh_type");
 
 	params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
+	params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
+	params.bvh_curve_merge_segments = get_int(cscene, "debug_hair_merge_segments");
 	params.use_bvh_cache = (background)? RNA_boolean_get(&cscene, "use_cache"): false;
 
-	if(background && params.shadingsystem != SceneParams::OSL)
-		params.persistent_data = r.use_persistent_data();
-	else
-		params.persistent_data = false;
-
 	return params;
 }
 
@@ -491,6 +568,11 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine b_engine, BL::Use
 
 	params.progressive_refine = get_boolean(cscene, "use_progressive_refine");
 
+	/* foveated sampling, around the center of view */
+	params.foveated = get_boolean(cscene, "use_foveated_sampling");
+	params.foveated_radius = get_float(cscene, "foveated_radius");
+	params.foveated_min_density = get_float(cscene, "foveated_min_density");
+
 	if(background) {
 		if(params.progressive_refine)
 			params.progressive = true;
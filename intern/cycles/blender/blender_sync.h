@@ -53,6 +53,7 @@ public:
 
 	/* sync */
 	bool sync_recalc();
+	void reset(BL::BlendData b_data, BL::Scene b_scene);
 	void sync_data(BL::SpaceView3D b_v3d, BL::Object b_override, void **python_thread_state, const char *layer = 0);
 	void sync_render_layers(BL::SpaceView3D b_v3d, const char *layer);
 	void sync_integrator();
@@ -81,6 +82,7 @@ private:
 
 	void sync_nodes(Shader *shader, BL::ShaderNodeTree b_ntree);
 	Mesh *sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tris);
+	void sync_mesh_exports();
 	void sync_curves(Mesh *mesh, BL::Mesh b_mesh, BL::Object b_ob, bool motion, int time_index = 0);
 	Object *sync_object(BL::Object b_parent, int persistent_id[OBJECT_PERSISTENT_ID_SIZE], BL::DupliObject b_dupli_ob,
 	                                 Transform& tfm, uint layer_flag, float motion_time, bool hide_tris);
@@ -92,11 +94,16 @@ private:
 	/* particles */
 	bool sync_dupli_particle(BL::Object b_ob, BL::DupliObject b_dup, Object *object);
 
+	/* parallel mesh export */
+	struct MeshExport;
+	void export_mesh(MeshExport *mexport);
+
 	/* util */
 	void find_shader(BL::ID id, vector<uint>& used_shaders, int default_shader);
 	bool BKE_object_is_modified(BL::Object b_ob);
 	bool object_is_mesh(BL::Object b_ob);
 	bool object_is_light(BL::Object b_ob);
+	bool data_hash_changed(BL::ID b_id, int frame);
 
 	/* variables */
 	BL::RenderEngine b_engine;
@@ -109,10 +116,12 @@ private:
 	id_map<ObjectKey, Light> light_map;
 	id_map<ParticleSystemKey, ParticleSystem> particle_system_map;
 	set<Mesh*> mesh_synced;
+	vector<MeshExport*> mesh_exports;
 	set<Mesh*> mesh_motion_synced;
 	std::set<float> motion_times;
 	void *world_map;
 	bool world_recalc;
+	map<void*, uint> data_hashes;
 
 	Scene *scene;
 	bool preview;
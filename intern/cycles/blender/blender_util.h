@@ -33,6 +33,7 @@ void BKE_image_user_frame_calc(void *iuser, int cfra, int fieldnr);
 void BKE_image_user_file_path(void *iuser, void *ima, char *path);
 unsigned char *BKE_image_get_pixels_for_frame(void *image, int frame);
 float *BKE_image_get_float_pixels_for_frame(void *image, int frame);
+unsigned int BKE_id_data_hash(void *id, int cfra);
 }
 
 CCL_NAMESPACE_BEGIN
@@ -550,9 +550,12 @@ void RegularBVH::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
 		pack_node(e.idx, leaf->m_bounds, leaf->m_bounds, leaf->m_lo, leaf->m_hi, leaf->m_visibility, leaf->m_visibility);
 }
 
-void RegularBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry& e0, const BVHStackEntry& e1)
+void RegularBVH::pack_inner(const BVHStackEntry& e, const BVHStackEntry& e0, const BVHStackEntry& e1, const Transform *space)
 {
-	pack_node(e.idx, e0.node->m_bounds, e1.node->m_bounds, e0.encodeIdx(), e1.encodeIdx(), e0.node->m_visibility, e1.node->m_visibility);
+	if(space)
+		pack_unaligned_node(e.idx, space, e0.encodeIdx(), e1.encodeIdx(), e0.node->m_visibility, e1.node->m_visibility);
+	else
+		pack_node(e.idx, e0.node->m_bounds, e1.node->m_bounds, e0.encodeIdx(), e1.encodeIdx(), e0.node->m_visibility, e1.node->m_visibility);
 }
 
 void RegularBVH::pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int c0, int c1, uint visibility0, uint visibility1)
@@ -568,9 +571,64 @@ void RegularBVH::pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int
 	memcpy(&pack.nodes[idx * BVH_NODE_SIZE], data, sizeof(int4)*BVH_NODE_SIZE);
 }
 
+void RegularBVH::pack_unaligned_node(int idx, const Transform space[2], int c0, int c1, uint visibility0, uint visibility1)
+{
+	float4 data[BVH_NODE_SIZE*2] =
+	{
+		space[0].x,
+		space[0].y,
+		space[0].z,
+		make_float4(__int_as_float(c0), __int_as_float(c1), __uint_as_float(visibility0 | BVH_NODE_UNALIGNED), __uint_as_float(visibility1)),
+		space[1].x,
+		space[1].y,
+		space[1].z,
+		make_float4(0.0f, 0.0f, 0.0f, 0.0f)
+	};
+
+	memcpy(&pack.nodes[idx * BVH_NODE_SIZE], data, sizeof(float4)*BVH_NODE_SIZE*2);
+}
+
 void RegularBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 {
-	size_t node_size = root->getSubtreeSize(BVH_STAT_NODE_COUNT);
+	/* find nodes with oriented child bounds, which take up two slots. this
+	 * needs to happen before pack_instances offsets the primitive indexes */
+	map<const BVHNode*, int> unaligned_nodes;
+	vector<Transform> unaligned_spaces;
+
+	if(params.use_unaligned_nodes) {
+		vector<const BVHNode*> nodes;
+		nodes.push_back(root);
+
+		while(nodes.size()) {
+			const BVHNode *node = nodes.back();
+			nodes.pop_back();
+
+			if(node->is_leaf())
+				continue;
+
+			vector<int> child_prims[2];
+			BoundBox child_bounds[2];
+			Transform space[2];
+
+			for(int i = 0; i < 2; i++) {
+				const BVHNode *child = node->get_child(i);
+
+				if(!gather_prims(child, child_prims[i]))
+					child_prims[i].clear();
+
+				child_bounds[i] = child->m_bounds;
+				nodes.push_back(child);
+			}
+
+			if(unaligned_node_spaces(child_prims, child_bounds, space)) {
+				unaligned_nodes[node] = unaligned_spaces.size();
+				unaligned_spaces.push_back(space[0]);
+				unaligned_spaces.push_back(space[1]);
+			}
+		}
+	}
+
+	size_t node_size = root->getSubtreeSize(BVH_STAT_NODE_COUNT) + unaligned_nodes.size();
 
 	/* resize arrays */
 	pack.nodes.clear();
@@ -587,7 +645,8 @@ void RegularBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 
 	vector<BVHStackEntry> stack;
 	stack.reserve(BVHParams::MAX_DEPTH*2);
-	stack.push_back(BVHStackEntry(root, nextNodeIdx++));
+	stack.push_back(BVHStackEntry(root, nextNodeIdx));
+	nextNodeIdx += (unaligned_nodes.count(root))? 2: 1;
 
 	while(stack.size()) {
 		BVHStackEntry e = stack.back();
@@ -602,10 +661,21 @@ void RegularBVH::pack_nodes(const array<int>& prims, const BVHNode *root)
 		}
 		else {
 			/* innner node */
-			stack.push_back(BVHStackEntry(e.node->get_child(0), nextNodeIdx++));
-			stack.push_back(BVHStackEntry(e.node->get_child(1), nextNodeIdx++));
+			for(int i = 0; i < 2; i++) {
+				const BVHNode *child = e.node->get_child(i);
 
-			pack_inner(e, stack[stack.size()-2], stack[stack.size()-1]);
+				stack.push_back(BVHStackEntry(child, nextNodeIdx));
+				nextNodeIdx += (unaligned_nodes.count(child))? 2: 1;
+			}
+
+			map<const BVHNode*, int>::iterator it = unaligned_nodes.find(e.node);
+
+			if(it != unaligned_nodes.end()) {
+				pack.is_leaf[e.idx + 1] = 0;
+				pack_inner(e, stack[stack.size()-2], stack[stack.size()-1], &unaligned_spaces[it->second]);
+			}
+			else
+				pack_inner(e, stack[stack.size()-2], stack[stack.size()-1]);
 		}
 	}
 
@@ -701,11 +771,28 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 		/* refit inner node, set bbox from children */
 		BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
 		uint visibility0 = 0, visibility1 = 0;
+		bool unaligned = (data[3].z & BVH_NODE_UNALIGNED) != 0;
 
 		refit_node((c0 < 0)? -c0-1: c0, (c0 < 0), bbox0, visibility0);
 		refit_node((c1 < 0)? -c1-1: c1, (c1 < 0), bbox1, visibility1);
 
-		pack_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
+		if(unaligned) {
+			/* recompute oriented bounds, the node keeps its two slots even if
+			 * they are no longer smaller */
+			vector<int> child_prims[2];
+			BoundBox child_bounds[2] = {bbox0, bbox1};
+			Transform space[2];
+
+			if(!gather_packed_prims((c0 < 0)? -c0-1: c0, (c0 < 0), child_prims[0]))
+				child_prims[0].clear();
+			if(!gather_packed_prims((c1 < 0)? -c1-1: c1, (c1 < 0), child_prims[1]))
+				child_prims[1].clear();
+
+			unaligned_node_spaces(child_prims, child_bounds, space);
+			pack_unaligned_node(idx, space, c0, c1, visibility0, visibility1);
+		}
+		else
+			pack_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
 
 		bbox.grow(bbox0);
 		bbox.grow(bbox1);
@@ -713,6 +800,164 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 	}
 }
 
+/* Unaligned Nodes
+ *
+ * Hair strands are thin and often diagonal, so axis aligned bounds around
+ * them are mostly empty space. For children with only curve segments below
+ * them, bounds are also computed in a space aligned with the average segment
+ * direction, and the node stores oriented boxes when that is notably smaller.
+ * Only done for small subtrees, higher up the segments go in all directions. */
+
+/* surface area needed relative to aligned bounds, to pay for the more
+ * expensive node test */
+#define BVH_UNALIGNED_AREA_RATIO 0.7f
+
+/* transform from object space to the unit box of bounds in a rotated space.
+ * padded for float precision of the ray transform in the kernel, which also
+ * keeps the scale finite for flat bounds */
+static Transform bvh_unit_box_space(const Transform& space, const BoundBox& bounds)
+{
+	Transform tfm = space;
+
+	if(!bounds.valid()) {
+		/* empty child, everything is outside the unit box */
+		tfm.x = make_float4(0.0f, 0.0f, 0.0f, -1.0f);
+		tfm.y = make_float4(0.0f, 0.0f, 0.0f, -1.0f);
+		tfm.z = make_float4(0.0f, 0.0f, 0.0f, -1.0f);
+		return tfm;
+	}
+
+	float pad = max(1e-5f*max(len(bounds.min), len(bounds.max)), 1e-10f);
+	float3 lower = bounds.min - make_float3(pad);
+	float3 size = bounds.size() + make_float3(2.0f*pad);
+
+	tfm.x = make_float4(space.x.x, space.x.y, space.x.z, -lower.x) * (1.0f/size.x);
+	tfm.y = make_float4(space.y.x, space.y.y, space.y.z, -lower.y) * (1.0f/size.y);
+	tfm.z = make_float4(space.z.x, space.z.y, space.z.z, -lower.z) * (1.0f/size.z);
+
+	return tfm;
+}
+
+bool RegularBVH::gather_prims(const BVHNode *node, vector<int>& prims)
+{
+	if(node->is_leaf()) {
+		const LeafNode *leaf = reinterpret_cast<const LeafNode*>(node);
+
+		for(int prim = leaf->m_lo; prim < leaf->m_hi; prim++)
+			prims.push_back(prim);
+	}
+	else if(!gather_prims(node->get_child(0), prims) || !gather_prims(node->get_child(1), prims))
+		return false;
+
+	return (prims.size() <= BVHParams::MAX_UNALIGNED_PRIMITIVES);
+}
+
+bool RegularBVH::gather_packed_prims(int idx, bool leaf, vector<int>& prims)
+{
+	int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
+
+	int c0 = data[3].x;
+	int c1 = data[3].y;
+
+	if(leaf) {
+		for(int prim = c0; prim < c1; prim++)
+			prims.push_back(prim);
+	}
+	else if(!gather_packed_prims((c0 < 0)? -c0-1: c0, (c0 < 0), prims) ||
+	        !gather_packed_prims((c1 < 0)? -c1-1: c1, (c1 < 0), prims))
+		return false;
+
+	return (prims.size() <= BVHParams::MAX_UNALIGNED_PRIMITIVES);
+}
+
+bool RegularBVH::curve_space(const vector<int>& prims, Transform *space, BoundBox *bounds)
+{
+	if(prims.size() == 0)
+		return false;
+
+	/* average direction of the segments regardless of their orientation,
+	 * primitive indexes are still local to the mesh here */
+	float3 axis = make_float3(0.0f, 0.0f, 0.0f);
+
+	foreach(int prim, prims) {
+		if(pack.prim_index[prim] == -1 || !(pack.prim_type[prim] & PRIMITIVE_ALL_CURVE))
+			return false;
+
+		const Mesh *mesh = objects[pack.prim_object[prim]]->mesh;
+		const Mesh::Curve& curve = mesh->curves[pack.prim_index[prim]];
+		int k = curve.first_key + PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
+		float3 dir = float4_to_float3(mesh->curve_keys[k + 1]) - float4_to_float3(mesh->curve_keys[k]);
+
+		axis = axis + ((dot(axis, dir) < 0.0f)? -dir: dir);
+	}
+
+	float length;
+	axis = normalize_len(axis, &length);
+
+	if(!(length > 0.0f))
+		return false;
+
+	float3 u, v;
+	make_orthonormals(axis, &u, &v);
+
+	*space = make_transform(u.x, u.y, u.z, 0.0f,
+	                        v.x, v.y, v.z, 0.0f,
+	                        axis.x, axis.y, axis.z, 0.0f,
+	                        0.0f, 0.0f, 0.0f, 1.0f);
+
+	/* bounds in that space */
+	*bounds = BoundBox::empty;
+
+	foreach(int prim, prims) {
+		const Mesh *mesh = objects[pack.prim_object[prim]]->mesh;
+		const Mesh::Curve& curve = mesh->curves[pack.prim_index[prim]];
+		int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
+
+		curve.bounds_grow(k, &mesh->curve_keys[0], *space, *bounds);
+
+		/* motion curves */
+		if(mesh->use_motion_blur) {
+			Attribute *attr = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+
+			if(attr) {
+				size_t mesh_size = mesh->curve_keys.size();
+				size_t steps = mesh->motion_steps - 1;
+				float4 *key_steps = attr->data_float4();
+
+				for(size_t i = 0; i < steps; i++)
+					curve.bounds_grow(k, key_steps + i*mesh_size, *space, *bounds);
+			}
+		}
+	}
+
+	return bounds->valid();
+}
+
+/* fills in the space of both children, returns true if any of them is
+ * oriented and it is worth using an unaligned node. only nodes with curves
+ * on both sides are unaligned, so that traversal of other geometry never
+ * has to test oriented bounds */
+bool RegularBVH::unaligned_node_spaces(const vector<int> prims[2], const BoundBox bounds[2], Transform space[2])
+{
+	bool unaligned = false;
+
+	for(int i = 0; i < 2; i++) {
+		Transform aligned_space;
+		BoundBox aligned_bounds;
+
+		if(curve_space(prims[i], &aligned_space, &aligned_bounds) &&
+		   aligned_bounds.safe_area() < bounds[i].safe_area()*BVH_UNALIGNED_AREA_RATIO)
+		{
+			space[i] = bvh_unit_box_space(aligned_space, aligned_bounds);
+			unaligned = true;
+		}
+		else
+			space[i] = bvh_unit_box_space(transform_identity(), bounds[i]);
+	}
+
+	return unaligned && !prims[0].empty() && !prims[1].empty();
+}
+
 /* QBVH */
 
 QBVH::QBVH(const BVHParams& params_, const vector<Object*>& objects_)
@@ -21,6 +21,7 @@
 #include "bvh_params.h"
 
 #include "util_string.h"
+#include "util_transform.h"
 #include "util_types.h"
 #include "util_vector.h"
 
@@ -46,7 +47,8 @@ class Progress;
 
 struct PackedBVH {
 	/* BVH nodes storage, one node is 4x int4, and contains two bounding boxes,
-	 * and child, triangle or object indexes depending on the node type */
+	 * and child, triangle or object indexes depending on the node type. nodes
+	 * with oriented child bounds take up two slots, see RegularBVH. */
 	array<int4> nodes; 
 	/* object index to BVH node index mapping for instances */
 	array<int> object_node; 
@@ -118,7 +120,10 @@ protected:
 
 /* Regular BVH
  *
- * Typical BVH with each node having two children. */
+ * Typical BVH with each node having two children. Nodes with only curve
+ * segments below them may be unaligned, storing for each child a transform to
+ * the unit box of its oriented bounds. These are flagged with
+ * BVH_NODE_UNALIGNED in the first child visibility and take up two slots. */
 
 class RegularBVH : public BVH {
 protected:
@@ -129,8 +134,15 @@ protected:
 	/* pack */
 	void pack_nodes(const array<int>& prims, const BVHNode *root);
 	void pack_leaf(const BVHStackEntry& e, const LeafNode *leaf);
-	void pack_inner(const BVHStackEntry& e, const BVHStackEntry& e0, const BVHStackEntry& e1);
+	void pack_inner(const BVHStackEntry& e, const BVHStackEntry& e0, const BVHStackEntry& e1, const Transform *space = NULL);
 	void pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int c0, int c1, uint visibility0, uint visibility1);
+	void pack_unaligned_node(int idx, const Transform space[2], int c0, int c1, uint visibility0, uint visibility1);
+
+	/* unaligned nodes */
+	bool gather_prims(const BVHNode *node, vector<int>& prims);
+	bool gather_packed_prims(int idx, bool leaf, vector<int>& prims);
+	bool curve_space(const vector<int>& prims, Transform *space, BoundBox *bounds);
+	bool unaligned_node_spaces(const vector<int> prims[2], const BoundBox bounds[2], Transform space[2]);
 
 	/* refit */
 	void refit_nodes();
@@ -321,6 +321,46 @@ bool BVHBuild::range_within_max_leaf_size(const BVHRange& range)
 	return (num_triangles < params.max_triangle_leaf_size) && (num_curves < params.max_curve_leaf_size);
 }
 
+/* with curve segment merging, a range that is a run of adjacent segments of
+ * a single curve becomes a leaf without further splitting. the bounds of such
+ * segments overlap anyway, so splitting them mostly adds traversal steps. */
+bool BVHBuild::range_is_curve_segment_run(const BVHRange& range)
+{
+	int size = range.size();
+
+	if(size < 2 || size > params.curve_merge_segments || size > BVHParams::MAX_CURVE_MERGE_SEGMENTS)
+		return false;
+
+	const BVHReference& first = references[range.start()];
+	int min_segment = PRIMITIVE_UNPACK_SEGMENT(first.prim_type());
+
+	for(int i = 0; i < size; i++) {
+		BVHReference& ref = references[range.start() + i];
+
+		if(!(ref.prim_type() & PRIMITIVE_ALL_CURVE))
+			return false;
+		if(ref.prim_index() != first.prim_index() || ref.prim_object() != first.prim_object())
+			return false;
+
+		min_segment = min(min_segment, PRIMITIVE_UNPACK_SEGMENT(ref.prim_type()));
+	}
+
+	/* segments must be unique and without gaps */
+	uint segments = 0;
+
+	for(int i = 0; i < size; i++) {
+		BVHReference& ref = references[range.start() + i];
+		int offset = PRIMITIVE_UNPACK_SEGMENT(ref.prim_type()) - min_segment;
+
+		if(offset >= size || (segments & (1 << offset)))
+			return false;
+
+		segments |= (1 << offset);
+	}
+
+	return true;
+}
+
 /* multithreaded binning builder */
 BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 {
@@ -332,7 +372,8 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 	 * visibility tests, since object instances do not check visibility flag */
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
 		/* make leaf node when threshold reached or SAH tells us */
-		if(params.small_enough_for_leaf(size, level) || (range_within_max_leaf_size(range) && leafSAH < splitSAH))
+		if(params.small_enough_for_leaf(size, level) || range_is_curve_segment_run(range) ||
+		   (range_within_max_leaf_size(range) && leafSAH < splitSAH))
 			return create_leaf_node(range);
 	}
 
@@ -371,7 +412,7 @@ BVHNode* BVHBuild::build_node(const BVHRange& range, int level)
 
 	/* small enough or too deep => create leaf. */
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
-		if(params.small_enough_for_leaf(range.size(), level)) {
+		if(params.small_enough_for_leaf(range.size(), level) || range_is_curve_segment_run(range)) {
 			progress_count += range.size();
 			return create_leaf_node(range);
 		}
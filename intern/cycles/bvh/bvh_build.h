@@ -71,6 +71,7 @@ protected:
 	BVHNode *create_object_leaf_nodes(const BVHReference *ref, int start, int num);
 
 	bool range_within_max_leaf_size(const BVHRange& range);
+	bool range_is_curve_segment_run(const BVHRange& range);
 
 	/* threads */
 	enum { THREAD_TASK_SIZE = 4096 };
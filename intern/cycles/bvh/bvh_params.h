@@ -49,13 +49,21 @@ public:
 	/* QBVH */
 	int use_qbvh;
 
+	/* oriented bounds for nodes with only curve segments below them */
+	int use_unaligned_nodes;
+
+	/* keep runs of up to this many adjacent segments of a curve in one leaf */
+	int curve_merge_segments;
+
 	int pad;
 
 	/* fixed parameters */
 	enum {
 		MAX_DEPTH = 64,
 		MAX_SPATIAL_DEPTH = 48,
-		NUM_SPATIAL_BINS = 32
+		NUM_SPATIAL_BINS = 32,
+		MAX_UNALIGNED_PRIMITIVES = 64,
+		MAX_CURVE_MERGE_SEGMENTS = 16
 	};
 
 	BVHParams()
@@ -75,6 +83,8 @@ public:
 		top_level = false;
 		use_cache = false;
 		use_qbvh = false;
+		use_unaligned_nodes = true;
+		curve_merge_segments = 1;
 		pad = false;
 	}
 
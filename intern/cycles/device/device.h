@@ -130,8 +130,9 @@ public:
 		const DeviceDrawParams &draw_params);
 
 #ifdef WITH_NETWORK
-	/* networking */
-	void server_run();
+	/* networking, cache_size is the memory limit for buffers kept across
+	 * renders so they don't have to be sent again */
+	void server_run(size_t cache_size = 0);
 #endif
 
 	/* multi device */
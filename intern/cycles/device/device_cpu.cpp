@@ -37,6 +37,7 @@
 #include "util_progress.h"
 #include "util_system.h"
 #include "util_thread.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -56,12 +57,15 @@ public:
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
+		/* profiling is only active for threads registered with the profiler */
+		memset(&kernel_globals.profiler, 0, sizeof(kernel_globals.profiler));
 
 		/* do now to avoid thread issues */
 		system_cpu_support_sse2();
 		system_cpu_support_sse3();
 		system_cpu_support_sse41();
 		system_cpu_support_avx();
+		system_cpu_support_avx2();
 	}
 
 	~CPUDevice()
@@ -159,14 +163,49 @@ public:
 		OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
 
+		bool use_profiling = stats.profiler.active();
+
+		if(use_profiling)
+			stats.profiler.add_state(&kg.profiler);
+
 		RenderTile tile;
 		
 		while(task.acquire_tile(this, tile)) {
+			ProfilingTile ptile;
+
+			if(use_profiling)
+				profiling_tile_begin(kg, tile, ptile);
+
 			float *render_buffer = (float*)tile.buffer;
 			uint *rng_state = (uint*)tile.rng_state;
 			int start_sample = tile.start_sample;
 			int end_sample = tile.start_sample + tile.num_samples;
 
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
+			if(system_cpu_support_avx2()) {
+				for(int sample = start_sample; sample < end_sample; sample++) {
+					if (task.get_cancel() || task_pool.canceled()) {
+						if(task.need_finish_queue == false)
+							break;
+					}
+
+					/* neighbouring pixels are traced as ray packets */
+					for(int y = tile.y; y < tile.y + tile.h; y++) {
+						for(int x = tile.x; x < tile.x + tile.w; x += RAY_PACKET_SIZE) {
+							int num = min(RAY_PACKET_SIZE, tile.x + tile.w - x);
+
+							kernel_cpu_avx2_path_trace_packet(&kg, render_buffer, rng_state,
+								sample, x, y, num, tile.offset, tile.stride);
+						}
+					}
+
+					tile.sample = sample + 1;
+
+					task.update_progress(tile);
+				}
+			}
+			else
+#endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX
 			if(system_cpu_support_avx()) {
 				for(int sample = start_sample; sample < end_sample; sample++) {
@@ -175,10 +214,13 @@ public:
 							break;
 					}
 
+					/* neighbouring pixels are traced as ray packets */
 					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_avx_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+						for(int x = tile.x; x < tile.x + tile.w; x += RAY_PACKET_SIZE) {
+							int num = min(RAY_PACKET_SIZE, tile.x + tile.w - x);
+
+							kernel_cpu_avx_path_trace_packet(&kg, render_buffer, rng_state,
+								sample, x, y, num, tile.offset, tile.stride);
 						}
 					}
 
@@ -197,10 +239,13 @@ public:
 							break;
 					}
 
+					/* neighbouring pixels are traced as ray packets */
 					for(int y = tile.y; y < tile.y + tile.h; y++) {
-						for(int x = tile.x; x < tile.x + tile.w; x++) {
-							kernel_cpu_sse41_path_trace(&kg, render_buffer, rng_state,
-								sample, x, y, tile.offset, tile.stride);
+						for(int x = tile.x; x < tile.x + tile.w; x += RAY_PACKET_SIZE) {
+							int num = min(RAY_PACKET_SIZE, tile.x + tile.w - x);
+
+							kernel_cpu_sse41_path_trace_packet(&kg, render_buffer, rng_state,
+								sample, x, y, num, tile.offset, tile.stride);
 						}
 					}
 
@@ -275,6 +320,9 @@ public:
 				}
 			}
 
+			if(use_profiling)
+				profiling_tile_end(kg, tile, ptile);
+
 			task.release_tile(tile);
 
 			if(task_pool.canceled()) {
@@ -283,16 +331,53 @@ public:
 			}
 		}
 
+		if(use_profiling)
+			stats.profiler.remove_state(&kg.profiler);
+
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
 	}
 
+	void profiling_tile_begin(KernelGlobals& kg, RenderTile& tile, ProfilingTile& ptile)
+	{
+		ptile.x = tile.x;
+		ptile.y = tile.y;
+		ptile.w = tile.w;
+		ptile.h = tile.h;
+		ptile.samples = tile.num_samples;
+		ptile.thread_index = kg.profiler.thread_index;
+		ptile.time = time_dt();
+		memcpy(ptile.rays, kg.profiler.rays, sizeof(ptile.rays));
+	}
+
+	void profiling_tile_end(KernelGlobals& kg, RenderTile& tile, ProfilingTile& ptile)
+	{
+		/* time and rays spent on this tile only */
+		ptile.time = time_dt() - ptile.time;
+
+		for(int i = 0; i < PROFILING_NUM_RAYS; i++)
+			ptile.rays[i] = kg.profiler.rays[i] - ptile.rays[i];
+
+		PROFILING_EVENT(&kg, PROFILING_IDLE);
+
+		stats.profiler.add_tile(ptile);
+	}
+
 	void thread_film_convert(DeviceTask& task)
 	{
 		float sample_scale = 1.0f/(task.sample + 1);
 
 		if(task.rgba_half) {
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
+			if(system_cpu_support_avx2()) {
+				for(int y = task.y; y < task.y + task.h; y++)
+					for(int x = task.x; x < task.x + task.w; x++)
+						kernel_cpu_avx2_convert_to_half_float(&kernel_globals, (uchar4*)task.rgba_half, (float*)task.buffer,
+							sample_scale, x, y, task.offset, task.stride);
+			}
+			else
+#endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX
 			if(system_cpu_support_avx()) {
 				for(int y = task.y; y < task.y + task.h; y++)
@@ -337,6 +422,15 @@ public:
 			}
 		}
 		else {
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
+			if(system_cpu_support_avx2()) {
+				for(int y = task.y; y < task.y + task.h; y++)
+					for(int x = task.x; x < task.x + task.w; x++)
+						kernel_cpu_avx2_convert_to_byte(&kernel_globals, (uchar4*)task.rgba_byte, (float*)task.buffer,
+							sample_scale, x, y, task.offset, task.stride);
+			}
+			else
+#endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX
 			if(system_cpu_support_avx()) {
 				for(int y = task.y; y < task.y + task.h; y++)
@@ -390,6 +484,17 @@ public:
 		OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
 
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
+		if(system_cpu_support_avx2()) {
+			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
+				kernel_cpu_avx2_shader(&kg, (uint4*)task.shader_input, (float4*)task.shader_output, task.shader_eval_type, x);
+
+				if(task.get_cancel() || task_pool.canceled())
+					break;
+			}
+		}
+		else
+#endif
 #ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX
 		if(system_cpu_support_avx()) {
 			for(int x = task.shader_x; x < task.shader_x + task.shader_w; x++) {
@@ -26,6 +26,7 @@
 #include "util_foreach.h"
 #include "util_list.h"
 #include "util_map.h"
+#include "util_thread.h"
 #include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
@@ -301,8 +302,26 @@ public:
 
 	void task_wait()
 	{
-		foreach(SubDevice& sub, devices)
-			sub.device->task_wait();
+		/* wait for all devices at the same time, network devices hand out
+		 * tiles to their server from task_wait, so waiting on them one after
+		 * the other would leave all but one server idle */
+		list<thread*> threads;
+		Device *first_device = NULL;
+
+		foreach(SubDevice& sub, devices) {
+			if(!first_device)
+				first_device = sub.device;
+			else
+				threads.push_back(new thread(function_bind(&Device::task_wait, sub.device)));
+		}
+
+		if(first_device)
+			first_device->task_wait();
+
+		foreach(thread *t, threads) {
+			t->join();
+			delete t;
+		}
 	}
 
 	void task_cancel()
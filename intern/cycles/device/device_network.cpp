@@ -19,6 +19,7 @@
 #include "device_network.h"
 
 #include "util_foreach.h"
+#include "util_md5.h"
 
 #if defined(WITH_NETWORK)
 
@@ -28,9 +29,131 @@ typedef map<device_ptr, device_ptr> PtrMap;
 typedef vector<uint8_t> DataVector;
 typedef map<device_ptr, DataVector> DataMap;
 
+/* layout of a device buffer, needed to copy it back from the device */
+struct MemInfo {
+	DataType data_type;
+	int data_elements;
+	size_t data_size;
+};
+typedef map<device_ptr, MemInfo> MemInfoMap;
+
 /* tile list */
 typedef vector<RenderTile> TileList;
 
+/* number of tiles a server requests ahead of its device threads */
+static const int SERVER_TILE_PREFETCH = 2;
+
+/* buffers smaller than this are always sent, hashing isn't worth it */
+static const size_t CACHE_MIN_SIZE = 64*1024;
+
+/* content hash of a device buffer, empty if the buffer is too small to cache */
+static string memory_hash(const void *data, size_t size)
+{
+	if(size < CACHE_MIN_SIZE)
+		return "";
+
+	MD5Hash md5;
+	const uint8_t *bytes = (const uint8_t*)data;
+	const size_t chunk = 1 << 30;
+
+	for(size_t offset = 0; offset < size; offset += chunk) {
+		size_t chunk_size = (size - offset < chunk)? size - offset: chunk;
+		md5.append(bytes + offset, (int)chunk_size);
+	}
+
+	/* include size to make collisions between different sizes impossible */
+	md5.append((const uint8_t*)&size, sizeof(size));
+
+	return md5.get_hex();
+}
+
+/* Content addressed cache of device buffers received by a server. It lives
+ * for the lifetime of the server process, so buffers that are unchanged
+ * between renders (frames of an animation) do not need to be transferred
+ * again. Least recently used buffers are evicted when over the size limit. */
+
+class ServerCache {
+public:
+	ServerCache(size_t limit_)
+	: limit(limit_), size(0)
+	{
+	}
+
+	bool contains(const string& hash)
+	{
+		thread_scoped_lock lock(cache_mutex);
+		return (find(hash) != entries.end());
+	}
+
+	/* copy cached data into buffer, returns false if not found */
+	bool lookup(const string& hash, void *buffer, size_t buffer_size)
+	{
+		thread_scoped_lock lock(cache_mutex);
+		EntryMap::iterator it = find(hash);
+
+		if(it == entries.end() || it->second.data.size() != buffer_size)
+			return false;
+
+		if(buffer_size)
+			memcpy(buffer, &it->second.data[0], buffer_size);
+
+		return true;
+	}
+
+	void insert(const string& hash, const void *buffer, size_t buffer_size)
+	{
+		if(hash.empty() || buffer_size > limit)
+			return;
+
+		thread_scoped_lock lock(cache_mutex);
+
+		if(find(hash) != entries.end())
+			return;
+
+		/* evict least recently used entries until the new buffer fits */
+		while(size + buffer_size > limit && !lru.empty()) {
+			EntryMap::iterator it = entries.find(lru.back());
+			size -= it->second.data.size();
+			entries.erase(it);
+			lru.pop_back();
+		}
+
+		lru.push_front(hash);
+
+		Entry& entry = entries[hash];
+		entry.lru_it = lru.begin();
+		entry.data.resize(buffer_size);
+		if(buffer_size)
+			memcpy(&entry.data[0], buffer, buffer_size);
+
+		size += buffer_size;
+	}
+
+protected:
+	struct Entry {
+		DataVector data;
+		list<string>::iterator lru_it;
+	};
+	typedef map<string, Entry> EntryMap;
+
+	/* find entry and mark it as most recently used */
+	EntryMap::iterator find(const string& hash)
+	{
+		EntryMap::iterator it = entries.find(hash);
+
+		if(it != entries.end())
+			lru.splice(lru.begin(), lru, it->second.lru_it);
+
+		return it;
+	}
+
+	thread_mutex cache_mutex;
+	EntryMap entries;
+	list<string> lru;
+	size_t limit;
+	size_t size;
+};
+
 /* search a list of tiles and find the one that matches the passed render tile */
 static TileList::iterator tile_list_find(TileList& tile_list, RenderTile& tile)
 {
@@ -48,6 +171,13 @@ public:
 	device_ptr mem_counter;
 	DeviceTask the_task; /* todo: handle multiple tasks */
 
+	/* tile buffers whose contents were already received along with release_tile */
+	set<device_ptr> synced_buffers;
+
+	/* set while task_wait receives tile requests, the server may send them at
+	 * any time then so no other replies can be read from the socket */
+	bool in_task_wait;
+
 	thread_mutex rpc_lock;
 
 	NetworkDevice(DeviceInfo& info, Stats &stats, const char *address)
@@ -73,6 +203,7 @@ public:
 			error_func.network_error(error.message());
 
 		mem_counter = 0;
+		in_task_wait = false;
 	}
 
 	~NetworkDevice()
@@ -98,17 +229,29 @@ public:
 	{
 		thread_scoped_lock lock(rpc_lock);
 
+		string hash = memory_hash((void*)mem.data_pointer, mem.memory_size());
+		bool cached = mem_cached(hash);
+
 		RPCSend snd(socket, &error_func, "mem_copy_to");
 
 		snd.add(mem);
-		snd.write();
-		snd.write_buffer((void*)mem.data_pointer, mem.memory_size());
+		snd.add(hash);
+		snd.add(cached);
+
+		if(cached)
+			snd.write();
+		else
+			snd.write((void*)mem.data_pointer, mem.memory_size());
 	}
 
 	void mem_copy_from(device_memory& mem, int y, int w, int h, int elem)
 	{
 		thread_scoped_lock lock(rpc_lock);
 
+		/* skip the round trip if the server already sent us the data */
+		if(synced_buffers.erase(mem.device_pointer))
+			return;
+
 		size_t data_size = mem.memory_size();
 
 		RPCSend snd(socket, &error_func, "mem_copy_from");
@@ -139,6 +282,8 @@ public:
 		if(mem.device_pointer) {
 			thread_scoped_lock lock(rpc_lock);
 
+			synced_buffers.erase(mem.device_pointer);
+
 			RPCSend snd(socket, &error_func, "mem_free");
 
 			snd.add(mem);
@@ -158,8 +303,7 @@ public:
 
 		snd.add(name_string);
 		snd.add(size);
-		snd.write();
-		snd.write_buffer(host, size);
+		snd.write(host, size);
 	}
 
 	void tex_alloc(const char *name, device_memory& mem, InterpolationType interpolation, bool periodic)
@@ -168,6 +312,9 @@ public:
 
 		mem.device_pointer = ++mem_counter;
 
+		string hash = memory_hash((void*)mem.data_pointer, mem.memory_size());
+		bool cached = mem_cached(hash);
+
 		RPCSend snd(socket, &error_func, "tex_alloc");
 
 		string name_string(name);
@@ -176,8 +323,13 @@ public:
 		snd.add(mem);
 		snd.add(interpolation);
 		snd.add(periodic);
-		snd.write();
-		snd.write_buffer((void*)mem.data_pointer, mem.memory_size());
+		snd.add(hash);
+		snd.add(cached);
+
+		if(cached)
+			snd.write();
+		else
+			snd.write((void*)mem.data_pointer, mem.memory_size());
 	}
 
 	void tex_free(device_memory& mem)
@@ -230,6 +382,7 @@ public:
 		RPCSend snd(socket, &error_func, "task_wait");
 		snd.write();
 
+		in_task_wait = true;
 		lock.unlock();
 
 		TileList the_tiles;
@@ -251,9 +404,19 @@ public:
 				if(the_task.acquire_tile(this, tile)) { /* write return as bool */
 					the_tiles.push_back(tile);
 
+					/* temporary tile buffers allocated on this device are sent back
+					 * along with release_tile, saving a mem_copy_from round trip per
+					 * tile. buffers owned by another device (e.g. a multi device) are
+					 * left to the regular copy from their own device */
+					bool return_buffer = (tile.buffers &&
+					                      tile.buffers->get_device() == this &&
+					                      tile.buffers->params.width == tile.w &&
+					                      tile.buffers->params.height == tile.h);
+
 					lock.lock();
 					RPCSend snd(socket, &error_func, "acquire_tile");
 					snd.add(tile);
+					snd.add(return_buffer);
 					snd.write();
 					lock.unlock();
 				}
@@ -266,7 +429,6 @@ public:
 			}
 			else if(rcv.name == "release_tile") {
 				rcv.read(tile);
-				lock.unlock();
 
 				TileList::iterator it = tile_list_find(the_tiles, tile);
 				if (it != the_tiles.end()) {
@@ -276,12 +438,30 @@ public:
 
 				assert(tile.buffers != NULL);
 
-				the_task.release_tile(tile);
+				/* read tile buffer contents directly into the host memory */
+				device_ptr synced_buffer = 0;
+
+				if(rcv.has_payload()) {
+					device_vector<float>& buffer = tile.buffers->buffer;
+					rcv.read_buffer((void*)buffer.data_pointer, buffer.memory_size());
+
+					if(tile.buffers->get_device() == this) {
+						synced_buffer = buffer.device_pointer;
+						synced_buffers.insert(synced_buffer);
+					}
+				}
 
-				lock.lock();
-				RPCSend snd(socket, &error_func, "release_tile");
-				snd.write();
 				lock.unlock();
+
+				/* no acknowledgement is sent, the server continues rendering */
+				the_task.release_tile(tile);
+
+				/* the data is only valid for the copy made while releasing the tile */
+				if(synced_buffer) {
+					lock.lock();
+					synced_buffers.erase(synced_buffer);
+					lock.unlock();
+				}
 			}
 			else if(rcv.name == "task_wait_done") {
 				lock.unlock();
@@ -290,6 +470,9 @@ public:
 			else
 				lock.unlock();
 		}
+
+		lock.lock();
+		in_task_wait = false;
 	}
 
 	void task_cancel()
@@ -300,6 +483,25 @@ public:
 	}
 
 private:
+	/* ask the server if it still has a buffer with this content from a
+	 * previous render, rpc_lock must be held. Not during task_wait, buffers
+	 * reset from acquire_tile are always sent then */
+	bool mem_cached(const string& hash)
+	{
+		if(hash.empty() || in_task_wait)
+			return false;
+
+		RPCSend snd(socket, &error_func, "mem_cached");
+		snd.add(hash);
+		snd.write();
+
+		bool result = false;
+		RPCReceive rcv(socket, &error_func);
+		rcv.read(result);
+
+		return result;
+	}
+
 	NetworkError error_func;
 };
 
@@ -332,8 +534,9 @@ public:
 
 	bool have_error() { return error_func.have_error(); }
 
-	DeviceServer(Device *device_, tcp::socket& socket_)
-	: device(device_), socket(socket_), stop(false), blocked_waiting(false)
+	DeviceServer(Device *device_, tcp::socket& socket_, ServerCache& cache_)
+	: device(device_), socket(socket_), cache(cache_), num_pending_tiles(0), tiles_exhausted(false),
+	  stop(false), blocked_waiting(false)
 	{
 		error_func = NetworkError();
 	}
@@ -408,6 +611,13 @@ protected:
 		return i->second;
 	}
 
+	device_ptr client_pointer_from_device_ptr(device_ptr real_pointer)
+	{
+		PtrMap::iterator i = ptr_imap.find(real_pointer);
+		assert(i != ptr_imap.end());
+		return i->second;
+	}
+
 	device_ptr device_ptr_from_client_pointer_erase(device_ptr client_pointer)
 	{
 		PtrMap::iterator i = ptr_map.find(client_pointer);
@@ -428,6 +638,8 @@ protected:
 		assert(idata != mem_data.end());
 		mem_data.erase(idata);
 
+		mem_info.erase(client_pointer);
+
 		return result;
 	}
 
@@ -459,6 +671,13 @@ protected:
 			else
 				mem.data_pointer = 0;
 
+			/* remember the layout for copying tile buffers back */
+			MemInfo info;
+			info.data_type = mem.data_type;
+			info.data_elements = mem.data_elements;
+			info.data_size = mem.data_size;
+			mem_info[client_pointer] = info;
+
 			/* perform the allocation on the actual device */
 			device->mem_alloc(mem, type);
 
@@ -467,9 +686,12 @@ protected:
 		}
 		else if(rcv.name == "mem_copy_to") {
 			network_device_memory mem;
+			string hash;
+			bool cached;
 
 			rcv.read(mem);
-			lock.unlock();
+			rcv.read(hash);
+			rcv.read(cached);
 
 			device_ptr client_pointer = mem.device_pointer;
 
@@ -480,8 +702,10 @@ protected:
 			/* get pointer to memory buffer	for device buffer */
 			mem.data_pointer = (device_ptr)&data_v[0];
 
-			/* copy data from network into memory buffer */
-			rcv.read_buffer((uint8_t*)mem.data_pointer, data_size);
+			/* copy data from network or cache into memory buffer, the payload
+			 * follows the header on the socket so keep the lock until read */
+			read_buffer_cached(rcv, hash, cached, (uint8_t*)mem.data_pointer, data_size);
+			lock.unlock();
 
 			/* translate the client pointer to a real device pointer */
 			mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
@@ -511,8 +735,7 @@ protected:
 			size_t data_size = mem.memory_size();
 
 			RPCSend snd(socket, &error_func, "mem_copy_from");
-			snd.write();
-			snd.write_buffer((uint8_t*)mem.data_pointer, data_size);
+			snd.write((uint8_t*)mem.data_pointer, data_size);
 			lock.unlock();
 		}
 		else if(rcv.name == "mem_zero") {
@@ -561,13 +784,16 @@ protected:
 			string name;
 			InterpolationType interpolation;
 			bool periodic;
+			string hash;
+			bool cached;
 			device_ptr client_pointer;
 
 			rcv.read(name);
 			rcv.read(mem);
 			rcv.read(interpolation);
 			rcv.read(periodic);
-			lock.unlock();
+			rcv.read(hash);
+			rcv.read(cached);
 
 			client_pointer = mem.device_pointer;
 
@@ -580,7 +806,8 @@ protected:
 			else
 				mem.data_pointer = 0;
 
-			rcv.read_buffer((uint8_t*)mem.data_pointer, data_size);
+			read_buffer_cached(rcv, hash, cached, (uint8_t*)mem.data_pointer, data_size);
+			lock.unlock();
 
 			device->tex_alloc(name.c_str(), mem, interpolation, periodic);
 
@@ -599,6 +826,17 @@ protected:
 
 			device->tex_free(mem);
 		}
+		else if(rcv.name == "mem_cached") {
+			string hash;
+			rcv.read(hash);
+
+			bool result = cache.contains(hash);
+
+			RPCSend snd(socket, &error_func, "mem_cached");
+			snd.add(result);
+			snd.write();
+			lock.unlock();
+		}
 		else if(rcv.name == "load_kernels") {
 			bool experimental;
 			rcv.read(experimental);
@@ -632,6 +870,9 @@ protected:
 				task.shader_output = device_ptr_from_client_pointer(task.shader_output);
 
 
+			num_pending_tiles = 0;
+			tiles_exhausted = false;
+
 			task.acquire_tile = function_bind(&DeviceServer::task_acquire_tile, this, _1, _2);
 			task.release_tile = function_bind(&DeviceServer::task_release_tile, this, _1);
 			task.update_progress_sample = function_bind(&DeviceServer::task_update_progress_sample, this);
@@ -660,18 +901,14 @@ protected:
 			AcquireEntry entry;
 			entry.name = rcv.name;
 			rcv.read(entry.tile);
+			rcv.read(entry.return_buffer);
 			acquire_queue.push_back(entry);
 			lock.unlock();
 		}
 		else if(rcv.name == "acquire_tile_none") {
 			AcquireEntry entry;
 			entry.name = rcv.name;
-			acquire_queue.push_back(entry);
-			lock.unlock();
-		}
-		else if(rcv.name == "release_tile") {
-			AcquireEntry entry;
-			entry.name = rcv.name;
+			entry.return_buffer = false;
 			acquire_queue.push_back(entry);
 			lock.unlock();
 		}
@@ -681,45 +918,74 @@ protected:
 		}
 	}
 
+	/* read buffer contents either from the cache or the network, and add
+	 * buffers received over the network to the cache */
+	void read_buffer_cached(RPCReceive& rcv, const string& hash, bool cached, uint8_t *buffer, size_t size)
+	{
+		if(cached) {
+			/* the client only skips sending after we confirmed the cache entry
+			 * exists, and nothing else is inserted in between */
+			if(!cache.lookup(hash, buffer, size))
+				error_func.network_error("Network cache error: buffer missing from cache");
+		}
+		else {
+			rcv.read_buffer(buffer, size);
+			cache.insert(hash, buffer, size);
+		}
+	}
+
 	bool task_acquire_tile(Device *device, RenderTile& tile)
 	{
 		thread_scoped_lock acquire_lock(acquire_mutex);
 
-		bool result = false;
+		/* keep a few tile requests in flight, so device threads don't have
+		 * to wait for a round trip to the client for every tile */
+		if(!tiles_exhausted) {
+			thread_scoped_lock lock(rpc_lock);
 
-		RPCSend snd(socket, &error_func, "acquire_tile");
-		snd.write();
+			while(num_pending_tiles < 1 + SERVER_TILE_PREFETCH) {
+				RPCSend snd(socket, &error_func, "acquire_tile");
+				snd.write();
+				num_pending_tiles++;
+			}
+		}
 
-		do {
+		/* even if the client ran out of tiles, earlier requests may still
+		 * return tiles that must be rendered */
+		while(num_pending_tiles > 0 && !stop && !have_error()) {
 			if(blocked_waiting)
 				listen_step();
 
 			/* todo: avoid busy wait loop */
 			thread_scoped_lock lock(rpc_lock);
 
-			if(!acquire_queue.empty()) {
-				AcquireEntry entry = acquire_queue.front();
-				acquire_queue.pop_front();
+			if(acquire_queue.empty())
+				continue;
 
-				if(entry.name == "acquire_tile") {
-					tile = entry.tile;
+			AcquireEntry entry = acquire_queue.front();
+			acquire_queue.pop_front();
+			num_pending_tiles--;
 
-					if(tile.buffer) tile.buffer = ptr_map[tile.buffer];
-					if(tile.rng_state) tile.rng_state = ptr_map[tile.rng_state];
+			if(entry.name == "acquire_tile") {
+				tile = entry.tile;
 
-					result = true;
-					break;
-				}
-				else if(entry.name == "acquire_tile_none") {
-					break;
-				}
-				else {
-					cout << "Error: unexpected acquire RPC receive call \"" + entry.name + "\"\n";
-				}
+				if(tile.buffer) tile.buffer = device_ptr_from_client_pointer(tile.buffer);
+				if(tile.rng_state) tile.rng_state = device_ptr_from_client_pointer(tile.rng_state);
+
+				if(entry.return_buffer)
+					return_buffers.insert(tile.buffer);
+
+				return true;
 			}
-		} while(acquire_queue.empty() && !stop && !have_error());
+			else if(entry.name == "acquire_tile_none") {
+				tiles_exhausted = true;
+			}
+			else {
+				cout << "Error: unexpected acquire RPC receive call \"" + entry.name + "\"\n";
+			}
+		}
 
-		return result;
+		return false;
 	}
 
 	void task_update_progress_sample()
@@ -736,37 +1002,55 @@ protected:
 	{
 		thread_scoped_lock acquire_lock(acquire_mutex);
 
-		if(tile.buffer) tile.buffer = ptr_imap[tile.buffer];
-		if(tile.rng_state) tile.rng_state = ptr_imap[tile.rng_state];
+		bool return_buffer = (return_buffers.erase(tile.buffer) != 0);
+		device_ptr real_buffer = tile.buffer;
+
+		const void *payload = NULL;
+		size_t payload_size = 0;
+		network_device_memory mem;
 
+		/* the pointer maps and buffers are modified by the listen thread */
 		{
 			thread_scoped_lock lock(rpc_lock);
-			RPCSend snd(socket, &error_func, "release_tile");
-			snd.add(tile);
-			snd.write();
-			lock.unlock();
-		}
 
-		do {
-			if(blocked_waiting)
-				listen_step();
+			if(tile.buffer) tile.buffer = client_pointer_from_device_ptr(tile.buffer);
+			if(tile.rng_state) tile.rng_state = client_pointer_from_device_ptr(tile.rng_state);
 
-			/* todo: avoid busy wait loop */
-			thread_scoped_lock lock(rpc_lock);
+			if(return_buffer) {
+				MemInfoMap::iterator info = mem_info.find(tile.buffer);
+				DataMap::iterator data = mem_data.find(tile.buffer);
 
-			if(!acquire_queue.empty()) {
-				AcquireEntry entry = acquire_queue.front();
-				acquire_queue.pop_front();
+				if(info != mem_info.end() && data != mem_data.end()) {
+					DataVector &data_v = data->second;
 
-				if(entry.name == "release_tile") {
-					lock.unlock();
-					break;
-				}
-				else {
-					cout << "Error: unexpected release RPC receive call \"" + entry.name + "\"\n";
+					mem.data_type = info->second.data_type;
+					mem.data_elements = info->second.data_elements;
+					mem.data_size = info->second.data_size;
+					mem.data_width = info->second.data_size;
+					mem.data_height = 0;
+					mem.data_depth = 0;
+					mem.data_pointer = (data_v.size())? (device_ptr)&data_v[0]: 0;
+					mem.device_pointer = real_buffer;
 				}
+				else
+					return_buffer = false;
 			}
-		} while(acquire_queue.empty() && !stop);
+		}
+
+		if(return_buffer) {
+			/* copy the tile buffer back from the device, and send it along
+			 * with the release so the client doesn't need to request it */
+			payload_size = mem.memory_size();
+			device->mem_copy_from(mem, 0, payload_size, 1, 1);
+			payload = (void*)mem.data_pointer;
+		}
+
+		/* release is not acknowledged by the client, so the device can go
+		 * straight on to acquire the next tile */
+		thread_scoped_lock lock(rpc_lock);
+		RPCSend snd(socket, &error_func, "release_tile");
+		snd.add(tile);
+		snd.write(payload, payload_size);
 	}
 
 	bool task_get_cancel()
@@ -777,19 +1061,26 @@ protected:
 	/* properties */
 	Device *device;
 	tcp::socket& socket;
+	ServerCache& cache;
 
 	/* mapping of remote to local pointer */
 	PtrMap ptr_map;
 	PtrMap ptr_imap;
 	DataMap mem_data;
 
+	MemInfoMap mem_info;
+
 	struct AcquireEntry {
 		string name;
 		RenderTile tile;
+		bool return_buffer;
 	};
 
 	thread_mutex acquire_mutex;
 	list<AcquireEntry> acquire_queue;
+	set<device_ptr> return_buffers;
+	int num_pending_tiles;
+	bool tiles_exhausted;
 
 	bool stop;
 	bool blocked_waiting;
@@ -800,12 +1091,16 @@ private:
 
 };
 
-void Device::server_run()
+void Device::server_run(size_t cache_size)
 {
 	try {
 		/* starts thread that responds to discovery requests */
 		ServerDiscovery discovery;
 
+		/* buffers are cached across connections, renders of successive
+		 * frames each use a new connection */
+		ServerCache cache(cache_size);
+
 		for(;;) {
 			/* accept connection */
 			boost::asio::io_service io_service;
@@ -817,7 +1112,7 @@ void Device::server_run()
 			string remote_address = socket.remote_endpoint().address().to_string();
 			printf("Connected to remote client at: %s\n", remote_address.c_str());
 
-			DeviceServer server(this, socket);
+			DeviceServer server(this, socket, cache);
 			server.listen();
 
 			printf("Disconnected.\n");
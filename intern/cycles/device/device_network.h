@@ -19,16 +19,13 @@
 
 #ifdef WITH_NETWORK
 
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
-#include <boost/archive/binary_iarchive.hpp>
-#include <boost/archive/binary_oarchive.hpp>
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
-#include <boost/serialization/vector.hpp>
 #include <boost/thread.hpp>
 
+#include <zlib.h>
+
 #include <iostream>
 #include <sstream>
 #include <deque>
@@ -38,6 +35,8 @@
 #include "util_foreach.h"
 #include "util_list.h"
 #include "util_map.h"
+#include "util_math.h"
+#include "util_set.h"
 #include "util_string.h"
 
 CCL_NAMESPACE_BEGIN
@@ -55,13 +54,47 @@ static const int DISCOVER_PORT = 5121;
 static const string DISCOVER_REQUEST_MSG = "REQUEST_RENDER_SERVER_IP";
 static const string DISCOVER_REPLY_MSG = "REPLY_RENDER_SERVER_IP";
 
-#if 0
-typedef boost::archive::text_oarchive o_archive;
-typedef boost::archive::text_iarchive i_archive;
-#else
-typedef boost::archive::binary_oarchive o_archive;
-typedef boost::archive::binary_iarchive i_archive;
-#endif
+/* Wire format
+ *
+ * Every remote procedure call is sent as a single frame: a fixed size
+ * RPCHeader, followed by args_size bytes of packed arguments, followed by an
+ * optional payload holding raw device memory. Arguments are packed in host
+ * byte order, so client and servers are expected to share endianness.
+ *
+ * The payload is never copied into the argument block; it is handed to the
+ * socket directly from the device_memory data pointer using scatter/gather
+ * writes, and read on the other side straight into the destination buffer.
+ * Large payloads can optionally be compressed with zlib, controlled by the
+ * CYCLES_NETWORK_COMPRESSION environment variable (zlib level 1-9). */
+
+static const uint32_t RPC_MAGIC = 0x43594331; /* "CYC1" */
+static const size_t RPC_NAME_SIZE = 32;
+static const size_t RPC_COMPRESS_MIN_SIZE = 64*1024;
+
+enum RPCFlag {
+	RPC_FLAG_PAYLOAD_COMPRESSED = (1 << 0)
+};
+
+struct RPCHeader {
+	uint32_t magic;
+	uint32_t flags;
+	char name[RPC_NAME_SIZE];
+	uint64_t args_size;
+	uint64_t payload_size;      /* size of payload on the wire */
+	uint64_t payload_raw_size;  /* size of payload after decompression */
+};
+
+static inline int network_compression_level()
+{
+	static int level = -1;
+
+	if(level == -1) {
+		const char *env = getenv("CYCLES_NETWORK_COMPRESSION");
+		level = (env)? clamp(atoi(env), 0, 9): 0;
+	}
+
+	return level;
+}
 
 /* Serialization of device memory */
 
@@ -104,11 +137,10 @@ private:
 class RPCSend {
 public:
 	RPCSend(tcp::socket& socket_, NetworkError* e, const string& name_ = "")
-	: name(name_), socket(socket_), archive(archive_stream), sent(false)
+	: name(name_), socket(socket_), sent(false)
 	{
-		archive & name_;
 		error_func = e;
-		fprintf(stderr, "rpc send %s\n", name.c_str());
+		assert(name.size() < RPC_NAME_SIZE);
 	}
 
 	~RPCSend()
@@ -117,81 +149,100 @@ public:
 
 	void add(const device_memory& mem)
 	{
-		archive & mem.data_type & mem.data_elements & mem.data_size;
-		archive & mem.data_width & mem.data_height & mem.data_depth & mem.device_pointer;
+		add((int)mem.data_type);
+		add(mem.data_elements);
+		add(mem.data_size);
+		add(mem.data_width);
+		add(mem.data_height);
+		add(mem.data_depth);
+		add(mem.device_pointer);
 	}
 
 	template<typename T> void add(const T& data)
 	{
-		archive & data;
+		const uint8_t *bytes = (const uint8_t*)&data;
+		args.insert(args.end(), bytes, bytes + sizeof(T));
+	}
+
+	void add(const string& data)
+	{
+		add((uint32_t)data.size());
+		args.insert(args.end(), data.begin(), data.end());
 	}
 
 	void add(const DeviceTask& task)
 	{
-		int type = (int)task.type;
-		archive & type & task.x & task.y & task.w & task.h;
-		archive & task.rgba_byte & task.rgba_half & task.buffer & task.sample & task.num_samples;
-		archive & task.offset & task.stride;
-		archive & task.shader_input & task.shader_output & task.shader_eval_type;
-		archive & task.shader_x & task.shader_w;
-		archive & task.need_finish_queue;
+		add((int)task.type);
+		add(task.x); add(task.y); add(task.w); add(task.h);
+		add(task.rgba_byte); add(task.rgba_half); add(task.buffer);
+		add(task.sample); add(task.num_samples);
+		add(task.offset); add(task.stride);
+		add(task.shader_input); add(task.shader_output); add(task.shader_eval_type);
+		add(task.shader_x); add(task.shader_w);
+		add(task.need_finish_queue);
+		add(task.integrator_branched);
 	}
 
 	void add(const RenderTile& tile)
 	{
-		archive & tile.x & tile.y & tile.w & tile.h;
-		archive & tile.start_sample & tile.num_samples & tile.sample;
-		archive & tile.resolution & tile.offset & tile.stride;
-		archive & tile.buffer & tile.rng_state;
+		add(tile.x); add(tile.y); add(tile.w); add(tile.h);
+		add(tile.start_sample); add(tile.num_samples); add(tile.sample);
+		add(tile.resolution); add(tile.offset); add(tile.stride);
+		add(tile.tile_index);
+		add(tile.buffer); add(tile.rng_state);
 	}
 
-	void write()
+	/* send header and arguments, followed by an optional payload that is
+	 * written directly from the given buffer without intermediate copies */
+	void write(const void *payload = NULL, size_t payload_size = 0)
 	{
 		boost::system::error_code error;
 
-		/* get string from stream */
-		string archive_str = archive_stream.str();
+		RPCHeader header;
+		memset(&header, 0, sizeof(header));
+		header.magic = RPC_MAGIC;
+		strncpy(header.name, name.c_str(), RPC_NAME_SIZE - 1);
+		header.args_size = args.size();
+		header.payload_size = payload_size;
+		header.payload_raw_size = payload_size;
+
+		int level = network_compression_level();
+
+		if(level && payload_size >= RPC_COMPRESS_MIN_SIZE) {
+			uLongf compressed_size = compressBound(payload_size);
+			compressed.resize(compressed_size);
+
+			if(compress2(&compressed[0], &compressed_size, (const Bytef*)payload, payload_size, level) == Z_OK &&
+			   compressed_size < payload_size)
+			{
+				header.flags |= RPC_FLAG_PAYLOAD_COMPRESSED;
+				header.payload_size = compressed_size;
+				payload = &compressed[0];
+			}
+		}
 
-		/* first send fixed size header with size of following data */
-		ostringstream header_stream;
-		header_stream << setw(8) << hex << archive_str.size();
-		string header_str = header_stream.str();
+		/* gather header, arguments and payload into a single write */
+		vector<boost::asio::const_buffer> buffers;
+		buffers.push_back(boost::asio::buffer(&header, sizeof(header)));
 
-		boost::asio::write(socket,
-			boost::asio::buffer(header_str),
-			boost::asio::transfer_all(), error);
+		if(args.size())
+			buffers.push_back(boost::asio::buffer(args));
+		if(header.payload_size)
+			buffers.push_back(boost::asio::buffer(payload, header.payload_size));
 
-		if(error.value())
-			error_func->network_error(error.message());
+		boost::asio::write(socket, buffers, boost::asio::transfer_all(), error);
 
-		/* then send actual data */
-		boost::asio::write(socket,
-			boost::asio::buffer(archive_str),
-			boost::asio::transfer_all(), error);
-		
 		if(error.value())
 			error_func->network_error(error.message());
 
 		sent = true;
 	}
 
-	void write_buffer(void *buffer, size_t size)
-	{
-		boost::system::error_code error;
-
-		boost::asio::write(socket,
-			boost::asio::buffer(buffer, size),
-			boost::asio::transfer_all(), error);
-		
-		if(error.value())
-			error_func->network_error(error.message());
-	}
-
 protected:
 	string name;
 	tcp::socket& socket;
-	ostringstream archive_stream;
-	o_archive archive;
+	vector<uint8_t> args;
+	vector<uint8_t> compressed;
 	bool sent;
 	NetworkError *error_func;
 };
@@ -201,109 +252,161 @@ protected:
 class RPCReceive {
 public:
 	RPCReceive(tcp::socket& socket_, NetworkError* e )
-	: socket(socket_), archive_stream(NULL), archive(NULL)
+	: socket(socket_), args_offset(0), payload_size(0), payload_raw_size(0), payload_flags(0)
 	{
 		error_func = e;
-		/* read head with fixed size */
-		vector<char> header(8);
+
+		/* read header with fixed size */
+		RPCHeader header;
 		boost::system::error_code error;
-		size_t len = boost::asio::read(socket, boost::asio::buffer(header), error);
+		size_t len = boost::asio::read(socket, boost::asio::buffer(&header, sizeof(header)), error);
 
 		if(error.value()) {
 			error_func->network_error(error.message());
 		}
 
 		/* verify if we got something */
-		if(len == header.size()) {
-			/* decode header */
-			string header_str(&header[0], header.size());
-			istringstream header_stream(header_str);
-
-			size_t data_size;
-
-			if((header_stream >> hex >> data_size)) {
+		if(len != sizeof(header)) {
+			error_func->network_error("Network receive error: invalid header size");
+			return;
+		}
 
-				vector<char> data(data_size);
-				size_t len = boost::asio::read(socket, boost::asio::buffer(data), error);
+		if(header.magic != RPC_MAGIC) {
+			error_func->network_error("Network receive error: invalid header magic");
+			return;
+		}
 
-				if(error.value())
-					error_func->network_error(error.message());
+		header.name[RPC_NAME_SIZE - 1] = '\0';
+		name = header.name;
 
+		payload_size = header.payload_size;
+		payload_raw_size = header.payload_raw_size;
+		payload_flags = header.flags;
 
-				if(len == data_size) {
-					archive_str = (data.size())? string(&data[0], data.size()): string("");
+		/* read arguments, payload is left on the socket for read_buffer */
+		if(header.args_size) {
+			args.resize(header.args_size);
+			len = boost::asio::read(socket, boost::asio::buffer(args), error);
 
-					archive_stream = new istringstream(archive_str);
-					archive = new i_archive(*archive_stream);
+			if(error.value())
+				error_func->network_error(error.message());
 
-					*archive & name;
-					fprintf(stderr, "rpc receive %s\n", name.c_str());
-				}
-				else {
-					error_func->network_error("Network receive error: data size doesn't match header");
-				}
-			}
-			else {
-				error_func->network_error("Network receive error: can't decode data size from header");
-			}
-		}
-		else {
-			error_func->network_error("Network receive error: invalid header size");
+			if(len != header.args_size)
+				error_func->network_error("Network receive error: data size doesn't match header");
 		}
 	}
 
 	~RPCReceive()
 	{
-		delete archive;
-		delete archive_stream;
 	}
 
 	void read(network_device_memory& mem)
 	{
-		*archive & mem.data_type & mem.data_elements & mem.data_size;
-		*archive & mem.data_width & mem.data_height & mem.data_depth & mem.device_pointer;
+		int data_type;
+
+		read(data_type);
+		read(mem.data_elements);
+		read(mem.data_size);
+		read(mem.data_width);
+		read(mem.data_height);
+		read(mem.data_depth);
+		read(mem.device_pointer);
 
+		mem.data_type = (DataType)data_type;
 		mem.data_pointer = 0;
 	}
 
 	template<typename T> void read(T& data)
 	{
-		*archive & data;
+		if(args_offset + sizeof(T) > args.size()) {
+			error_func->network_error("Network receive error: reading past end of arguments");
+			return;
+		}
+
+		memcpy(&data, &args[args_offset], sizeof(T));
+		args_offset += sizeof(T);
+	}
+
+	void read(string& data)
+	{
+		uint32_t size = 0;
+		read(size);
+
+		if(args_offset + size > args.size()) {
+			error_func->network_error("Network receive error: reading past end of arguments");
+			return;
+		}
+
+		data = string((const char*)&args[0] + args_offset, size);
+		args_offset += size;
+	}
+
+	bool has_payload() const
+	{
+		return payload_raw_size != 0;
 	}
 
+	/* read the payload of this call directly into buffer */
 	void read_buffer(void *buffer, size_t size)
 	{
 		boost::system::error_code error;
-		size_t len = boost::asio::read(socket, boost::asio::buffer(buffer, size), error);
 
-		if(error.value()) {
-			error_func->network_error(error.message());
+		if(size != payload_raw_size) {
+			error_func->network_error("Network receive error: buffer size doesn't match expected size");
+			return;
 		}
 
-		if(len != size)
-			cout << "Network receive error: buffer size doesn't match expected size\n";
+		if(payload_flags & RPC_FLAG_PAYLOAD_COMPRESSED) {
+			vector<uint8_t> compressed(payload_size);
+			size_t len = boost::asio::read(socket, boost::asio::buffer(compressed), error);
+
+			if(error.value())
+				error_func->network_error(error.message());
+
+			uLongf uncompressed_size = size;
+
+			if(len != payload_size ||
+			   uncompress((Bytef*)buffer, &uncompressed_size, &compressed[0], payload_size) != Z_OK ||
+			   uncompressed_size != size)
+			{
+				error_func->network_error("Network receive error: failed to decompress payload");
+			}
+		}
+		else {
+			size_t len = boost::asio::read(socket, boost::asio::buffer(buffer, size), error);
+
+			if(error.value())
+				error_func->network_error(error.message());
+
+			if(len != size)
+				error_func->network_error("Network receive error: buffer size doesn't match expected size");
+		}
 	}
 
 	void read(DeviceTask& task)
 	{
 		int type;
 
-		*archive & type & task.x & task.y & task.w & task.h;
-		*archive & task.rgba_byte & task.rgba_half & task.buffer & task.sample & task.num_samples;
-		*archive & task.offset & task.stride;
-		*archive & task.shader_input & task.shader_output & task.shader_eval_type;
-		*archive & task.shader_x & task.shader_w;
-		*archive & task.need_finish_queue;
+		read(type);
+		read(task.x); read(task.y); read(task.w); read(task.h);
+		read(task.rgba_byte); read(task.rgba_half); read(task.buffer);
+		read(task.sample); read(task.num_samples);
+		read(task.offset); read(task.stride);
+		read(task.shader_input); read(task.shader_output); read(task.shader_eval_type);
+		read(task.shader_x); read(task.shader_w);
+		read(task.need_finish_queue);
+		read(task.integrator_branched);
 
 		task.type = (DeviceTask::Type)type;
 	}
 
 	void read(RenderTile& tile)
 	{
-		*archive & tile.x & tile.y & tile.w & tile.h;
-		*archive & tile.start_sample & tile.num_samples & tile.sample;
-		*archive & tile.resolution & tile.offset & tile.stride;
-		*archive & tile.buffer & tile.rng_state;
+		read(tile.x); read(tile.y); read(tile.w); read(tile.h);
+		read(tile.start_sample); read(tile.num_samples); read(tile.sample);
+		read(tile.resolution); read(tile.offset); read(tile.stride);
+		read(tile.tile_index);
+		read(tile.buffer); read(tile.rng_state);
 
 		tile.buffers = NULL;
 	}
@@ -312,9 +415,11 @@ public:
 
 protected:
 	tcp::socket& socket;
-	string archive_str;
-	istringstream *archive_stream;
-	i_archive *archive;
+	vector<uint8_t> args;
+	size_t args_offset;
+	size_t payload_size;
+	size_t payload_raw_size;
+	uint32_t payload_flags;
 	NetworkError *error_func;
 };
 
@@ -35,6 +35,49 @@ CCL_NAMESPACE_BEGIN
 #define BVH_HAIR				4
 #define BVH_HAIR_MINIMUM_WIDTH	8
 
+/* Unaligned BVH nodes
+ *
+ * Nodes with only curve segments below both children may store an oriented
+ * box for each child instead of an axis aligned one, as the transform from
+ * object space to the unit box of the child. Such nodes are flagged with
+ * BVH_NODE_UNALIGNED and take up two node slots, the second one holding the
+ * space of the second child. They are only built for devices with hair
+ * support, and only the BVH_HAIR traversal variants test for them. */
+
+ccl_device_inline float2 bvh_unaligned_node_child_intersect(KernelGlobals *kg, float3 P, float3 dir, float t, int offset)
+{
+	float4 space_x = kernel_tex_fetch(__bvh_nodes, offset+0);
+	float4 space_y = kernel_tex_fetch(__bvh_nodes, offset+1);
+	float4 space_z = kernel_tex_fetch(__bvh_nodes, offset+2);
+
+	/* the space is affine, so distances along the ray stay the same */
+	float3 aligned_P = make_float3(dot(P, float4_to_float3(space_x)) + space_x.w,
+	                               dot(P, float4_to_float3(space_y)) + space_y.w,
+	                               dot(P, float4_to_float3(space_z)) + space_z.w);
+	float3 aligned_dir = make_float3(dot(dir, float4_to_float3(space_x)),
+	                                 dot(dir, float4_to_float3(space_y)),
+	                                 dot(dir, float4_to_float3(space_z)));
+
+	/* slabs of the unit box */
+	float3 nrdir = -bvh_inverse_direction(bvh_clamp_direction(aligned_dir));
+	float3 lower = aligned_P * nrdir;
+	float3 upper = lower - nrdir;
+
+	float3 tnear = min(lower, upper);
+	float3 tfar = max(lower, upper);
+
+	return make_float2(max4(tnear.x, tnear.y, tnear.z, 0.0f), min4(tfar.x, tfar.y, tfar.z, t));
+}
+
+/* returns { c0min, c1min, c0max, c1max }, the same layout as the SSE node test */
+ccl_device_inline float4 bvh_unaligned_node_intersect(KernelGlobals *kg, float3 P, float3 dir, float t, int nodeAddr)
+{
+	float2 t0 = bvh_unaligned_node_child_intersect(kg, P, dir, t, nodeAddr*BVH_NODE_SIZE);
+	float2 t1 = bvh_unaligned_node_child_intersect(kg, P, dir, t, (nodeAddr+1)*BVH_NODE_SIZE);
+
+	return make_float4(t0.x, t1.x, t0.y, t1.y);
+}
+
 #define BVH_FUNCTION_NAME bvh_intersect
 #define BVH_FUNCTION_FEATURES 0
 #include "geom_bvh_traversal.h"
@@ -123,6 +166,231 @@ CCL_NAMESPACE_BEGIN
 #include "geom_bvh_shadow.h"
 #endif
 
+/* BVH packet traversal for coherent rays, only in SSE4.1 and AVX CPU kernels */
+
+#ifdef __RAY_PACKETS__
+
+ccl_device_inline bool bvh_packet_single(int mask)
+{
+	return mask && !(mask & (mask - 1));
+}
+
+ccl_device_inline int bvh_packet_first(int mask)
+{
+	int i = 0;
+
+	while(!(mask & (1 << i)))
+		i++;
+
+	return i;
+}
+
+ccl_device_inline uint bvh_packet_hits(const Intersection *isects, int num)
+{
+	uint hits = 0;
+
+	for(int i = 0; i < num; i++)
+		if(isects[i].prim != PRIM_NONE)
+			hits |= (1 << i);
+
+	return hits;
+}
+
+/* rays with the same direction signs visit nodes in a similar order */
+ccl_device_inline bool bvh_packet_coherent(const float3 *dir, int active)
+{
+	int octant = -1;
+
+	for(int i = 0; i < RAY_PACKET_SIZE; i++) {
+		if(!(active & (1 << i)))
+			continue;
+
+		int ray_octant = ((dir[i].x < 0.0f)? 1: 0) | ((dir[i].y < 0.0f)? 2: 0) | ((dir[i].z < 0.0f)? 4: 0);
+
+		if(octant == -1)
+			octant = ray_octant;
+		else if(octant != ray_octant)
+			return false;
+	}
+
+	return true;
+}
+
+/* load rays in SSE layout, inactive rays get a negative distance so they never hit */
+ccl_device_inline void bvh_packet_load(const float3 *P, const float3 *dir, const float3 *idir,
+	const Intersection *isects, int active, __m128 *Psoa, __m128 *Dsoa, __m128 *idirsoa, __m128 *tsoa)
+{
+	Psoa[0] = _mm_set_ps(P[3].x, P[2].x, P[1].x, P[0].x);
+	Psoa[1] = _mm_set_ps(P[3].y, P[2].y, P[1].y, P[0].y);
+	Psoa[2] = _mm_set_ps(P[3].z, P[2].z, P[1].z, P[0].z);
+
+	Dsoa[0] = _mm_set_ps(dir[3].x, dir[2].x, dir[1].x, dir[0].x);
+	Dsoa[1] = _mm_set_ps(dir[3].y, dir[2].y, dir[1].y, dir[0].y);
+	Dsoa[2] = _mm_set_ps(dir[3].z, dir[2].z, dir[1].z, dir[0].z);
+
+	idirsoa[0] = _mm_set_ps(idir[3].x, idir[2].x, idir[1].x, idir[0].x);
+	idirsoa[1] = _mm_set_ps(idir[3].y, idir[2].y, idir[1].y, idir[0].y);
+	idirsoa[2] = _mm_set_ps(idir[3].z, idir[2].z, idir[1].z, idir[0].z);
+
+	union { __m128 m128; float v[4]; } ut;
+
+	for(int i = 0; i < RAY_PACKET_SIZE; i++)
+		ut.v[i] = (active & (1 << i))? isects[i].t: -1.0f;
+
+	*tsoa = ut.m128;
+}
+
+#ifdef __KERNEL_AVX__
+
+/* intersect all rays with both child bounding boxes of a node at once, stored
+ * as {c0.min, c1.min, c0.max, c1.max} for x, y and z. The first child is in
+ * the lower four lanes, the second child in the upper four. */
+ccl_device_inline void bvh_packet_node_intersect(const float4 *node,
+	const __m128 *P, const __m128 *idir, const __m128& tfar,
+	__m128 *tnear0, __m128 *tnear1, int *mask0, int *mask1)
+{
+	const float *bounds = (const float*)node;
+	__m256 tmin = _mm256_setzero_ps();
+	__m256 tmax = m256_splat2(tfar);
+
+	for(int axis = 0; axis < 3; axis++) {
+		const __m256 lo = m256_combine(_mm_set1_ps(bounds[axis*4+0]), _mm_set1_ps(bounds[axis*4+1]));
+		const __m256 hi = m256_combine(_mm_set1_ps(bounds[axis*4+2]), _mm_set1_ps(bounds[axis*4+3]));
+		const __m256 idir8 = m256_splat2(idir[axis]);
+		const __m256 Pidir8 = _mm256_mul_ps(m256_splat2(P[axis]), idir8);
+
+		/* (bound - P)*idir, as a single fused operation with AVX2 */
+		const __m256 t0 = fms(lo, idir8, Pidir8);
+		const __m256 t1 = fms(hi, idir8, Pidir8);
+
+		tmin = _mm256_max_ps(tmin, _mm256_min_ps(t0, t1));
+		tmax = _mm256_min_ps(tmax, _mm256_max_ps(t0, t1));
+	}
+
+	int hit = _mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ));
+
+	*tnear0 = m256_lo(tmin);
+	*tnear1 = m256_hi(tmin);
+	*mask0 = hit & 0xf;
+	*mask1 = hit >> 4;
+}
+
+#else
+
+/* intersect all rays with one child bounding box of a node, stored as
+ * {c0.min, c1.min, c0.max, c1.max} for x, y and z */
+ccl_device_inline int bvh_packet_child_intersect(const float *bounds, int child,
+	const __m128 *P, const __m128 *idir, const __m128& tfar, __m128 *tnear)
+{
+	const __m128 lox = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds[child]), P[0]), idir[0]);
+	const __m128 hix = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds[child+2]), P[0]), idir[0]);
+	const __m128 loy = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds[4+child]), P[1]), idir[1]);
+	const __m128 hiy = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds[4+child+2]), P[1]), idir[1]);
+	const __m128 loz = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds[8+child]), P[2]), idir[2]);
+	const __m128 hiz = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds[8+child+2]), P[2]), idir[2]);
+
+	const __m128 tmin = _mm_max_ps(_mm_max_ps(_mm_min_ps(lox, hix), _mm_min_ps(loy, hiy)),
+	                               _mm_max_ps(_mm_min_ps(loz, hiz), _mm_setzero_ps()));
+	const __m128 tmax = _mm_min_ps(_mm_min_ps(_mm_max_ps(lox, hix), _mm_max_ps(loy, hiy)),
+	                               _mm_min_ps(_mm_max_ps(loz, hiz), tfar));
+
+	*tnear = tmin;
+
+	return _mm_movemask_ps(_mm_cmple_ps(tmin, tmax));
+}
+
+ccl_device_inline void bvh_packet_node_intersect(const float4 *node,
+	const __m128 *P, const __m128 *idir, const __m128& tfar,
+	__m128 *tnear0, __m128 *tnear1, int *mask0, int *mask1)
+{
+	const float *bounds = (const float*)node;
+
+	*mask0 = bvh_packet_child_intersect(bounds, 0, P, idir, tfar, tnear0);
+	*mask1 = bvh_packet_child_intersect(bounds, 1, P, idir, tfar, tnear1);
+}
+
+#endif
+
+ccl_device_inline __m128 bvh_packet_dot(const __m128 *a, const float4& b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], _mm_set1_ps(b.x)), _mm_mul_ps(a[1], _mm_set1_ps(b.y))),
+	                  _mm_mul_ps(a[2], _mm_set1_ps(b.z)));
+}
+
+/* same as triangle_intersect, for all rays in mask at once */
+ccl_device_inline int bvh_packet_triangle_intersect(KernelGlobals *kg, Intersection *isects,
+	const __m128 *P, const __m128 *dir, __m128 *tfar, int mask, uint visibility, int object, int triAddr)
+{
+	float4 v00 = kernel_tex_fetch(__tri_woop, triAddr*TRI_NODE_SIZE+0);
+	float4 v11 = kernel_tex_fetch(__tri_woop, triAddr*TRI_NODE_SIZE+1);
+	float4 v22 = kernel_tex_fetch(__tri_woop, triAddr*TRI_NODE_SIZE+2);
+
+	/* compute and check intersection t-value */
+	const __m128 Oz = _mm_sub_ps(_mm_set1_ps(v00.w), bvh_packet_dot(P, v00));
+	const __m128 invDz = _mm_div_ps(_mm_set1_ps(1.0f), bvh_packet_dot(dir, v00));
+	const __m128 t = _mm_mul_ps(Oz, invDz);
+
+	__m128 valid = _mm_and_ps(_mm_cmpgt_ps(t, _mm_setzero_ps()), _mm_cmplt_ps(t, *tfar));
+
+	/* compute and check barycentric u and v */
+	const __m128 Ox = _mm_add_ps(_mm_set1_ps(v11.w), bvh_packet_dot(P, v11));
+	const __m128 u = _mm_add_ps(Ox, _mm_mul_ps(t, bvh_packet_dot(dir, v11)));
+	const __m128 Oy = _mm_add_ps(_mm_set1_ps(v22.w), bvh_packet_dot(P, v22));
+	const __m128 v = _mm_add_ps(Oy, _mm_mul_ps(t, bvh_packet_dot(dir, v22)));
+
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(u, _mm_setzero_ps()));
+	valid = _mm_and_ps(valid, _mm_cmpge_ps(v, _mm_setzero_ps()));
+	valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+
+	int hitMask = _mm_movemask_ps(valid) & mask;
+
+	if(!hitMask)
+		return 0;
+
+#ifdef __VISIBILITY_FLAG__
+	if(!(kernel_tex_fetch(__prim_visibility, triAddr) & visibility))
+		return 0;
+#endif
+
+	/* record intersections */
+	union { __m128 m128; float v[4]; } ut, uu, uv, utfar;
+
+	ut.m128 = t;
+	uu.m128 = u;
+	uv.m128 = v;
+	utfar.m128 = *tfar;
+
+	for(int i = 0; i < RAY_PACKET_SIZE; i++) {
+		if(hitMask & (1 << i)) {
+			isects[i].prim = triAddr;
+			isects[i].object = object;
+			isects[i].type = PRIMITIVE_TRIANGLE;
+			isects[i].u = uu.v[i];
+			isects[i].v = uv.v[i];
+			isects[i].t = ut.v[i];
+			utfar.v[i] = ut.v[i];
+		}
+	}
+
+	*tfar = utfar.m128;
+
+	return hitMask;
+}
+
+#define BVH_FUNCTION_NAME bvh_intersect_packet
+#define BVH_SUBTREE_FUNCTION_NAME bvh_intersect_packet_subtree
+#define BVH_FUNCTION_FEATURES 0
+#include "geom_bvh_packet.h"
+
+#if defined(__INSTANCING__)
+#define BVH_FUNCTION_NAME bvh_intersect_packet_instancing
+#define BVH_SUBTREE_FUNCTION_NAME bvh_intersect_packet_subtree_instancing
+#define BVH_FUNCTION_FEATURES BVH_INSTANCING
+#include "geom_bvh_packet.h"
+#endif
+
+#endif /* __RAY_PACKETS__ */
+
 /* to work around titan bug when using arrays instead of textures */
 #if !defined(__KERNEL_CUDA__) || defined(__KERNEL_CUDA_TEX_STORAGE__)
 ccl_device_inline
@@ -135,6 +403,9 @@ bool scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, I
 bool scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, Intersection *isect)
 #endif
 {
+	PROFILING_SCOPE(kg, (visibility & PATH_RAY_SHADOW)? PROFILING_SHADOW_RAY: PROFILING_INTERSECT);
+	PROFILING_RAY(kg, (visibility & PATH_RAY_SHADOW)? PROFILING_RAY_SHADOW: PROFILING_RAY_INTERSECT);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -179,6 +450,9 @@ ccl_device_noinline
 #endif
 uint scene_intersect_subsurface(KernelGlobals *kg, const Ray *ray, Intersection *isect, int subsurface_object, uint *lcg_state, int max_hits)
 {
+	PROFILING_SCOPE(kg, PROFILING_INTERSECT);
+	PROFILING_RAY(kg, PROFILING_RAY_SUBSURFACE);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -224,6 +498,9 @@ ccl_device_noinline
 #endif
 uint scene_intersect_shadow_all(KernelGlobals *kg, const Ray *ray, Intersection *isect, uint max_hits, uint *num_hits)
 {
+	PROFILING_SCOPE(kg, PROFILING_SHADOW_RAY);
+	PROFILING_RAY(kg, PROFILING_RAY_SHADOW);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -260,6 +537,62 @@ uint scene_intersect_shadow_all(KernelGlobals *kg, const Ray *ray, Intersection
 }
 #endif
 
+#ifdef __RAY_PACKETS__
+/* packets only support triangles, hair and motion blur need single rays */
+ccl_device_inline bool scene_intersect_packet_supported(KernelGlobals *kg)
+{
+#ifdef __OBJECT_MOTION__
+	if(kernel_data.bvh.have_motion)
+		return false;
+#endif
+#ifdef __HAIR__
+	if(kernel_data.bvh.have_curves)
+		return false;
+#endif
+
+	return true;
+}
+
+/* Intersect up to RAY_PACKET_SIZE coherent rays, returns a mask of the rays
+ * that hit something. Rays with zero length are skipped. */
+
+ccl_device_inline uint scene_intersect_packet(KernelGlobals *kg, const Ray *rays, const uint visibility, Intersection *isects, int num)
+{
+	PROFILING_SCOPE(kg, (visibility & PATH_RAY_SHADOW)? PROFILING_SHADOW_RAY: PROFILING_INTERSECT);
+
+	if(!scene_intersect_packet_supported(kg)) {
+		uint hits = 0;
+
+		for(int i = 0; i < num; i++) {
+			if(rays[i].t == 0.0f) {
+				isects[i].t = 0.0f;
+				isects[i].prim = PRIM_NONE;
+				isects[i].object = OBJECT_NONE;
+				continue;
+			}
+
+#ifdef __HAIR__
+			if(scene_intersect(kg, &rays[i], visibility, &isects[i], NULL, 0.0f, 0.0f))
+#else
+			if(scene_intersect(kg, &rays[i], visibility, &isects[i]))
+#endif
+				hits |= (1 << i);
+		}
+
+		return hits;
+	}
+
+	for(int i = 0; i < num; i++)
+		PROFILING_RAY(kg, (visibility & PATH_RAY_SHADOW)? PROFILING_RAY_SHADOW: PROFILING_RAY_INTERSECT);
+
+#ifdef __INSTANCING__
+	if(kernel_data.bvh.have_instancing)
+		return bvh_intersect_packet_instancing(kg, rays, isects, num, visibility);
+#endif /* __INSTANCING__ */
+
+	return bvh_intersect_packet(kg, rays, isects, num, visibility);
+}
+#endif /* __RAY_PACKETS__ */
 
 /* Ray offset to avoid self intersection.
  *
@@ -0,0 +1,466 @@
+/*
+ * Adapted from code Copyright 2009-2010 NVIDIA Corporation,
+ * and code copyright 2009-2012 Intel Corporation
+ *
+ * Modifications Copyright 2011-2014, Blender Foundation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* This is a template BVH packet traversal function for coherent rays, like
+ * camera rays of neighbouring pixels or ambient occlusion rays leaving from
+ * the same point. Up to RAY_PACKET_SIZE rays are traversed together, testing
+ * each node against all rays with SSE. Every stack entry stores the rays that
+ * entered the node, so once a subtree is only visited by a single ray, that
+ * ray continues with regular single ray traversal.
+ *
+ * Only triangles are supported, hair and motion blur use single rays.
+ *
+ * BVH_INSTANCING: object instancing
+ *
+ */
+
+#define FEATURE(f) (((BVH_FUNCTION_FEATURES) & (f)) != 0)
+
+/* Single ray traversal of a subtree, starting at nodeAddr with the ray
+ * already transformed into the space of the given object. */
+
+ccl_device bool BVH_SUBTREE_FUNCTION_NAME(KernelGlobals *kg, const Ray *ray, int nodeAddr, int object,
+	float3 P, float3 dir, float3 idir, Intersection *isect, const uint visibility)
+{
+	/* traversal stack */
+	int traversalStack[BVH_STACK_SIZE];
+	traversalStack[0] = ENTRYPOINT_SENTINEL;
+
+	int stackPtr = 0;
+	bool hit_any = false;
+
+	const shuffle_swap_t shuf_identity = shuffle_swap_identity();
+	const shuffle_swap_t shuf_swap = shuffle_swap_swap();
+
+	const __m128 pn = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0x80000000, 0, 0));
+	__m128 Psplat[3], idirsplat[3];
+#if defined(__KERNEL_AVX2__)
+	__m128 Pidirsplat[3];
+#endif
+	shuffle_swap_t shufflexyz[3];
+
+	Psplat[0] = _mm_set_ps1(P.x);
+	Psplat[1] = _mm_set_ps1(P.y);
+	Psplat[2] = _mm_set_ps1(P.z);
+
+	__m128 tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
+
+	gen_idirsplat_swap(pn, shuf_identity, shuf_swap, idir, idirsplat, shufflexyz);
+#if defined(__KERNEL_AVX2__)
+	Pidirsplat[0] = _mm_mul_ps(Psplat[0], idirsplat[0]);
+	Pidirsplat[1] = _mm_mul_ps(Psplat[1], idirsplat[1]);
+	Pidirsplat[2] = _mm_mul_ps(Psplat[2], idirsplat[2]);
+#endif
+
+	/* traversal loop */
+	do {
+		do {
+			/* traverse internal nodes */
+			while(nodeAddr >= 0 && nodeAddr != ENTRYPOINT_SENTINEL) {
+				bool traverseChild0, traverseChild1;
+				int nodeAddrChild1;
+
+				/* fetch node data */
+				const __m128 *bvh_nodes = (__m128*)kg->__bvh_nodes.data + nodeAddr*BVH_NODE_SIZE;
+				const float4 cnodes = ((float4*)bvh_nodes)[3];
+
+				/* intersect ray against child nodes */
+#if defined(__KERNEL_AVX2__)
+				/* (node - P)*idir as node*idir - P*idir, in a single fused operation */
+				const __m128 tminmaxx = fms(shuffle_swap(bvh_nodes[0], shufflexyz[0]), idirsplat[0], Pidirsplat[0]);
+				const __m128 tminmaxy = fms(shuffle_swap(bvh_nodes[1], shufflexyz[1]), idirsplat[1], Pidirsplat[1]);
+				const __m128 tminmaxz = fms(shuffle_swap(bvh_nodes[2], shufflexyz[2]), idirsplat[2], Pidirsplat[2]);
+#else
+				const __m128 tminmaxx = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[0], shufflexyz[0]), Psplat[0]), idirsplat[0]);
+				const __m128 tminmaxy = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[1], shufflexyz[1]), Psplat[1]), idirsplat[1]);
+				const __m128 tminmaxz = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[2], shufflexyz[2]), Psplat[2]), idirsplat[2]);
+#endif
+
+				/* calculate { c0min, c1min, -c0max, -c1max} */
+				__m128 minmax = _mm_max_ps(_mm_max_ps(tminmaxx, tminmaxy), _mm_max_ps(tminmaxz, tsplat));
+				const __m128 tminmax = _mm_xor_ps(minmax, pn);
+				const __m128 lrhit = _mm_cmple_ps(tminmax, shuffle<2, 3, 0, 1>(tminmax));
+
+				/* decide which nodes to traverse next */
+#ifdef __VISIBILITY_FLAG__
+				traverseChild0 = (_mm_movemask_ps(lrhit) & 1) && (__float_as_uint(cnodes.z) & visibility);
+				traverseChild1 = (_mm_movemask_ps(lrhit) & 2) && (__float_as_uint(cnodes.w) & visibility);
+#else
+				traverseChild0 = (_mm_movemask_ps(lrhit) & 1);
+				traverseChild1 = (_mm_movemask_ps(lrhit) & 2);
+#endif
+
+				nodeAddr = __float_as_int(cnodes.x);
+				nodeAddrChild1 = __float_as_int(cnodes.y);
+
+				if(traverseChild0 && traverseChild1) {
+					/* both children were intersected, push the farther one */
+					union { __m128 m128; float v[4]; } uminmax;
+					uminmax.m128 = tminmax;
+
+					if(uminmax.v[1] < uminmax.v[0]) {
+						int tmp = nodeAddr;
+						nodeAddr = nodeAddrChild1;
+						nodeAddrChild1 = tmp;
+					}
+
+					++stackPtr;
+					traversalStack[stackPtr] = nodeAddrChild1;
+				}
+				else {
+					/* one child was intersected */
+					if(traverseChild1) {
+						nodeAddr = nodeAddrChild1;
+					}
+					else if(!traverseChild0) {
+						/* neither child was intersected */
+						nodeAddr = traversalStack[stackPtr];
+						--stackPtr;
+					}
+				}
+			}
+
+			/* if node is leaf, fetch triangle list */
+			if(nodeAddr < 0) {
+				float4 leaf = kernel_tex_fetch(__bvh_nodes, (-nodeAddr-1)*BVH_NODE_SIZE+(BVH_NODE_SIZE-1));
+				int primAddr = __float_as_int(leaf.x);
+
+#if FEATURE(BVH_INSTANCING)
+				if(primAddr >= 0) {
+#endif
+					int primAddr2 = __float_as_int(leaf.y);
+
+					/* pop */
+					nodeAddr = traversalStack[stackPtr];
+					--stackPtr;
+
+					/* primitive intersection */
+					while(primAddr < primAddr2) {
+						uint type = kernel_tex_fetch(__prim_type, primAddr);
+
+						if((type & PRIMITIVE_ALL) == PRIMITIVE_TRIANGLE &&
+						   triangle_intersect(kg, isect, P, dir, visibility, object, primAddr))
+						{
+							/* shadow ray early termination */
+							if(visibility == PATH_RAY_SHADOW_OPAQUE)
+								return true;
+
+							hit_any = true;
+							tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
+						}
+
+						primAddr++;
+					}
+				}
+#if FEATURE(BVH_INSTANCING)
+				else {
+					/* instance push */
+					object = kernel_tex_fetch(__prim_object, -primAddr-1);
+					bvh_instance_push(kg, object, ray, &P, &dir, &idir, &isect->t);
+
+					Psplat[0] = _mm_set_ps1(P.x);
+					Psplat[1] = _mm_set_ps1(P.y);
+					Psplat[2] = _mm_set_ps1(P.z);
+
+					tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
+
+					gen_idirsplat_swap(pn, shuf_identity, shuf_swap, idir, idirsplat, shufflexyz);
+#if defined(__KERNEL_AVX2__)
+					Pidirsplat[0] = _mm_mul_ps(Psplat[0], idirsplat[0]);
+					Pidirsplat[1] = _mm_mul_ps(Psplat[1], idirsplat[1]);
+					Pidirsplat[2] = _mm_mul_ps(Psplat[2], idirsplat[2]);
+#endif
+
+					++stackPtr;
+					traversalStack[stackPtr] = ENTRYPOINT_SENTINEL;
+
+					nodeAddr = kernel_tex_fetch(__object_node, object);
+				}
+			}
+#endif
+		} while(nodeAddr != ENTRYPOINT_SENTINEL);
+
+#if FEATURE(BVH_INSTANCING)
+		if(stackPtr >= 0) {
+			kernel_assert(object != OBJECT_NONE);
+
+			/* instance pop */
+			bvh_instance_pop(kg, object, ray, &P, &dir, &idir, &isect->t);
+
+			Psplat[0] = _mm_set_ps1(P.x);
+			Psplat[1] = _mm_set_ps1(P.y);
+			Psplat[2] = _mm_set_ps1(P.z);
+
+			tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
+
+			gen_idirsplat_swap(pn, shuf_identity, shuf_swap, idir, idirsplat, shufflexyz);
+#if defined(__KERNEL_AVX2__)
+			Pidirsplat[0] = _mm_mul_ps(Psplat[0], idirsplat[0]);
+			Pidirsplat[1] = _mm_mul_ps(Psplat[1], idirsplat[1]);
+			Pidirsplat[2] = _mm_mul_ps(Psplat[2], idirsplat[2]);
+#endif
+
+			object = OBJECT_NONE;
+			nodeAddr = traversalStack[stackPtr];
+			--stackPtr;
+		}
+#endif
+	} while(nodeAddr != ENTRYPOINT_SENTINEL);
+
+	return hit_any;
+}
+
+/* Packet traversal, returns a mask of the rays that hit something */
+
+ccl_device uint BVH_FUNCTION_NAME(KernelGlobals *kg, const Ray *rays, Intersection *isects, int num, const uint visibility)
+{
+	/* traversal stack, with the rays that entered each node */
+	int traversalStack[BVH_STACK_SIZE];
+	int traversalMask[BVH_STACK_SIZE];
+	traversalStack[0] = ENTRYPOINT_SENTINEL;
+	traversalMask[0] = 0;
+
+	/* traversal variables */
+	int stackPtr = 0;
+	int nodeAddr = kernel_data.bvh.root;
+	int object = OBJECT_NONE;
+
+	/* ray parameters, per ray and in SSE layout */
+	float3 P[RAY_PACKET_SIZE], dir[RAY_PACKET_SIZE], idir[RAY_PACKET_SIZE];
+	__m128 Psoa[3], Dsoa[3], idirsoa[3], tsoa;
+	int active = 0;
+
+	for(int i = 0; i < RAY_PACKET_SIZE; i++) {
+		/* pad unused rays with the first one, they are never active */
+		const Ray *ray = &rays[(i < num)? i: 0];
+
+		P[i] = ray->P;
+		dir[i] = bvh_clamp_direction(ray->D);
+		idir[i] = bvh_inverse_direction(dir[i]);
+
+		if(i < num) {
+			isects[i].t = ray->t;
+			isects[i].object = OBJECT_NONE;
+			isects[i].prim = PRIM_NONE;
+			isects[i].u = 0.0f;
+			isects[i].v = 0.0f;
+
+			if(ray->t > 0.0f)
+				active |= (1 << i);
+		}
+	}
+
+	if(!active)
+		return 0;
+
+	/* rays in different octants diverge right away, trace them one by one */
+	if(!bvh_packet_coherent(dir, active)) {
+		for(int i = 0; i < num; i++)
+			if(active & (1 << i))
+				BVH_SUBTREE_FUNCTION_NAME(kg, &rays[i], nodeAddr, OBJECT_NONE, P[i], dir[i], idir[i], &isects[i], visibility);
+
+		return bvh_packet_hits(isects, num);
+	}
+
+	bvh_packet_load(P, dir, idir, isects, active, Psoa, Dsoa, idirsoa, &tsoa);
+
+	int mask = active;
+
+	/* traversal loop */
+	do {
+		do {
+			/* traverse internal nodes */
+			while(nodeAddr >= 0 && nodeAddr != ENTRYPOINT_SENTINEL) {
+				if(bvh_packet_single(mask)) {
+					/* only a single ray left in this subtree, continue without packet */
+					int i = bvh_packet_first(mask);
+
+					bool hit = BVH_SUBTREE_FUNCTION_NAME(kg, &rays[i], nodeAddr, object,
+						P[i], dir[i], idir[i], &isects[i], visibility);
+
+					if(hit && visibility == PATH_RAY_SHADOW_OPAQUE) {
+						active &= ~(1 << i);
+
+						if(!active)
+							return bvh_packet_hits(isects, num);
+					}
+
+					bvh_packet_load(P, dir, idir, isects, active, Psoa, Dsoa, idirsoa, &tsoa);
+
+					/* pop */
+					nodeAddr = traversalStack[stackPtr];
+					mask = traversalMask[stackPtr] & active;
+					--stackPtr;
+					continue;
+				}
+
+				/* intersect all rays with both child bounding boxes */
+				const float4 *bvh_nodes = (float4*)kg->__bvh_nodes.data + nodeAddr*BVH_NODE_SIZE;
+				const float4 cnodes = bvh_nodes[3];
+				__m128 tnear0, tnear1;
+				int mask0, mask1;
+
+				bvh_packet_node_intersect(bvh_nodes, Psoa, idirsoa, tsoa, &tnear0, &tnear1, &mask0, &mask1);
+
+				mask0 &= mask;
+				mask1 &= mask;
+
+#ifdef __VISIBILITY_FLAG__
+				if(!(__float_as_uint(cnodes.z) & visibility))
+					mask0 = 0;
+				if(!(__float_as_uint(cnodes.w) & visibility))
+					mask1 = 0;
+#endif
+
+				/* decide which nodes to traverse next */
+				int nodeAddrChild0 = __float_as_int(cnodes.x);
+				int nodeAddrChild1 = __float_as_int(cnodes.y);
+
+				if(mask0 && mask1) {
+					/* both children were intersected, push the farther one, as seen
+					 * by the first ray that enters both */
+					int both = mask0 & mask1;
+					bool closestChild1 = false;
+
+					if(both) {
+						union { __m128 m128; float v[4]; } unear0, unear1;
+						int i = bvh_packet_first(both);
+
+						unear0.m128 = tnear0;
+						unear1.m128 = tnear1;
+						closestChild1 = unear1.v[i] < unear0.v[i];
+					}
+
+					++stackPtr;
+
+					if(closestChild1) {
+						nodeAddr = nodeAddrChild1;
+						mask = mask1;
+						traversalStack[stackPtr] = nodeAddrChild0;
+						traversalMask[stackPtr] = mask0;
+					}
+					else {
+						nodeAddr = nodeAddrChild0;
+						mask = mask0;
+						traversalStack[stackPtr] = nodeAddrChild1;
+						traversalMask[stackPtr] = mask1;
+					}
+				}
+				else if(mask0) {
+					nodeAddr = nodeAddrChild0;
+					mask = mask0;
+				}
+				else if(mask1) {
+					nodeAddr = nodeAddrChild1;
+					mask = mask1;
+				}
+				else {
+					/* neither child was intersected */
+					nodeAddr = traversalStack[stackPtr];
+					mask = traversalMask[stackPtr] & active;
+					--stackPtr;
+				}
+			}
+
+			/* if node is leaf, fetch triangle list */
+			if(nodeAddr < 0) {
+				float4 leaf = kernel_tex_fetch(__bvh_nodes, (-nodeAddr-1)*BVH_NODE_SIZE+(BVH_NODE_SIZE-1));
+				int primAddr = __float_as_int(leaf.x);
+
+#if FEATURE(BVH_INSTANCING)
+				if(primAddr >= 0) {
+#endif
+					int primAddr2 = __float_as_int(leaf.y);
+					int leafMask = mask;
+
+					/* pop */
+					nodeAddr = traversalStack[stackPtr];
+					mask = traversalMask[stackPtr] & active;
+					--stackPtr;
+
+					/* primitive intersection */
+					while(primAddr < primAddr2 && leafMask) {
+						uint type = kernel_tex_fetch(__prim_type, primAddr);
+
+						if((type & PRIMITIVE_ALL) == PRIMITIVE_TRIANGLE) {
+							int hitMask = bvh_packet_triangle_intersect(kg, isects, Psoa, Dsoa, &tsoa,
+								leafMask, visibility, object, primAddr);
+
+							/* shadow ray early termination */
+							if(hitMask && visibility == PATH_RAY_SHADOW_OPAQUE) {
+								active &= ~hitMask;
+								leafMask &= ~hitMask;
+								mask &= ~hitMask;
+
+								if(!active)
+									return bvh_packet_hits(isects, num);
+							}
+						}
+
+						primAddr++;
+					}
+				}
+#if FEATURE(BVH_INSTANCING)
+				else {
+					/* instance push, all active rays move into object space */
+					object = kernel_tex_fetch(__prim_object, -primAddr-1);
+
+					for(int i = 0; i < num; i++)
+						if(active & (1 << i))
+							bvh_instance_push(kg, object, &rays[i], &P[i], &dir[i], &idir[i], &isects[i].t);
+
+					bvh_packet_load(P, dir, idir, isects, active, Psoa, Dsoa, idirsoa, &tsoa);
+
+					++stackPtr;
+					traversalStack[stackPtr] = ENTRYPOINT_SENTINEL;
+					traversalMask[stackPtr] = 0;
+
+					nodeAddr = kernel_tex_fetch(__object_node, object);
+				}
+			}
+#endif
+		} while(nodeAddr != ENTRYPOINT_SENTINEL);
+
+#if FEATURE(BVH_INSTANCING)
+		if(stackPtr >= 0) {
+			kernel_assert(object != OBJECT_NONE);
+
+			/* instance pop */
+			for(int i = 0; i < num; i++)
+				if(active & (1 << i))
+					bvh_instance_pop(kg, object, &rays[i], &P[i], &dir[i], &idir[i], &isects[i].t);
+
+			bvh_packet_load(P, dir, idir, isects, active, Psoa, Dsoa, idirsoa, &tsoa);
+
+			object = OBJECT_NONE;
+			nodeAddr = traversalStack[stackPtr];
+			mask = traversalMask[stackPtr] & active;
+			--stackPtr;
+		}
+#endif
+	} while(nodeAddr != ENTRYPOINT_SENTINEL);
+
+	return bvh_packet_hits(isects, num);
+}
+
+#undef FEATURE
+#undef BVH_FUNCTION_NAME
+#undef BVH_SUBTREE_FUNCTION_NAME
+#undef BVH_FUNCTION_FEATURES
+
@@ -94,29 +94,45 @@ ccl_device bool BVH_FUNCTION_NAME
 				float t = isect_t;
 
 				/* fetch node data */
-				float4 node0 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+0);
-				float4 node1 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+1);
-				float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
 				float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+3);
+				NO_EXTENDED_PRECISION float c0min, c0max, c1min, c1max;
 
-				/* intersect ray against child nodes */
-				NO_EXTENDED_PRECISION float c0lox = (node0.x - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c0hix = (node0.z - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c0loy = (node1.x - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c0hiy = (node1.z - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c0loz = (node2.x - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c0hiz = (node2.z - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c0min = max4(min(c0lox, c0hix), min(c0loy, c0hiy), min(c0loz, c0hiz), 0.0f);
-				NO_EXTENDED_PRECISION float c0max = min4(max(c0lox, c0hix), max(c0loy, c0hiy), max(c0loz, c0hiz), t);
-
-				NO_EXTENDED_PRECISION float c1lox = (node0.y - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c1hix = (node0.w - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c1loy = (node1.y - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c1hiy = (node1.w - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c1loz = (node2.y - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c1hiz = (node2.w - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c1min = max4(min(c1lox, c1hix), min(c1loy, c1hiy), min(c1loz, c1hiz), 0.0f);
-				NO_EXTENDED_PRECISION float c1max = min4(max(c1lox, c1hix), max(c1loy, c1hiy), max(c1loz, c1hiz), t);
+#if FEATURE(BVH_HAIR)
+				if(__float_as_uint(cnodes.z) & BVH_NODE_UNALIGNED) {
+					/* intersect ray against oriented child bounds */
+					float4 tminmax = bvh_unaligned_node_intersect(kg, P, dir, t, nodeAddr);
+
+					c0min = tminmax.x;
+					c1min = tminmax.y;
+					c0max = tminmax.z;
+					c1max = tminmax.w;
+				}
+				else
+#endif
+				{
+					float4 node0 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+0);
+					float4 node1 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+1);
+					float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
+
+					/* intersect ray against child nodes */
+					NO_EXTENDED_PRECISION float c0lox = (node0.x - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c0hix = (node0.z - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c0loy = (node1.x - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c0hiy = (node1.z - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c0loz = (node2.x - P.z) * idir.z;
+					NO_EXTENDED_PRECISION float c0hiz = (node2.z - P.z) * idir.z;
+					c0min = max4(min(c0lox, c0hix), min(c0loy, c0hiy), min(c0loz, c0hiz), 0.0f);
+					c0max = min4(max(c0lox, c0hix), max(c0loy, c0hiy), max(c0loz, c0hiz), t);
+
+					NO_EXTENDED_PRECISION float c1lox = (node0.y - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c1hix = (node0.w - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c1loy = (node1.y - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c1hiy = (node1.w - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c1loz = (node2.y - P.z) * idir.z;
+					NO_EXTENDED_PRECISION float c1hiz = (node2.w - P.z) * idir.z;
+					c1min = max4(min(c1lox, c1hix), min(c1loy, c1hiy), min(c1loz, c1hiz), 0.0f);
+					c1max = min4(max(c1lox, c1hix), max(c1loy, c1hiy), max(c1loz, c1hiz), t);
+				}
 
 				/* decide which nodes to traverse next */
 #ifdef __VISIBILITY_FLAG__
@@ -135,14 +151,27 @@ ccl_device bool BVH_FUNCTION_NAME
 				const __m128 *bvh_nodes = (__m128*)kg->__bvh_nodes.data + nodeAddr*BVH_NODE_SIZE;
 				const float4 cnodes = ((float4*)bvh_nodes)[3];
 
-				/* intersect ray against child nodes */
-				const __m128 tminmaxx = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[0], shufflexyz[0]), Psplat[0]), idirsplat[0]);
-				const __m128 tminmaxy = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[1], shufflexyz[1]), Psplat[1]), idirsplat[1]);
-				const __m128 tminmaxz = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[2], shufflexyz[2]), Psplat[2]), idirsplat[2]);
+				__m128 tminmax;
+
+#if FEATURE(BVH_HAIR)
+				if(__float_as_uint(cnodes.z) & BVH_NODE_UNALIGNED) {
+					/* intersect ray against oriented child bounds */
+					float4 unaligned_tminmax = bvh_unaligned_node_intersect(kg, P, dir, isect_t, nodeAddr);
+					tminmax = _mm_load_ps(&unaligned_tminmax.x);
+				}
+				else
+#endif
+				{
+					/* intersect ray against child nodes */
+					const __m128 tminmaxx = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[0], shufflexyz[0]), Psplat[0]), idirsplat[0]);
+					const __m128 tminmaxy = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[1], shufflexyz[1]), Psplat[1]), idirsplat[1]);
+					const __m128 tminmaxz = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[2], shufflexyz[2]), Psplat[2]), idirsplat[2]);
+
+					/* calculate { c0min, c1min, -c0max, -c1max} */
+					__m128 minmax = _mm_max_ps(_mm_max_ps(tminmaxx, tminmaxy), _mm_max_ps(tminmaxz, tsplat));
+					tminmax = _mm_xor_ps(minmax, pn);
+				}
 
-				/* calculate { c0min, c1min, -c0max, -c1max} */
-				__m128 minmax = _mm_max_ps(_mm_max_ps(tminmaxx, tminmaxy), _mm_max_ps(tminmaxz, tsplat));
-				const __m128 tminmax = _mm_xor_ps(minmax, pn);
 				const __m128 lrhit = _mm_cmple_ps(tminmax, shuffle<2, 3, 0, 1>(tminmax));
 
 				/* decide which nodes to traverse next */
@@ -74,6 +74,9 @@ ccl_device bool BVH_FUNCTION_NAME
 	
 	const __m128 pn = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0x80000000, 0, 0));
 	__m128 Psplat[3], idirsplat[3];
+#if defined(__KERNEL_AVX2__)
+	__m128 Pidirsplat[3];
+#endif
 	shuffle_swap_t shufflexyz[3];
 
 	Psplat[0] = _mm_set_ps1(P.x);
@@ -83,6 +86,11 @@ ccl_device bool BVH_FUNCTION_NAME
 	__m128 tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
 
 	gen_idirsplat_swap(pn, shuf_identity, shuf_swap, idir, idirsplat, shufflexyz);
+#if defined(__KERNEL_AVX2__)
+	Pidirsplat[0] = _mm_mul_ps(Psplat[0], idirsplat[0]);
+	Pidirsplat[1] = _mm_mul_ps(Psplat[1], idirsplat[1]);
+	Pidirsplat[2] = _mm_mul_ps(Psplat[2], idirsplat[2]);
+#endif
 #endif
 
 	/* traversal loop */
@@ -98,29 +106,45 @@ ccl_device bool BVH_FUNCTION_NAME
 				float t = isect->t;
 
 				/* fetch node data */
-				float4 node0 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+0);
-				float4 node1 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+1);
-				float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
 				float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+3);
+				NO_EXTENDED_PRECISION float c0min, c0max, c1min, c1max;
 
-				/* intersect ray against child nodes */
-				NO_EXTENDED_PRECISION float c0lox = (node0.x - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c0hix = (node0.z - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c0loy = (node1.x - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c0hiy = (node1.z - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c0loz = (node2.x - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c0hiz = (node2.z - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c0min = max4(min(c0lox, c0hix), min(c0loy, c0hiy), min(c0loz, c0hiz), 0.0f);
-				NO_EXTENDED_PRECISION float c0max = min4(max(c0lox, c0hix), max(c0loy, c0hiy), max(c0loz, c0hiz), t);
-
-				NO_EXTENDED_PRECISION float c1lox = (node0.y - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c1hix = (node0.w - P.x) * idir.x;
-				NO_EXTENDED_PRECISION float c1loy = (node1.y - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c1hiy = (node1.w - P.y) * idir.y;
-				NO_EXTENDED_PRECISION float c1loz = (node2.y - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c1hiz = (node2.w - P.z) * idir.z;
-				NO_EXTENDED_PRECISION float c1min = max4(min(c1lox, c1hix), min(c1loy, c1hiy), min(c1loz, c1hiz), 0.0f);
-				NO_EXTENDED_PRECISION float c1max = min4(max(c1lox, c1hix), max(c1loy, c1hiy), max(c1loz, c1hiz), t);
+#if FEATURE(BVH_HAIR)
+				if(__float_as_uint(cnodes.z) & BVH_NODE_UNALIGNED) {
+					/* intersect ray against oriented child bounds */
+					float4 tminmax = bvh_unaligned_node_intersect(kg, P, dir, t, nodeAddr);
+
+					c0min = tminmax.x;
+					c1min = tminmax.y;
+					c0max = tminmax.z;
+					c1max = tminmax.w;
+				}
+				else
+#endif
+				{
+					float4 node0 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+0);
+					float4 node1 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+1);
+					float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
+
+					/* intersect ray against child nodes */
+					NO_EXTENDED_PRECISION float c0lox = (node0.x - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c0hix = (node0.z - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c0loy = (node1.x - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c0hiy = (node1.z - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c0loz = (node2.x - P.z) * idir.z;
+					NO_EXTENDED_PRECISION float c0hiz = (node2.z - P.z) * idir.z;
+					c0min = max4(min(c0lox, c0hix), min(c0loy, c0hiy), min(c0loz, c0hiz), 0.0f);
+					c0max = min4(max(c0lox, c0hix), max(c0loy, c0hiy), max(c0loz, c0hiz), t);
+
+					NO_EXTENDED_PRECISION float c1lox = (node0.y - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c1hix = (node0.w - P.x) * idir.x;
+					NO_EXTENDED_PRECISION float c1loy = (node1.y - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c1hiy = (node1.w - P.y) * idir.y;
+					NO_EXTENDED_PRECISION float c1loz = (node2.y - P.z) * idir.z;
+					NO_EXTENDED_PRECISION float c1hiz = (node2.w - P.z) * idir.z;
+					c1min = max4(min(c1lox, c1hix), min(c1loy, c1hiy), min(c1loz, c1hiz), 0.0f);
+					c1max = min4(max(c1lox, c1hix), max(c1loy, c1hiy), max(c1loz, c1hiz), t);
+				}
 
 #if FEATURE(BVH_HAIR_MINIMUM_WIDTH)
 				if(difl != 0.0f) {
@@ -154,14 +178,33 @@ ccl_device bool BVH_FUNCTION_NAME
 				const __m128 *bvh_nodes = (__m128*)kg->__bvh_nodes.data + nodeAddr*BVH_NODE_SIZE;
 				const float4 cnodes = ((float4*)bvh_nodes)[3];
 
-				/* intersect ray against child nodes */
-				const __m128 tminmaxx = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[0], shufflexyz[0]), Psplat[0]), idirsplat[0]);
-				const __m128 tminmaxy = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[1], shufflexyz[1]), Psplat[1]), idirsplat[1]);
-				const __m128 tminmaxz = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[2], shufflexyz[2]), Psplat[2]), idirsplat[2]);
+				__m128 tminmax;
 
-				/* calculate { c0min, c1min, -c0max, -c1max} */
-				__m128 minmax = _mm_max_ps(_mm_max_ps(tminmaxx, tminmaxy), _mm_max_ps(tminmaxz, tsplat));
-				const __m128 tminmax = _mm_xor_ps(minmax, pn);
+#if FEATURE(BVH_HAIR)
+				if(__float_as_uint(cnodes.z) & BVH_NODE_UNALIGNED) {
+					/* intersect ray against oriented child bounds */
+					float4 unaligned_tminmax = bvh_unaligned_node_intersect(kg, P, dir, isect->t, nodeAddr);
+					tminmax = _mm_load_ps(&unaligned_tminmax.x);
+				}
+				else
+#endif
+				{
+					/* intersect ray against child nodes */
+#if defined(__KERNEL_AVX2__)
+					/* (node - P)*idir as node*idir - P*idir, in a single fused operation */
+					const __m128 tminmaxx = fms(shuffle_swap(bvh_nodes[0], shufflexyz[0]), idirsplat[0], Pidirsplat[0]);
+					const __m128 tminmaxy = fms(shuffle_swap(bvh_nodes[1], shufflexyz[1]), idirsplat[1], Pidirsplat[1]);
+					const __m128 tminmaxz = fms(shuffle_swap(bvh_nodes[2], shufflexyz[2]), idirsplat[2], Pidirsplat[2]);
+#else
+					const __m128 tminmaxx = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[0], shufflexyz[0]), Psplat[0]), idirsplat[0]);
+					const __m128 tminmaxy = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[1], shufflexyz[1]), Psplat[1]), idirsplat[1]);
+					const __m128 tminmaxz = _mm_mul_ps(_mm_sub_ps(shuffle_swap(bvh_nodes[2], shufflexyz[2]), Psplat[2]), idirsplat[2]);
+#endif
+
+					/* calculate { c0min, c1min, -c0max, -c1max} */
+					__m128 minmax = _mm_max_ps(_mm_max_ps(tminmaxx, tminmaxy), _mm_max_ps(tminmaxz, tsplat));
+					tminmax = _mm_xor_ps(minmax, pn);
+				}
 
 #if FEATURE(BVH_HAIR_MINIMUM_WIDTH)
 				if(difl != 0.0f) {
@@ -311,6 +354,11 @@ ccl_device bool BVH_FUNCTION_NAME
 					tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
 
 					gen_idirsplat_swap(pn, shuf_identity, shuf_swap, idir, idirsplat, shufflexyz);
+#if defined(__KERNEL_AVX2__)
+					Pidirsplat[0] = _mm_mul_ps(Psplat[0], idirsplat[0]);
+					Pidirsplat[1] = _mm_mul_ps(Psplat[1], idirsplat[1]);
+					Pidirsplat[2] = _mm_mul_ps(Psplat[2], idirsplat[2]);
+#endif
 #endif
 
 					++stackPtr;
@@ -341,6 +389,11 @@ ccl_device bool BVH_FUNCTION_NAME
 			tsplat = _mm_set_ps(-isect->t, -isect->t, 0.0f, 0.0f);
 
 			gen_idirsplat_swap(pn, shuf_identity, shuf_swap, idir, idirsplat, shufflexyz);
+#if defined(__KERNEL_AVX2__)
+			Pidirsplat[0] = _mm_mul_ps(Psplat[0], idirsplat[0]);
+			Pidirsplat[1] = _mm_mul_ps(Psplat[1], idirsplat[1]);
+			Pidirsplat[2] = _mm_mul_ps(Psplat[2], idirsplat[2]);
+#endif
 #endif
 
 			object = OBJECT_NONE;
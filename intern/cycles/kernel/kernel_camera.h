@@ -152,8 +152,14 @@ ccl_device void camera_sample_panorama(KernelGlobals *kg, float raster_x, float
 	Transform rastertocamera = kernel_data.cam.rastertocamera;
 	float3 Pcamera = transform_perspective(&rastertocamera, make_float3(raster_x, raster_y, 0.0f));
 
-	/* create ray form raster position */
-	ray->P = make_float3(0.0f, 0.0f, 0.0f);
+	/* create ray form raster position, stereo panoramas have a different eye
+	 * position for each pixel */
+	ray->P = panorama_to_position(kg, Pcamera.x, Pcamera.y);
+
+#ifdef __RAY_DIFFERENTIALS__
+	/* eye position before the lens offset, for the position differentials */
+	float3 Peye = ray->P;
+#endif
 
 #ifdef __CAMERA_CLIPPING__
 	/* clipping */
@@ -179,14 +185,14 @@ ccl_device void camera_sample_panorama(KernelGlobals *kg, float raster_x, float
 
 		/* compute point on plane of focus */
 		float3 D = normalize(ray->D);
-		float3 Pfocus = D * kernel_data.cam.focaldistance;
+		float3 Pfocus = ray->P + D * kernel_data.cam.focaldistance;
 
 		/* calculate orthonormal coordinates perpendicular to D */
 		float3 U, V;
 		make_orthonormals(D, &U, &V);
 
 		/* update ray for effect of lens */
-		ray->P = U * lensuv.x + V * lensuv.y;
+		ray->P += U * lensuv.x + V * lensuv.y;
 		ray->D = normalize(Pfocus - ray->P);
 	}
 
@@ -206,11 +212,20 @@ ccl_device void camera_sample_panorama(KernelGlobals *kg, float raster_x, float
 	/* ray differential */
 	ray->dP = differential3_zero();
 
+	if(kernel_data.cam.panorama_type == PANORAMA_ODS)
+		Peye = transform_point(&cameratoworld, Peye);
+
 	Pcamera = transform_perspective(&rastertocamera, make_float3(raster_x + 1.0f, raster_y, 0.0f));
 	ray->dD.dx = normalize(transform_direction(&cameratoworld, panorama_to_direction(kg, Pcamera.x, Pcamera.y))) - ray->D;
 
+	if(kernel_data.cam.panorama_type == PANORAMA_ODS)
+		ray->dP.dx = transform_point(&cameratoworld, panorama_to_position(kg, Pcamera.x, Pcamera.y)) - Peye;
+
 	Pcamera = transform_perspective(&rastertocamera, make_float3(raster_x, raster_y + 1.0f, 0.0f));
 	ray->dD.dy = normalize(transform_direction(&cameratoworld, panorama_to_direction(kg, Pcamera.x, Pcamera.y))) - ray->D;
+
+	if(kernel_data.cam.panorama_type == PANORAMA_ODS)
+		ray->dP.dy = transform_point(&cameratoworld, panorama_to_position(kg, Pcamera.x, Pcamera.y)) - Peye;
 #endif
 }
 
@@ -241,6 +256,77 @@ ccl_device void camera_sample(KernelGlobals *kg, int x, int y, float filter_u, f
 		camera_sample_panorama(kg, raster_x, raster_y, lens_u, lens_v, ray);
 }
 
+/* Foveated Sampling
+ *
+ * Pixels far from the gaze center get fewer samples. The density is read from
+ * a map if one is given, otherwise it falls off with the distance to the
+ * center, in the image for regular cameras and as the angle between viewing
+ * directions for panoramas. The number of samples each pixel received is
+ * written to a pass to normalize the result. */
+
+ccl_device float camera_sample_density(KernelGlobals *kg, int x, int y)
+{
+	float width = kernel_data.cam.width;
+	float height = kernel_data.cam.height;
+
+	if(kernel_data.film.foveated_map_width) {
+		int map_width = kernel_data.film.foveated_map_width;
+		int map_height = kernel_data.film.foveated_map_height;
+		int map_x = clamp(float_to_int((x + 0.5f)*map_width/width), 0, map_width - 1);
+		int map_y = clamp(float_to_int((y + 0.5f)*map_height/height), 0, map_height - 1);
+
+		return kernel_tex_fetch(__lookup_table, kernel_data.film.foveated_map_offset + map_x + map_y*map_width);
+	}
+
+	float center_x = kernel_data.film.foveated_center_x*width;
+	float center_y = kernel_data.film.foveated_center_y*height;
+	float dist;
+
+	if(kernel_data.cam.type == CAMERA_PANORAMA) {
+		Transform rastertocamera = kernel_data.cam.rastertocamera;
+		float3 P = transform_perspective(&rastertocamera, make_float3(x + 0.5f, y + 0.5f, 0.0f));
+		float3 Pcenter = transform_perspective(&rastertocamera, make_float3(center_x, center_y, 0.0f));
+		float3 D = panorama_to_direction(kg, P.x, P.y);
+		float3 Dcenter = panorama_to_direction(kg, Pcenter.x, Pcenter.y);
+
+		/* outside of the lens */
+		if(is_zero(D) || is_zero(Dcenter))
+			return kernel_data.film.foveated_min_density;
+
+		dist = acosf(clamp(dot(normalize(D), normalize(Dcenter)), -1.0f, 1.0f))*M_1_PI_F;
+	}
+	else {
+		float dx = (x + 0.5f - center_x)/width;
+		float dy = (y + 0.5f - center_y)/width;
+
+		dist = sqrtf(dx*dx + dy*dy);
+	}
+
+	float radius = kernel_data.film.foveated_radius;
+	float density = (dist > radius)? radius/dist: 1.0f;
+
+	return max(density, kernel_data.film.foveated_min_density);
+}
+
+ccl_device bool camera_sample_foveated(KernelGlobals *kg, int sample, int x, int y)
+{
+	/* the first sample initializes the buffers, so is taken for every pixel */
+	if(sample == 0 || !kernel_data.film.use_foveated)
+		return true;
+
+	float density = camera_sample_density(kg, x, y);
+
+	if(density >= 1.0f)
+		return true;
+
+	/* take a sample each time the expected number of samples crosses an
+	 * integer, with a random offset per pixel to spread them out over the
+	 * image and avoid visible patterns */
+	float offset = cmj_randfloat(x, y);
+
+	return floorf((sample + 1)*density + offset) > floorf(sample*density + offset);
+}
+
 /* Utilities */
 
 ccl_device_inline float3 camera_position(KernelGlobals *kg)
@@ -67,6 +67,8 @@ ccl_device_noinline bool direct_emission(KernelGlobals *kg, ShaderData *sd, int
 	float randt, float randu, float randv, Ray *ray, BsdfEval *eval,
 	bool *is_lamp, int bounce, int transparent_bounce)
 {
+	PROFILING_SCOPE(kg, PROFILING_LIGHT_SAMPLE);
+
 	LightSample ls;
 
 #ifdef __BRANCHED_PATH__
@@ -32,6 +32,11 @@ ccl_device float4 film_map(KernelGlobals *kg, float4 irradiance, float scale)
 	return result;
 }
 
+ccl_device float film_sample_count_scale(float sample_count)
+{
+	return (sample_count > 0.0f)? 1.0f/sample_count: 0.0f;
+}
+
 ccl_device uchar4 film_float_to_byte(float4 color)
 {
 	uchar4 result;
@@ -55,6 +60,10 @@ ccl_device void kernel_film_convert_to_byte(KernelGlobals *kg,
 	rgba += index;
 	buffer += index*kernel_data.film.pass_stride;
 
+	/* pixels have different numbers of samples with foveated sampling */
+	if(kernel_data.film.pass_flag & PASS_SAMPLE_COUNT)
+		sample_scale = film_sample_count_scale(buffer[kernel_data.film.pass_sample_count]);
+
 	/* map colors */
 	float4 irradiance = *((ccl_global float4*)buffer);
 	float4 float_result = film_map(kg, irradiance, sample_scale);
@@ -73,6 +82,9 @@ ccl_device void kernel_film_convert_to_half_float(KernelGlobals *kg,
 	ccl_global float4 *in = (ccl_global float4*)(buffer + index*kernel_data.film.pass_stride);
 	ccl_global half *out = (ccl_global half*)rgba + index*4;
 
+	if(kernel_data.film.pass_flag & PASS_SAMPLE_COUNT)
+		sample_scale = film_sample_count_scale(buffer[index*kernel_data.film.pass_stride + kernel_data.film.pass_sample_count]);
+
 	float exposure = kernel_data.film.exposure;
 
 	float4 rgba_in = *in;
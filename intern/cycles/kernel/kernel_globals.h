@@ -16,6 +16,12 @@
 
 /* Constant Globals */
 
+#ifdef __KERNEL_CPU__
+#include "util_profiling_state.h"
+#endif
+
+#include "kernel_profiling.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* On the CPU, we pass along the struct KernelGlobals to nearly everywhere in
@@ -52,6 +58,9 @@ typedef struct KernelGlobals {
 	OSLThreadData *osl_tdata;
 #endif
 
+	/* per thread profiling state, see kernel_profiling.h */
+	ProfilingState profiler;
+
 } KernelGlobals;
 
 #endif
@@ -516,6 +516,8 @@ ccl_device int light_distribution_sample(KernelGlobals *kg, float randt)
 
 ccl_device void light_sample(KernelGlobals *kg, float randt, float randu, float randv, float time, float3 P, LightSample *ls)
 {
+	PROFILING_SCOPE(kg, PROFILING_LIGHT_SAMPLE);
+
 	/* sample index */
 	int index = light_distribution_sample(kg, randt);
 
@@ -37,6 +37,8 @@ ccl_device_inline void kernel_write_pass_float4(ccl_global float *buffer, int sa
 ccl_device_inline void kernel_write_data_passes(KernelGlobals *kg, ccl_global float *buffer, PathRadiance *L,
 	ShaderData *sd, int sample, PathState *state, float3 throughput)
 {
+	PROFILING_SCOPE(kg, PROFILING_WRITE_RESULT);
+
 #ifdef __PASSES__
 	int path_flag = state->flag;
 
@@ -125,6 +127,8 @@ ccl_device_inline void kernel_write_data_passes(KernelGlobals *kg, ccl_global fl
 
 ccl_device_inline void kernel_write_light_passes(KernelGlobals *kg, ccl_global float *buffer, PathRadiance *L, int sample)
 {
+	PROFILING_SCOPE(kg, PROFILING_WRITE_RESULT);
+
 #ifdef __PASSES__
 	int flag = kernel_data.film.pass_flag;
 
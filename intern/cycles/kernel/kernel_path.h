@@ -125,43 +125,89 @@ ccl_device_inline bool kernel_path_integrate_scatter_lighting(KernelGlobals *kg,
 
 #if defined(__BRANCHED_PATH__) || defined(__SUBSURFACE__)
 
-ccl_device void kernel_branched_path_integrate_direct_lighting(KernelGlobals *kg, RNG *rng,
-	ShaderData *sd, PathState *state, float3 throughput, float num_samples_adjust, PathRadiance *L, bool sample_all_lights)
+/* sample j of num_samples for lamp, or for the mesh lights with LAMP_NONE */
+ccl_device_inline bool kernel_branched_path_light_ray(KernelGlobals *kg, RNG *rng, ShaderData *sd,
+	PathState *state, int lamp, int j, int num_samples, Ray *light_ray, BsdfEval *L_light, bool *is_lamp)
 {
-	/* sample illumination from lights to find path contribution */
-	if(sd->flag & SD_BSDF_HAS_EVAL) {
+	float light_t = 0.0f;
+	float light_u, light_v;
+
+	if(lamp != LAMP_NONE) {
+		RNG lamp_rng = cmj_hash(*rng, lamp);
+		path_branched_rng_2D(kg, &lamp_rng, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
+	}
+	else {
+		light_t = path_branched_rng_1D(kg, rng, state, j, num_samples, PRNG_LIGHT);
+		path_branched_rng_2D(kg, rng, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
+
+		/* only sample triangle lights */
+		if(kernel_data.integrator.num_all_lights)
+			light_t = 0.5f*light_t;
+	}
+
+#ifdef __OBJECT_MOTION__
+	light_ray->time = sd->time;
+#endif
+
+	return direct_emission(kg, sd, lamp, light_t, light_u, light_v, light_ray, L_light, is_lamp, state->bounce, state->transparent_bounce);
+}
+
+ccl_device void kernel_branched_path_integrate_light_samples(KernelGlobals *kg, RNG *rng,
+	ShaderData *sd, PathState *state, float3 throughput, float num_samples_inv, PathRadiance *L, int lamp, int num_samples)
+{
+#ifdef __RAY_PACKETS__
+	/* all shadow rays leave from the same point, trace them in packets */
+	for(int j = 0; j < num_samples; j += RAY_PACKET_SIZE) {
+		Ray light_ray[RAY_PACKET_SIZE];
+		BsdfEval L_light[RAY_PACKET_SIZE];
+		bool is_lamp[RAY_PACKET_SIZE];
+		float3 shadow[RAY_PACKET_SIZE];
+		int num_rays = 0;
+
+		for(int k = j; k < min(j + RAY_PACKET_SIZE, num_samples); k++)
+			if(kernel_branched_path_light_ray(kg, rng, sd, state, lamp, k, num_samples, &light_ray[num_rays], &L_light[num_rays], &is_lamp[num_rays]))
+				num_rays++;
+
+		uint blocked = shadow_blocked_packet(kg, state, light_ray, shadow, num_rays);
+
+		for(int k = 0; k < num_rays; k++)
+			if(!(blocked & (1 << k)))
+				path_radiance_accum_light(L, throughput*num_samples_inv, &L_light[k], shadow[k], num_samples_inv, state->bounce, is_lamp[k]);
+	}
+#else
+	for(int j = 0; j < num_samples; j++) {
 		Ray light_ray;
 		BsdfEval L_light;
 		bool is_lamp;
 
-#ifdef __OBJECT_MOTION__
-		light_ray.time = sd->time;
+		if(kernel_branched_path_light_ray(kg, rng, sd, state, lamp, j, num_samples, &light_ray, &L_light, &is_lamp)) {
+			/* trace shadow ray */
+			float3 shadow;
+
+			if(!shadow_blocked(kg, state, &light_ray, &shadow)) {
+				/* accumulate */
+				path_radiance_accum_light(L, throughput*num_samples_inv, &L_light, shadow, num_samples_inv, state->bounce, is_lamp);
+			}
+		}
+	}
 #endif
+}
 
+ccl_device void kernel_branched_path_integrate_direct_lighting(KernelGlobals *kg, RNG *rng,
+	ShaderData *sd, PathState *state, float3 throughput, float num_samples_adjust, PathRadiance *L, bool sample_all_lights)
+{
+	/* sample illumination from lights to find path contribution */
+	if(sd->flag & SD_BSDF_HAS_EVAL) {
 		if(sample_all_lights) {
 			/* lamp sampling */
 			for(int i = 0; i < kernel_data.integrator.num_all_lights; i++) {
 				int num_samples = ceil_to_int(num_samples_adjust*light_select_num_samples(kg, i));
 				float num_samples_inv = num_samples_adjust/(num_samples*kernel_data.integrator.num_all_lights);
-				RNG lamp_rng = cmj_hash(*rng, i);
 
 				if(kernel_data.integrator.pdf_triangles != 0.0f)
 					num_samples_inv *= 0.5f;
 
-				for(int j = 0; j < num_samples; j++) {
-					float light_u, light_v;
-					path_branched_rng_2D(kg, &lamp_rng, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
-
-					if(direct_emission(kg, sd, i, 0.0f, light_u, light_v, &light_ray, &L_light, &is_lamp, state->bounce, state->transparent_bounce)) {
-						/* trace shadow ray */
-						float3 shadow;
-
-						if(!shadow_blocked(kg, state, &light_ray, &shadow)) {
-							/* accumulate */
-							path_radiance_accum_light(L, throughput*num_samples_inv, &L_light, shadow, num_samples_inv, state->bounce, is_lamp);
-						}
-					}
-				}
+				kernel_branched_path_integrate_light_samples(kg, rng, sd, state, throughput, num_samples_inv, L, i, num_samples);
 			}
 
 			/* mesh light sampling */
@@ -172,28 +218,18 @@ ccl_device void kernel_branched_path_integrate_direct_lighting(KernelGlobals *kg
 				if(kernel_data.integrator.num_all_lights)
 					num_samples_inv *= 0.5f;
 
-				for(int j = 0; j < num_samples; j++) {
-					float light_t = path_branched_rng_1D(kg, rng, state, j, num_samples, PRNG_LIGHT);
-					float light_u, light_v;
-					path_branched_rng_2D(kg, rng, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
-
-					/* only sample triangle lights */
-					if(kernel_data.integrator.num_all_lights)
-						light_t = 0.5f*light_t;
-
-					if(direct_emission(kg, sd, LAMP_NONE, light_t, light_u, light_v, &light_ray, &L_light, &is_lamp, state->bounce, state->transparent_bounce)) {
-						/* trace shadow ray */
-						float3 shadow;
-
-						if(!shadow_blocked(kg, state, &light_ray, &shadow)) {
-							/* accumulate */
-							path_radiance_accum_light(L, throughput*num_samples_inv, &L_light, shadow, num_samples_inv, state->bounce, is_lamp);
-						}
-					}
-				}
+				kernel_branched_path_integrate_light_samples(kg, rng, sd, state, throughput, num_samples_inv, L, LAMP_NONE, num_samples);
 			}
 		}
 		else {
+			Ray light_ray;
+			BsdfEval L_light;
+			bool is_lamp;
+
+#ifdef __OBJECT_MOTION__
+			light_ray.time = sd->time;
+#endif
+
 			float light_t = path_state_rng_1D(kg, rng, state, PRNG_LIGHT);
 			float light_u, light_v;
 			path_state_rng_2D(kg, rng, state, PRNG_LIGHT_U, &light_u, &light_v);
@@ -601,7 +637,11 @@ ccl_device void kernel_path_ao(KernelGlobals *kg, ShaderData *sd, PathRadiance *
 	}
 }
 
-ccl_device float4 kernel_path_integrate(KernelGlobals *kg, RNG *rng, int sample, Ray ray, ccl_global float *buffer)
+ccl_device float4 kernel_path_integrate(KernelGlobals *kg, RNG *rng, int sample, Ray ray, ccl_global float *buffer
+#ifdef __RAY_PACKETS__
+	, const Intersection *primary_isect
+#endif
+	)
 {
 	/* initialize */
 	PathRadiance L;
@@ -633,10 +673,23 @@ ccl_device float4 kernel_path_integrate(KernelGlobals *kg, RNG *rng, int sample,
 			extmax = kernel_data.curve.maximum_width;
 			lcg_state = lcg_state_init(rng, &state, 0x51633e2d);
 		}
+#endif
+
+		bool hit;
 
-		bool hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
+#ifdef __RAY_PACKETS__
+		if(primary_isect) {
+			/* camera ray was already intersected as part of a packet */
+			isect = *primary_isect;
+			hit = (isect.prim != PRIM_NONE);
+			primary_isect = NULL;
+		}
+		else
+#endif
+#ifdef __HAIR__
+			hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
 #else
-		bool hit = scene_intersect(kg, &ray, visibility, &isect);
+			hit = scene_intersect(kg, &ray, visibility, &isect);
 #endif
 
 #ifdef __LAMP_MIS__
@@ -1034,7 +1087,37 @@ ccl_device_noinline void kernel_branched_path_integrate_lighting(KernelGlobals *
 	}
 }
 
-ccl_device float4 kernel_branched_path_integrate(KernelGlobals *kg, RNG *rng, int sample, Ray ray, ccl_global float *buffer)
+ccl_device_inline bool kernel_branched_path_ao_ray(KernelGlobals *kg, RNG *rng, PathState *state,
+	ShaderData *sd, float3 ao_N, int sample, int num_samples, Ray *light_ray)
+{
+	float bsdf_u, bsdf_v;
+	path_branched_rng_2D(kg, rng, state, sample, num_samples, PRNG_BSDF_U, &bsdf_u, &bsdf_v);
+
+	float3 ao_D;
+	float ao_pdf;
+
+	sample_cos_hemisphere(ao_N, bsdf_u, bsdf_v, &ao_D, &ao_pdf);
+
+	if(!(dot(sd->Ng, ao_D) > 0.0f && ao_pdf != 0.0f))
+		return false;
+
+	light_ray->P = ray_offset(sd->P, sd->Ng);
+	light_ray->D = ao_D;
+	light_ray->t = kernel_data.background.ao_distance;
+#ifdef __OBJECT_MOTION__
+	light_ray->time = sd->time;
+#endif
+	light_ray->dP = sd->dP;
+	light_ray->dD = differential3_zero();
+
+	return true;
+}
+
+ccl_device float4 kernel_branched_path_integrate(KernelGlobals *kg, RNG *rng, int sample, Ray ray, ccl_global float *buffer
+#ifdef __RAY_PACKETS__
+	, const Intersection *primary_isect
+#endif
+	)
 {
 	/* initialize */
 	PathRadiance L;
@@ -1065,10 +1148,23 @@ ccl_device float4 kernel_branched_path_integrate(KernelGlobals *kg, RNG *rng, in
 			extmax = kernel_data.curve.maximum_width;
 			lcg_state = lcg_state_init(rng, &state, 0x51633e2d);
 		}
+#endif
+
+		bool hit;
 
-		bool hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
+#ifdef __RAY_PACKETS__
+		if(primary_isect) {
+			/* camera ray was already intersected as part of a packet */
+			isect = *primary_isect;
+			hit = (isect.prim != PRIM_NONE);
+			primary_isect = NULL;
+		}
+		else
+#endif
+#ifdef __HAIR__
+			hit = scene_intersect(kg, &ray, visibility, &isect, &lcg_state, difl, extmax);
 #else
-		bool hit = scene_intersect(kg, &ray, visibility, &isect);
+			hit = scene_intersect(kg, &ray, visibility, &isect);
 #endif
 
 #ifdef __VOLUME__
@@ -1255,32 +1351,34 @@ ccl_device float4 kernel_branched_path_integrate(KernelGlobals *kg, RNG *rng, in
 			float3 ao_bsdf = shader_bsdf_ao(kg, &sd, ao_factor, &ao_N);
 			float3 ao_alpha = shader_bsdf_alpha(kg, &sd);
 
-			for(int j = 0; j < num_samples; j++) {
-				float bsdf_u, bsdf_v;
-				path_branched_rng_2D(kg, rng, &state, j, num_samples, PRNG_BSDF_U, &bsdf_u, &bsdf_v);
-
-				float3 ao_D;
-				float ao_pdf;
+#ifdef __RAY_PACKETS__
+			/* all ao rays leave from the same point, trace them in packets */
+			for(int j = 0; j < num_samples; j += RAY_PACKET_SIZE) {
+				Ray light_ray[RAY_PACKET_SIZE];
+				float3 ao_shadow[RAY_PACKET_SIZE];
+				int num_rays = 0;
 
-				sample_cos_hemisphere(ao_N, bsdf_u, bsdf_v, &ao_D, &ao_pdf);
+				for(int k = j; k < min(j + RAY_PACKET_SIZE, num_samples); k++)
+					if(kernel_branched_path_ao_ray(kg, rng, &state, &sd, ao_N, k, num_samples, &light_ray[num_rays]))
+						num_rays++;
 
-				if(dot(sd.Ng, ao_D) > 0.0f && ao_pdf != 0.0f) {
-					Ray light_ray;
-					float3 ao_shadow;
+				uint blocked = shadow_blocked_packet(kg, &state, light_ray, ao_shadow, num_rays);
 
-					light_ray.P = ray_offset(sd.P, sd.Ng);
-					light_ray.D = ao_D;
-					light_ray.t = kernel_data.background.ao_distance;
-#ifdef __OBJECT_MOTION__
-					light_ray.time = sd.time;
-#endif
-					light_ray.dP = sd.dP;
-					light_ray.dD = differential3_zero();
+				for(int k = 0; k < num_rays; k++)
+					if(!(blocked & (1 << k)))
+						path_radiance_accum_ao(&L, throughput*num_samples_inv, ao_alpha, ao_bsdf, ao_shadow[k], state.bounce);
+			}
+#else
+			for(int j = 0; j < num_samples; j++) {
+				Ray light_ray;
+				float3 ao_shadow;
 
+				if(kernel_branched_path_ao_ray(kg, rng, &state, &sd, ao_N, j, num_samples, &light_ray)) {
 					if(!shadow_blocked(kg, &state, &light_ray, &ao_shadow))
 						path_radiance_accum_ao(&L, throughput*num_samples_inv, ao_alpha, ao_bsdf, ao_shadow, state.bounce);
 				}
 			}
+#endif
 		}
 #endif
 
@@ -1396,6 +1494,9 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 	int index = offset + x + y*stride;
 	int pass_stride = kernel_data.film.pass_stride;
 
+	if(!camera_sample_foveated(kg, sample, x, y))
+		return;
+
 	rng_state += index;
 	buffer += index*pass_stride;
 
@@ -1403,19 +1504,33 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 	RNG rng;
 	Ray ray;
 
+	PROFILING_EVENT(kg, PROFILING_RAY_SETUP);
+	PROFILING_RAY(kg, PROFILING_RAY_CAMERA);
+
 	kernel_path_trace_setup(kg, rng_state, sample, x, y, &rng, &ray);
 
 	/* integrate */
 	float4 L;
 
+	PROFILING_EVENT(kg, PROFILING_PATH_INTEGRATE);
+
 	if(ray.t != 0.0f)
-		L = kernel_path_integrate(kg, &rng, sample, ray, buffer);
+		L = kernel_path_integrate(kg, &rng, sample, ray, buffer
+#ifdef __RAY_PACKETS__
+			, NULL
+#endif
+			);
 	else
 		L = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 
 	/* accumulate result in output buffer */
+	PROFILING_EVENT(kg, PROFILING_WRITE_RESULT);
+
 	kernel_write_pass_float4(buffer, sample, L);
 
+	if(kernel_data.film.pass_flag & PASS_SAMPLE_COUNT)
+		kernel_write_pass_float(buffer + kernel_data.film.pass_sample_count, sample, 1.0f);
+
 	path_rng_end(kg, rng_state, rng);
 }
 
@@ -1428,6 +1543,9 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 	int index = offset + x + y*stride;
 	int pass_stride = kernel_data.film.pass_stride;
 
+	if(!camera_sample_foveated(kg, sample, x, y))
+		return;
+
 	rng_state += index;
 	buffer += index*pass_stride;
 
@@ -1435,22 +1553,125 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 	RNG rng;
 	Ray ray;
 
+	PROFILING_EVENT(kg, PROFILING_RAY_SETUP);
+	PROFILING_RAY(kg, PROFILING_RAY_CAMERA);
+
 	kernel_path_trace_setup(kg, rng_state, sample, x, y, &rng, &ray);
 
 	/* integrate */
 	float4 L;
 
+	PROFILING_EVENT(kg, PROFILING_PATH_INTEGRATE);
+
 	if(ray.t != 0.0f)
-		L = kernel_branched_path_integrate(kg, &rng, sample, ray, buffer);
+		L = kernel_branched_path_integrate(kg, &rng, sample, ray, buffer
+#ifdef __RAY_PACKETS__
+			, NULL
+#endif
+			);
 	else
 		L = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 
 	/* accumulate result in output buffer */
+	PROFILING_EVENT(kg, PROFILING_WRITE_RESULT);
+
 	kernel_write_pass_float4(buffer, sample, L);
 
+	if(kernel_data.film.pass_flag & PASS_SAMPLE_COUNT)
+		kernel_write_pass_float(buffer + kernel_data.film.pass_sample_count, sample, 1.0f);
+
 	path_rng_end(kg, rng_state, rng);
 }
 #endif
 
+#ifdef __RAY_PACKETS__
+/* Path trace up to RAY_PACKET_SIZE neighbouring pixels in a row, with the
+ * coherent camera rays intersected as one packet. */
+
+ccl_device void kernel_path_trace_packet(KernelGlobals *kg,
+	ccl_global float *buffer, ccl_global uint *rng_state,
+	int sample, int x, int y, int num, int offset, int stride)
+{
+	if(!scene_intersect_packet_supported(kg)) {
+		for(int i = 0; i < num; i++) {
+#ifdef __BRANCHED_PATH__
+			if(kernel_data.integrator.branched)
+				kernel_branched_path_trace(kg, buffer, rng_state, sample, x + i, y, offset, stride);
+			else
+#endif
+				kernel_path_trace(kg, buffer, rng_state, sample, x + i, y, offset, stride);
+		}
+
+		return;
+	}
+
+	int pass_stride = kernel_data.film.pass_stride;
+
+	/* initialize random numbers and rays */
+	RNG rng[RAY_PACKET_SIZE];
+	Ray ray[RAY_PACKET_SIZE];
+	Intersection isect[RAY_PACKET_SIZE];
+	bool active[RAY_PACKET_SIZE];
+
+	PROFILING_EVENT(kg, PROFILING_RAY_SETUP);
+
+	for(int i = 0; i < num; i++) {
+		int index = offset + x + i + y*stride;
+
+		/* pixels skipped by foveated sampling get a ray that hits nothing */
+		active[i] = camera_sample_foveated(kg, sample, x + i, y);
+
+		if(!active[i]) {
+			ray[i].P = make_float3(0.0f, 0.0f, 0.0f);
+			ray[i].D = make_float3(0.0f, 0.0f, 1.0f);
+			ray[i].t = 0.0f;
+			continue;
+		}
+
+		PROFILING_RAY(kg, PROFILING_RAY_CAMERA);
+
+		kernel_path_trace_setup(kg, rng_state + index, sample, x + i, y, &rng[i], &ray[i]);
+	}
+
+	/* intersect camera rays, with the visibility of the first ray of a new path */
+	PROFILING_EVENT(kg, PROFILING_PATH_INTEGRATE);
+
+	uint visibility = path_flag_ray_visibility(kg, path_state_init_flag());
+	scene_intersect_packet(kg, ray, visibility, isect, num);
+
+	/* integrate */
+	for(int i = 0; i < num; i++) {
+		int index = offset + x + i + y*stride;
+		float4 L;
+
+		if(!active[i])
+			continue;
+
+		if(ray[i].t != 0.0f) {
+#ifdef __BRANCHED_PATH__
+			if(kernel_data.integrator.branched)
+				L = kernel_branched_path_integrate(kg, &rng[i], sample, ray[i], buffer + index*pass_stride, &isect[i]);
+			else
+#endif
+				L = kernel_path_integrate(kg, &rng[i], sample, ray[i], buffer + index*pass_stride, &isect[i]);
+		}
+		else
+			L = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+		/* accumulate result in output buffer */
+		PROFILING_EVENT(kg, PROFILING_WRITE_RESULT);
+
+		kernel_write_pass_float4(buffer + index*pass_stride, sample, L);
+
+		if(kernel_data.film.pass_flag & PASS_SAMPLE_COUNT)
+			kernel_write_pass_float(buffer + index*pass_stride + kernel_data.film.pass_sample_count, sample, 1.0f);
+
+		path_rng_end(kg, rng_state + index, rng[i]);
+
+		PROFILING_EVENT(kg, PROFILING_PATH_INTEGRATE);
+	}
+}
+#endif
+
 CCL_NAMESPACE_END
 
@@ -16,9 +16,15 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* flags of a new path, of which the first ray is the camera ray */
+ccl_device_inline int path_state_init_flag()
+{
+	return PATH_RAY_CAMERA|PATH_RAY_SINGULAR|PATH_RAY_MIS_SKIP;
+}
+
 ccl_device_inline void path_state_init(KernelGlobals *kg, PathState *state, RNG *rng, int sample)
 {
-	state->flag = PATH_RAY_CAMERA|PATH_RAY_SINGULAR|PATH_RAY_MIS_SKIP;
+	state->flag = path_state_init_flag();
 
 	state->rng_offset = PRNG_BASE_NUM;
 	state->sample = sample;
@@ -125,15 +131,15 @@ ccl_device_inline void path_state_next(KernelGlobals *kg, PathState *state, int
 	state->rng_offset += PRNG_BOUNCE_NUM;
 }
 
-ccl_device_inline uint path_state_ray_visibility(KernelGlobals *kg, PathState *state)
+ccl_device_inline uint path_flag_ray_visibility(KernelGlobals *kg, int path_flag)
 {
-	uint flag = state->flag & PATH_RAY_ALL_VISIBILITY;
+	uint flag = path_flag & PATH_RAY_ALL_VISIBILITY;
 
 	/* for visibility, diffuse/glossy are for reflection only */
 	if(flag & PATH_RAY_TRANSMIT)
 		flag &= ~(PATH_RAY_DIFFUSE|PATH_RAY_GLOSSY);
 	/* todo: this is not supported as its own ray visibility yet */
-	if(state->flag & PATH_RAY_VOLUME_SCATTER)
+	if(path_flag & PATH_RAY_VOLUME_SCATTER)
 		flag |= PATH_RAY_DIFFUSE;
 	/* for camera visibility, use render layer flags */
 	if(flag & PATH_RAY_CAMERA)
@@ -142,6 +148,11 @@ ccl_device_inline uint path_state_ray_visibility(KernelGlobals *kg, PathState *s
 	return flag;
 }
 
+ccl_device_inline uint path_state_ray_visibility(KernelGlobals *kg, PathState *state)
+{
+	return path_flag_ray_visibility(kg, state->flag);
+}
+
 ccl_device_inline float path_state_terminate_probability(KernelGlobals *kg, PathState *state, const float3 throughput)
 {
 	if(state->flag & PATH_RAY_TRANSPARENT) {
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2011-2014 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#ifndef __KERNEL_PROFILING_H__
+#define __KERNEL_PROFILING_H__
+
+/* On the CPU each thread's KernelGlobals has a ProfilingState that is sampled
+ * by the Profiler, see util_profiling.h. Nothing is stored unless the state is
+ * active. On other devices these do nothing. */
+
+#ifdef __KERNEL_CPU__
+
+CCL_NAMESPACE_BEGIN
+
+/* Sets an event for the duration of a scope and restores the previous one,
+ * so nested phases are attributed correctly */
+
+class ProfilingScope {
+public:
+	ProfilingScope(ProfilingState *state_, int event)
+	: state((state_->active)? state_: NULL)
+	{
+		if(state) {
+			prev_event = state->event;
+			state->event = event;
+		}
+	}
+
+	~ProfilingScope()
+	{
+		if(state)
+			state->event = prev_event;
+	}
+
+protected:
+	ProfilingState *state;
+	int prev_event;
+};
+
+ccl_device_inline void profiling_event(ProfilingState *state, int event)
+{
+	if(state->active)
+		state->event = event;
+}
+
+ccl_device_inline void profiling_shader(ProfilingState *state, int shader)
+{
+	if(state->active) {
+		state->shader = shader;
+		state->node = -1;
+	}
+}
+
+ccl_device_inline void profiling_svm_node(ProfilingState *state, int node)
+{
+	if(state->active)
+		state->node = node;
+}
+
+ccl_device_inline void profiling_ray(ProfilingState *state, int type)
+{
+	if(state->active)
+		state->rays[type]++;
+}
+
+CCL_NAMESPACE_END
+
+#define PROFILING_EVENT(kg, event_) profiling_event(&(kg)->profiler, (event_))
+#define PROFILING_SCOPE(kg, event_) ProfilingScope profiling_scope(&(kg)->profiler, (event_))
+#define PROFILING_SHADER(kg, shader_) profiling_shader(&(kg)->profiler, (shader_))
+#define PROFILING_SVM_NODE(kg, node_) profiling_svm_node(&(kg)->profiler, (node_))
+#define PROFILING_RAY(kg, type) profiling_ray(&(kg)->profiler, (type))
+
+#else
+
+#define PROFILING_EVENT(kg, event_)
+#define PROFILING_SCOPE(kg, event_)
+#define PROFILING_SHADER(kg, shader_)
+#define PROFILING_SVM_NODE(kg, node_)
+#define PROFILING_RAY(kg, type)
+
+#endif
+
+#endif /* __KERNEL_PROFILING_H__ */
+
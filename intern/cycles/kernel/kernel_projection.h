@@ -74,6 +74,38 @@ ccl_device float3 equirectangular_to_direction(float u, float v)
 		cosf(theta));
 }
 
+/* Omnidirectional stereo (ODS) coordinates <-> Cartesian direction
+ *
+ * Equirectangular panorama with the left eye in the top half of the image
+ * and the right eye in the bottom half. Rays for each eye start on a circle
+ * with the interocular distance as diameter, tangent to the horizontal
+ * viewing direction, so every pixel gets its own eye position. */
+
+ccl_device float3 ods_to_direction(float u, float v)
+{
+	/* map either half to the full equirectangular range */
+	v = (v >= 0.5f)? 2.0f*v - 1.0f: 2.0f*v;
+
+	return equirectangular_to_direction(u, v);
+}
+
+ccl_device float3 ods_to_position(float u, float v, float interocular_offset)
+{
+	float phi = M_PI_F*(1.0f - 2.0f*u);
+	float offset = (v >= 0.5f)? interocular_offset: -interocular_offset;
+
+	return make_float3(-sinf(phi)*offset, cosf(phi)*offset, 0.0f);
+}
+
+ccl_device float2 direction_to_ods(float3 dir)
+{
+	/* no unique position for both eyes, use the left eye */
+	float2 uv = direction_to_equirectangular(dir);
+	uv.y = 0.5f + 0.5f*uv.y;
+
+	return uv;
+}
+
 /* Fisheye <-> Cartesian direction */
 
 ccl_device float2 direction_to_fisheye(float3 dir, float fov)
@@ -181,6 +213,8 @@ ccl_device float3 panorama_to_direction(KernelGlobals *kg, float u, float v)
 	switch(kernel_data.cam.panorama_type) {
 		case PANORAMA_EQUIRECTANGULAR:
 			return equirectangular_to_direction(u, v);
+		case PANORAMA_ODS:
+			return ods_to_direction(u, v);
 		case PANORAMA_FISHEYE_EQUIDISTANT:
 			return fisheye_to_direction(u, v, kernel_data.cam.fisheye_fov);
 		case PANORAMA_FISHEYE_EQUISOLID:
@@ -190,11 +224,21 @@ ccl_device float3 panorama_to_direction(KernelGlobals *kg, float u, float v)
 	}
 }
 
+ccl_device float3 panorama_to_position(KernelGlobals *kg, float u, float v)
+{
+	if(kernel_data.cam.panorama_type == PANORAMA_ODS)
+		return ods_to_position(u, v, kernel_data.cam.interocular_offset);
+	else
+		return make_float3(0.0f, 0.0f, 0.0f);
+}
+
 ccl_device float2 direction_to_panorama(KernelGlobals *kg, float3 dir)
 {
 	switch(kernel_data.cam.panorama_type) {
 		case PANORAMA_EQUIRECTANGULAR:
 			return direction_to_equirectangular(dir);
+		case PANORAMA_ODS:
+			return direction_to_ods(dir);
 		case PANORAMA_FISHEYE_EQUIDISTANT:
 			return direction_to_fisheye(dir, kernel_data.cam.fisheye_fov);
 		case PANORAMA_FISHEYE_EQUISOLID:
@@ -286,5 +286,40 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg, PathState *state, Ray *
 
 #endif
 
+#ifdef __RAY_PACKETS__
+
+/* Shadow function for up to RAY_PACKET_SIZE coherent rays, returning a mask
+ * of the blocked rays. Opaque shadow rays are intersected as one packet, with
+ * transparent shadows or volumes each ray goes through shadow_blocked. */
+
+ccl_device_inline uint shadow_blocked_packet(KernelGlobals *kg, PathState *state, Ray *rays, float3 *shadows, int num)
+{
+	bool use_packet = !kernel_data.integrator.transparent_shadows && scene_intersect_packet_supported(kg);
+
+#ifdef __VOLUME__
+	if(state->volume_stack[0].shader != SHADER_NONE)
+		use_packet = false;
+#endif
+
+	uint blocked = 0;
+
+	if(!use_packet) {
+		for(int i = 0; i < num; i++)
+			if(shadow_blocked(kg, state, &rays[i], &shadows[i]))
+				blocked |= (1 << i);
+
+		return blocked;
+	}
+
+	Intersection isects[RAY_PACKET_SIZE];
+
+	for(int i = 0; i < num; i++)
+		shadows[i] = make_float3(1.0f, 1.0f, 1.0f);
+
+	return scene_intersect_packet(kg, rays, PATH_RAY_SHADOW_OPAQUE, isects, num);
+}
+
+#endif
+
 CCL_NAMESPACE_END
 
@@ -53,6 +53,8 @@ CCL_NAMESPACE_BEGIN
 
 #define VOLUME_STACK_SIZE		16
 
+#define RAY_PACKET_SIZE			4
+
 /* device capabilities */
 #ifdef __KERNEL_CPU__
 #define __KERNEL_SHADING__
@@ -65,6 +67,9 @@ CCL_NAMESPACE_BEGIN
 #define __CMJ__
 #define __VOLUME__
 #define __SHADOW_RECORD_ALL__
+#ifdef __KERNEL_SSE41__
+#define __RAY_PACKETS__
+#endif
 #endif
 
 #ifdef __KERNEL_CUDA__
@@ -268,6 +273,11 @@ enum PathRayFlag {
 	PATH_RAY_LAYER_SHIFT = (32-20)
 };
 
+/* BVH nodes with oriented child bounds are flagged in the visibility of the
+ * first child, using a bit that is never part of the ray visibility */
+
+#define BVH_NODE_UNALIGNED 2048
+
 /* Closure Label */
 
 typedef enum ClosureLabel {
@@ -311,6 +321,7 @@ typedef enum PassType {
 	PASS_SUBSURFACE_INDIRECT = 8388608,
 	PASS_SUBSURFACE_COLOR = 16777216,
 	PASS_LIGHT = 33554432, /* no real pass, used to force use_light_pass */
+	PASS_SAMPLE_COUNT = 67108864, /* number of samples per pixel, for foveated sampling */
 } PassType;
 
 #define PASS_ALL (~0)
@@ -411,7 +422,8 @@ enum CameraType {
 enum PanoramaType {
 	PANORAMA_EQUIRECTANGULAR,
 	PANORAMA_FISHEYE_EQUIDISTANT,
-	PANORAMA_FISHEYE_EQUISOLID
+	PANORAMA_FISHEYE_EQUISOLID,
+	PANORAMA_ODS
 };
 
 /* Differential */
@@ -758,7 +770,7 @@ typedef struct KernelCamera {
 	/* render size */
 	float width, height;
 	int resolution;
-	int pad1;
+	float interocular_offset;
 	int pad2;
 	int pad3;
 
@@ -821,6 +833,22 @@ typedef struct KernelFilm {
 	float mist_start;
 	float mist_inv_depth;
 	float mist_falloff;
+
+	/* foveated sampling */
+	int pass_sample_count;
+	int use_foveated;
+	float foveated_radius;
+	float foveated_min_density;
+
+	float foveated_center_x;
+	float foveated_center_y;
+	int foveated_map_offset;
+	int foveated_map_width;
+
+	int foveated_map_height;
+	int foveated_pad1;
+	int foveated_pad2;
+	int foveated_pad3;
 } KernelFilm;
 
 typedef struct KernelBackground {
@@ -139,6 +139,7 @@ CCL_NAMESPACE_END
 
 /* Nodes */
 
+#include "svm_math_util.h"
 #include "svm_noise.h"
 #include "svm_texture.h"
 
@@ -190,6 +191,8 @@ ccl_device_noinline void svm_eval_nodes(KernelGlobals *kg, ShaderData *sd, Shade
 	while(1) {
 		uint4 node = read_node(kg, &offset);
 
+		PROFILING_SVM_NODE(kg, node.x);
+
 		switch(node.x) {
 			case NODE_SHADER_JUMP: {
 				if(type == SHADER_TYPE_SURFACE) offset = node.y;
@@ -16,11 +16,6 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float invert(float color, float factor)
-{
-	return factor*(1.0f - color) + (1.0f - factor) * color;
-}
-
 ccl_device void svm_node_invert(ShaderData *sd, float *stack, uint in_fac, uint in_color, uint out_color)
 {
 	float factor = stack_load_float(stack, in_fac);
@@ -92,6 +92,9 @@ void BakeManager::set_baking(const bool value)
 
 BakeData *BakeManager::init(const int object, const int tri_offset, const int num_pixels)
 {
+	if(m_bake_data)
+		delete m_bake_data;
+
 	m_bake_data = new BakeData(object, tri_offset, num_pixels);
 	return m_bake_data;
 }
@@ -100,19 +103,30 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 {
 	size_t limit = bake_data->size();
 
-	/* setup input for device task */
+	/* setup input for device task, skipping pixels that are not covered by
+	 * the object so they don't take up space in the tiles */
 	device_vector<uint4> d_input;
 	uint4 *d_input_data = d_input.resize(limit);
 	size_t d_input_size = 0;
+	vector<int> pixel_index;
+
+	pixel_index.reserve(limit);
 
 	for(size_t i = 0; i < limit; i++) {
+		if(!bake_data->is_valid(i))
+			continue;
+
 		d_input_data[d_input_size++] = bake_data->data(i);
+		pixel_index.push_back(i);
 	}
 
-	if(d_input_size == 0)
+	if(d_input_size == 0) {
+		m_is_baking = false;
 		return false;
+	}
+
+	d_input.resize(d_input_size);
 
-	/* run device task */
 	device_vector<float4> d_output;
 	d_output.resize(d_input_size);
 
@@ -123,47 +137,65 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 	device->mem_copy_to(d_input);
 	device->mem_alloc(d_output, MEM_WRITE_ONLY);
 
-	DeviceTask task(DeviceTask::SHADER);
-	task.shader_input = d_input.device_pointer;
-	task.shader_output = d_output.device_pointer;
-	task.shader_eval_type = shader_type;
-	task.shader_x = 0;
-	task.shader_w = d_output.size();
-	task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+	/* run device tasks in tiles, each tile is split further by the device over
+	 * its threads. after every group of tiles the results are written back, so
+	 * progress is reported and cancelling doesn't need to wait for the full
+	 * image to finish */
+	int num_pixels = (int)d_input_size;
+	int num_tiles = (num_pixels + BAKE_TILE_SIZE - 1)/BAKE_TILE_SIZE;
+	int tiles_done = 0;
+	bool cancel = false;
 
-	device->task_add(task);
-	device->task_wait();
+	float4 *offset = (float4*)d_output.data_pointer;
 
-	if(progress.get_cancel()) {
-		device->mem_free(d_input);
-		device->mem_free(d_output);
-		m_is_baking = false;
-		return false;
-	}
+	while(tiles_done < num_tiles) {
+		int tiles_end = min(tiles_done + BAKE_TILES_PER_UPDATE, num_tiles);
+		int start = tiles_done*BAKE_TILE_SIZE;
+		int end = min(tiles_end*BAKE_TILE_SIZE, num_pixels);
 
-	device->mem_copy_from(d_output, 0, 1, d_output.size(), sizeof(float4));
-	device->mem_free(d_input);
-	device->mem_free(d_output);
+		for(int tile = tiles_done; tile < tiles_end; tile++) {
+			int x = tile*BAKE_TILE_SIZE;
 
-	/* read result */
-	int k = 0;
+			DeviceTask task(DeviceTask::SHADER);
+			task.shader_input = d_input.device_pointer;
+			task.shader_output = d_output.device_pointer;
+			task.shader_eval_type = shader_type;
+			task.shader_x = x;
+			task.shader_w = min(BAKE_TILE_SIZE, num_pixels - x);
+			task.get_cancel = function_bind(&Progress::get_cancel, &progress);
 
-	float4 *offset = (float4*)d_output.data_pointer;
+			device->task_add(task);
+		}
 
-	size_t depth = 4;
-	for(size_t i = 0; i < limit; i++) {
-		size_t index = i * depth;
-		float4 out = offset[k++];
+		device->task_wait();
+
+		if(progress.get_cancel()) {
+			cancel = true;
+			break;
+		}
+
+		device->mem_copy_from(d_output, start, 1, end - start, sizeof(float4));
 
-		if(bake_data->is_valid(i)) {
-			for(size_t j=0; j < 4; j++) {
+		/* write result */
+		for(int k = start; k < end; k++) {
+			size_t index = pixel_index[k] * 4;
+			float4 out = offset[k];
+
+			for(size_t j = 0; j < 4; j++)
 				result[index + j] = out[j];
-			}
 		}
+
+		tiles_done = tiles_end;
+
+		progress.set_status("Baking", string_printf("%d%%", tiles_done*100/num_tiles));
+		progress.set_update();
 	}
 
+	device->mem_free(d_input);
+	device->mem_free(d_output);
+
 	m_is_baking = false;
-	return true;
+	return !cancel;
 }
 
 void BakeManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
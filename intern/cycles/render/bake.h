@@ -24,6 +24,11 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* number of pixels in a single device task, and number of tasks that are
+ * run before results are written back and progress is updated */
+#define BAKE_TILE_SIZE 4096
+#define BAKE_TILES_PER_UPDATE 16
+
 class BakeData {
 public:
 	BakeData(const int object, const int tri_offset, const int num_pixels);
@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "buffers.h"
 #include "device.h"
@@ -88,6 +89,7 @@ RenderTile::RenderTile()
 
 	offset = 0;
 	stride = 0;
+	tile_index = 0;
 
 	buffer = 0;
 	rng_state = 0;
@@ -156,9 +158,33 @@ bool RenderBuffers::copy_from_device()
 	return true;
 }
 
+/* scale to apply on top of the 1/sample scale for pixels that have fewer
+ * samples than the image, from foveated sampling */
+static float sample_count_scale(const float *in_count, int index, int sample)
+{
+	if(!in_count)
+		return 1.0f;
+
+	float count = in_count[index];
+	return (count > 0.0f)? sample/count: 0.0f;
+}
+
 bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels)
 {
 	int pass_offset = 0;
+	float *in_count = NULL;
+
+	if(Pass::contains(params.passes, PASS_SAMPLE_COUNT)) {
+		int count_offset = 0;
+
+		foreach(Pass& pass, params.passes) {
+			if(pass.type == PASS_SAMPLE_COUNT)
+				break;
+			count_offset += pass.components;
+		}
+
+		in_count = (float*)buffer.data_pointer + count_offset;
+	}
 
 	foreach(Pass& pass, params.passes) {
 		if(pass.type != type) {
@@ -174,6 +200,9 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 
 		int size = params.width*params.height;
 
+		if(!pass.filter)
+			in_count = NULL;
+
 		if(components == 1) {
 			assert(pass.components == components);
 
@@ -187,13 +216,13 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 			else if(type == PASS_MIST) {
 				for(int i = 0; i < size; i++, in += pass_stride, pixels++) {
 					float f = *in;
-					pixels[0] = clamp(f*scale_exposure, 0.0f, 1.0f);
+					pixels[0] = clamp(f*scale_exposure*sample_count_scale(in_count, i*pass_stride, sample), 0.0f, 1.0f);
 				}
 			}
 			else {
 				for(int i = 0; i < size; i++, in += pass_stride, pixels++) {
 					float f = *in;
-					pixels[0] = f*scale_exposure;
+					pixels[0] = f*scale_exposure*sample_count_scale(in_count, i*pass_stride, sample);
 				}
 			}
 		}
@@ -237,10 +266,11 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 				/* RGB/vector */
 				for(int i = 0; i < size; i++, in += pass_stride, pixels += 3) {
 					float3 f = make_float3(in[0], in[1], in[2]);
+					float pixel_scale = scale_exposure*sample_count_scale(in_count, i*pass_stride, sample);
 
-					pixels[0] = f.x*scale_exposure;
-					pixels[1] = f.y*scale_exposure;
-					pixels[2] = f.z*scale_exposure;
+					pixels[0] = f.x*pixel_scale;
+					pixels[1] = f.y*pixel_scale;
+					pixels[2] = f.z*pixel_scale;
 				}
 			}
 		}
@@ -284,13 +314,15 @@ bool RenderBuffers::get_pass_rect(PassType type, float exposure, int sample, int
 			else {
 				for(int i = 0; i < size; i++, in += pass_stride, pixels += 4) {
 					float4 f = make_float4(in[0], in[1], in[2], in[3]);
+					float count_scale = sample_count_scale(in_count, i*pass_stride, sample);
+					float pixel_scale = scale_exposure*count_scale;
 
-					pixels[0] = f.x*scale_exposure;
-					pixels[1] = f.y*scale_exposure;
-					pixels[2] = f.z*scale_exposure;
+					pixels[0] = f.x*pixel_scale;
+					pixels[1] = f.y*pixel_scale;
+					pixels[2] = f.z*pixel_scale;
 
 					/* clamp since alpha might be > 1.0 due to russian roulette */
-					pixels[3] = clamp(f.w*scale, 0.0f, 1.0f);
+					pixels[3] = clamp(f.w*scale*count_scale, 0.0f, 1.0f);
 				}
 			}
 		}
@@ -418,5 +450,104 @@ device_memory& DisplayBuffer::rgba_data()
 		return rgba_byte;
 }
 
+/* Tile Output */
+
+TileOutput::TileOutput(const string& filename_, int width_, int height_, int2 tile_size_, float exposure_)
+: filename(filename_), width(width_), height(height_), tile_size(tile_size_), exposure(exposure_), out(NULL)
+{
+	/* number of rows the data window extends above the image */
+	int num_tiles_y = (height + tile_size.y - 1)/tile_size.y;
+	offset_y = num_tiles_y*tile_size.y - height;
+}
+
+TileOutput::~TileOutput()
+{
+	close();
+}
+
+bool TileOutput::open()
+{
+	ImageOutput *image_out = ImageOutput::create(filename);
+
+	if(!image_out) {
+		error = "Unsupported output file format";
+		return false;
+	}
+
+	if(!image_out->supports("tiles")) {
+		error = "Output file format does not support tiles";
+		delete image_out;
+		return false;
+	}
+
+	ImageSpec spec(width, height + offset_y, 4, TypeDesc::FLOAT);
+	spec.y = -offset_y;
+	spec.full_x = 0;
+	spec.full_y = 0;
+	spec.full_width = width;
+	spec.full_height = height;
+	spec.tile_width = tile_size.x;
+	spec.tile_height = tile_size.y;
+	spec.attribute("openexr:lineOrder", "randomY");
+
+	if(!image_out->open(filename, spec)) {
+		error = image_out->geterror();
+		delete image_out;
+		return false;
+	}
+
+	out = image_out;
+	return true;
+}
+
+void TileOutput::write(RenderTile& rtile)
+{
+	thread_scoped_lock lock(mutex);
+
+	ImageOutput *image_out = (ImageOutput*)out;
+	RenderBuffers *buffers = rtile.buffers;
+
+	if(!image_out || !buffers->copy_from_device())
+		return;
+
+	BufferParams& params = buffers->params;
+	int w = params.width;
+	int h = params.height;
+
+	vector<float> pixels(w*h*4);
+
+	if(!buffers->get_pass_rect(PASS_COMBINED, exposure, rtile.sample, 4, &pixels[0]))
+		return;
+
+	/* copy into a full size tile, flipping vertically. pixels outside of the
+	 * image in partial tiles at the edges are left black */
+	vector<float> tile(tile_size.x*tile_size.y*4, 0.0f);
+	int tile_y = height - (params.full_y + h);
+	int pad_y = (tile_y + offset_y) % tile_size.y;
+
+	for(int y = 0; y < h; y++) {
+		float *in = &pixels[(h - 1 - y)*w*4];
+		float *tile_out = &tile[(pad_y + y)*tile_size.x*4];
+
+		memcpy(tile_out, in, sizeof(float)*w*4);
+	}
+
+	if(!image_out->write_tile(params.full_x, tile_y - pad_y, 0, TypeDesc::FLOAT, &tile[0]))
+		error = image_out->geterror();
+}
+
+void TileOutput::close()
+{
+	thread_scoped_lock lock(mutex);
+
+	ImageOutput *image_out = (ImageOutput*)out;
+
+	if(image_out) {
+		image_out->close();
+		delete image_out;
+		out = NULL;
+	}
+}
+
 CCL_NAMESPACE_END
 
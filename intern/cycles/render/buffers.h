@@ -81,6 +81,8 @@ public:
 	bool copy_from_device();
 	bool get_pass_rect(PassType type, float exposure, int sample, int components, float *pixels);
 
+	Device *get_device() { return device; }
+
 protected:
 	void device_free();
 
@@ -138,6 +140,7 @@ public:
 	int resolution;
 	int offset;
 	int stride;
+	int tile_index;
 
 	device_ptr buffer;
 	device_ptr rng_state;
@@ -147,6 +150,36 @@ public:
 	RenderTile();
 };
 
+/* Tile Output
+ *
+ * Writes finished render tiles directly to a tiled float image file, so that
+ * in background mode tiles can be freed after rendering and the full image
+ * never has to be kept in memory. Cycles buffers are stored bottom to top,
+ * so the file data window is extended upwards to keep tiles aligned to the
+ * file tile grid after flipping. */
+
+class TileOutput {
+public:
+	TileOutput(const string& filename, int width, int height, int2 tile_size, float exposure);
+	~TileOutput();
+
+	bool open();
+	void write(RenderTile& rtile);
+	void close();
+
+	string error;
+
+protected:
+	string filename;
+	int width, height;
+	int2 tile_size;
+	float exposure;
+	int offset_y;
+
+	thread_mutex mutex;
+	void *out;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __BUFFERS_H__ */
@@ -40,6 +40,7 @@ Camera::Camera()
 
 	type = CAMERA_PERSPECTIVE;
 	panorama_type = PANORAMA_EQUIRECTANGULAR;
+	interocular_distance = 0.065f;
 	fisheye_fov = M_PI_F;
 	fisheye_lens = 10.5f;
 	fov = M_PI_4_F;
@@ -245,6 +246,7 @@ void Camera::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 	kcam->panorama_type = panorama_type;
 	kcam->fisheye_fov = fisheye_fov;
 	kcam->fisheye_lens = fisheye_lens;
+	kcam->interocular_offset = 0.5f*interocular_distance;
 
 	/* sensor size */
 	kcam->sensorwidth = sensorwidth;
@@ -293,7 +295,8 @@ bool Camera::modified(const Camera& cam)
 		(matrix == cam.matrix) &&
 		(panorama_type == cam.panorama_type) &&
 		(fisheye_fov == cam.fisheye_fov) &&
-		(fisheye_lens == cam.fisheye_lens));
+		(fisheye_lens == cam.fisheye_lens) &&
+		(interocular_distance == cam.interocular_distance));
 }
 
 bool Camera::motion_modified(const Camera& cam)
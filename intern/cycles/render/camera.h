@@ -54,6 +54,9 @@ public:
 	float fisheye_fov;
 	float fisheye_lens;
 
+	/* stereo panorama, distance between the eyes */
+	float interocular_distance;
+
 	/* sensor */
 	float sensorwidth;
 	float sensorheight;
@@ -158,6 +158,10 @@ void Pass::add(PassType type, vector<Pass>& passes)
 		case PASS_LIGHT:
 			/* ignores */
 			break;
+		case PASS_SAMPLE_COUNT:
+			pass.components = 1;
+			pass.filter = false;
+			break;
 	}
 
 	passes.push_back(pass);
@@ -277,6 +281,14 @@ Film::Film()
 	use_light_visibility = false;
 	use_sample_clamp = false;
 
+	use_foveated = false;
+	foveated_center = make_float2(0.5f, 0.5f);
+	foveated_radius = 0.1f;
+	foveated_min_density = 0.1f;
+	foveated_map_width = 0;
+	foveated_map_height = 0;
+	foveated_map_offset = TABLE_OFFSET_INVALID;
+
 	need_update = true;
 }
 
@@ -400,6 +412,9 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 			case PASS_LIGHT:
 				kfilm->use_light_pass = 1;
 				break;
+			case PASS_SAMPLE_COUNT:
+				kfilm->pass_sample_count = kfilm->pass_stride;
+				break;
 			case PASS_NONE:
 				break;
 		}
@@ -420,6 +435,28 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 	kfilm->mist_inv_depth = (mist_depth > 0.0f)? 1.0f/mist_depth: 0.0f;
 	kfilm->mist_falloff = mist_falloff;
 
+	/* foveated sampling */
+	kfilm->use_foveated = use_foveated;
+	kfilm->foveated_center_x = foveated_center.x;
+	kfilm->foveated_center_y = foveated_center.y;
+	kfilm->foveated_radius = foveated_radius;
+	kfilm->foveated_min_density = clamp(foveated_min_density, 1e-4f, 1.0f);
+	kfilm->foveated_map_width = 0;
+	kfilm->foveated_map_height = 0;
+
+	if(use_foveated && foveated_map.size() && foveated_map.size() == foveated_map_width*foveated_map_height) {
+		/* clamp so every pixel keeps getting samples */
+		vector<float> table(foveated_map.size());
+
+		for(size_t i = 0; i < foveated_map.size(); i++)
+			table[i] = clamp(foveated_map[i], kfilm->foveated_min_density, 1.0f);
+
+		foveated_map_offset = scene->lookup_tables->add_table(dscene, table);
+		kfilm->foveated_map_offset = (int)foveated_map_offset;
+		kfilm->foveated_map_width = foveated_map_width;
+		kfilm->foveated_map_height = foveated_map_height;
+	}
+
 	need_update = false;
 }
 
@@ -429,6 +466,11 @@ void Film::device_free(Device *device, DeviceScene *dscene, Scene *scene)
 		scene->lookup_tables->remove_table(filter_table_offset);
 		filter_table_offset = TABLE_OFFSET_INVALID;
 	}
+
+	if(foveated_map_offset != TABLE_OFFSET_INVALID) {
+		scene->lookup_tables->remove_table(foveated_map_offset);
+		foveated_map_offset = TABLE_OFFSET_INVALID;
+	}
 }
 
 bool Film::modified(const Film& film)
@@ -441,7 +483,12 @@ bool Film::modified(const Film& film)
 		&& filter_width == film.filter_width
 		&& mist_start == film.mist_start
 		&& mist_depth == film.mist_depth
-		&& mist_falloff == film.mist_falloff);
+		&& mist_falloff == film.mist_falloff
+		&& use_foveated == film.use_foveated
+		&& foveated_center == film.foveated_center
+		&& foveated_radius == film.foveated_radius
+		&& foveated_min_density == film.foveated_min_density
+		&& foveated_map == film.foveated_map);
 }
 
 void Film::tag_passes_update(Scene *scene, const vector<Pass>& passes_)
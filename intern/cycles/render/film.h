@@ -63,6 +63,17 @@ public:
 	bool use_light_visibility;
 	bool use_sample_clamp;
 
+	/* foveated sampling, density map in image space overrides the
+	 * falloff from the center */
+	bool use_foveated;
+	float2 foveated_center;
+	float foveated_radius;
+	float foveated_min_density;
+	vector<float> foveated_map;
+	int foveated_map_width;
+	int foveated_map_height;
+	size_t foveated_map_offset;
+
 	bool need_update;
 
 	Film();
@@ -117,6 +117,41 @@ ShaderOutput *ShaderNode::add_output(const char *name, ShaderSocketType type)
 	return output;
 }
 
+bool ShaderNode::all_inputs_constant()
+{
+	foreach(ShaderInput *input, inputs)
+		if(input->link)
+			return false;
+
+	return true;
+}
+
+bool ShaderNode::inputs_equal(const ShaderNode *other)
+{
+	/* nodes of the same type with the same links and values, for equals() */
+	if(name != other->name || bump != other->bump || special_type != other->special_type)
+		return false;
+	if(inputs.size() != other->inputs.size() || outputs.size() != other->outputs.size())
+		return false;
+
+	for(size_t i = 0; i < inputs.size(); i++) {
+		ShaderInput *input = inputs[i];
+		ShaderInput *other_input = other->inputs[i];
+
+		if(input->link != other_input->link)
+			return false;
+
+		if(!input->link) {
+			if(input->default_value != other_input->default_value)
+				return false;
+			if(input->value != other_input->value || input->value_string != other_input->value_string)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 void ShaderNode::attributes(Shader *shader, AttributeRequestSet *attributes)
 {
 	foreach(ShaderInput *input, inputs) {
@@ -469,11 +504,179 @@ void ShaderGraph::break_cycles(ShaderNode *node, vector<bool>& visited, vector<b
 	on_stack[node->id] = false;
 }
 
+void ShaderGraph::find_topological_order(vector<ShaderNode*>& order)
+{
+	/* order nodes so that each node comes after the nodes linked to its
+	 * inputs. nodes that are part of a cycle, or depend on one, are left out */
+	vector<int> num_links(num_node_ids, 0);
+	size_t next = order.size();
+
+	foreach(ShaderNode *node, nodes) {
+		foreach(ShaderInput *input, node->inputs)
+			if(input->link)
+				num_links[node->id]++;
+
+		if(num_links[node->id] == 0)
+			order.push_back(node);
+	}
+
+	while(next < order.size()) {
+		ShaderNode *node = order[next++];
+
+		foreach(ShaderOutput *output, node->outputs)
+			foreach(ShaderInput *to, output->links)
+				if(--num_links[to->parent->id] == 0)
+					order.push_back(to->parent);
+	}
+}
+
+void ShaderGraph::constant_fold()
+{
+	/* replace outputs that evaluate to the same value for every shading point
+	 * by that value, and outputs that pass through one of their inputs by the
+	 * input. visiting nodes in order makes folding propagate downstream */
+	ShaderNode *output_node = output();
+	vector<ShaderNode*> order;
+	find_topological_order(order);
+
+	foreach(ShaderNode *node, order) {
+		bool folded = false, bypassed = false;
+
+		foreach(ShaderOutput *socket, node->outputs) {
+			/* temp. copy of the output links list, socket->links is modified
+			 * when we disconnect */
+			vector<ShaderInput*> links(socket->links);
+
+			if(links.empty())
+				continue;
+
+			float3 value;
+			ShaderInput *input;
+
+			if(socket->type != SHADER_SOCKET_CLOSURE && node->constant_fold(socket, &value)) {
+				foreach(ShaderInput *to, links) {
+					/* output node inputs stay linked, so that e.g. constant
+					 * displacement is still applied */
+					if(to->parent == output_node)
+						continue;
+
+					disconnect(to);
+					to->value = value;
+					to->default_value = ShaderInput::NONE;
+					folded = true;
+				}
+			}
+			else if((input = node->bypass(socket))) {
+				ShaderOutput *from = input->link;
+
+				assert(input->type == socket->type);
+
+				/* unlinked inputs with a default value get texture coordinates
+				 * and such later on, can't bypass to those */
+				if(!from && input->default_value != ShaderInput::NONE)
+					continue;
+
+				foreach(ShaderInput *to, links) {
+					if(!from && to->parent == output_node)
+						continue;
+
+					disconnect(to);
+
+					if(from) {
+						connect(from, to);
+					}
+					else {
+						to->value = input->value;
+						to->value_string = input->value_string;
+						to->default_value = ShaderInput::NONE;
+					}
+
+					bypassed = true;
+				}
+			}
+		}
+
+		if(folded)
+			stats.nodes_folded++;
+		else if(bypassed)
+			stats.nodes_bypassed++;
+	}
+}
+
+void ShaderGraph::deduplicate_nodes()
+{
+	/* merge nodes that compute the same outputs from the same inputs. merging
+	 * relinks to the first node, so nodes further down that take the merged
+	 * outputs compare equal as well and identical subgraphs collapse */
+	vector<ShaderNode*> order;
+	map<ustring, vector<ShaderNode*> > candidates;
+
+	find_topological_order(order);
+
+	foreach(ShaderNode *node, order) {
+		bool used = false;
+
+		foreach(ShaderOutput *output, node->outputs)
+			if(output->links.size())
+				used = true;
+
+		if(!used)
+			continue;
+
+		vector<ShaderNode*>& same_name = candidates[node->name];
+		ShaderNode *merge = NULL;
+
+		foreach(ShaderNode *other, same_name) {
+			if(node->equals(other)) {
+				merge = other;
+				break;
+			}
+		}
+
+		if(!merge) {
+			same_name.push_back(node);
+			continue;
+		}
+
+		for(size_t i = 0; i < node->outputs.size(); i++) {
+			vector<ShaderInput*> links(node->outputs[i]->links);
+
+			foreach(ShaderInput *to, links) {
+				disconnect(to);
+				connect(merge->outputs[i], to);
+			}
+		}
+
+		stats.nodes_deduplicated++;
+	}
+}
+
+void ShaderGraph::optimize()
+{
+	/* shader specialization, so the SVM or OSL code doesn't spend time on
+	 * nodes that compute constants or that are computed more than once.
+	 * unused nodes left behind are removed in clean() */
+	size_t num_deduplicated = stats.nodes_deduplicated;
+
+	constant_fold();
+	deduplicate_nodes();
+
+	/* merged inputs may allow further simplification, e.g. mixing a color
+	 * with itself */
+	if(stats.nodes_deduplicated != num_deduplicated)
+		constant_fold();
+}
+
 void ShaderGraph::clean()
 {
+	size_t num_nodes = nodes.size();
+
 	/* remove proxy and unnecessary mix nodes */
 	remove_unneeded_nodes();
 
+	/* fold constants and merge identical nodes */
+	optimize();
+
 	/* we do two things here: find cycles and break them, and remove unused
 	 * nodes that don't feed into the output. how cycles are broken is
 	 * undefined, they are invalid input, the important thing is to not crash */
@@ -509,6 +712,8 @@ void ShaderGraph::clean()
 	}
 	
 	nodes = newnodes;
+
+	stats.nodes_removed += num_nodes - nodes.size();
 }
 
 void ShaderGraph::default_inputs(bool do_osl)
@@ -195,6 +195,14 @@ public:
 	virtual bool has_bssrdf_bump() { return false; }
 	virtual bool has_spatial_varying() { return false; }
 
+	/* graph optimization, see ShaderGraph::optimize(). constant_fold returns
+	 * true if the output has the same value for every shading point, bypass
+	 * returns the input that the output passes through unmodified, and equals
+	 * is true if the node computes the same outputs as the other node */
+	virtual bool constant_fold(ShaderOutput *socket, float3 *optimized_value) { return false; }
+	virtual ShaderInput *bypass(ShaderOutput *socket) { return NULL; }
+	virtual bool equals(const ShaderNode *other) { return false; }
+
 	vector<ShaderInput*> inputs;
 	vector<ShaderOutput*> outputs;
 
@@ -203,6 +211,10 @@ public:
 	ShaderBump bump; /* for bump mapping utility */
 	
 	ShaderNodeSpecialType special_type;	/* special node type */
+
+protected:
+	bool all_inputs_constant();
+	bool inputs_equal(const ShaderNode *other);
 };
 
 
@@ -224,6 +236,30 @@ public:
 	virtual void compile(SVMCompiler& compiler); \
 	virtual void compile(OSLCompiler& compiler); \
 
+/* Graph Statistics
+ *
+ * Number of nodes removed or simplified when finalizing graphs. */
+
+struct ShaderGraphStats {
+	ShaderGraphStats()
+	: nodes_folded(0), nodes_bypassed(0), nodes_deduplicated(0), nodes_removed(0)
+	{
+	}
+
+	void add(const ShaderGraphStats& other)
+	{
+		nodes_folded += other.nodes_folded;
+		nodes_bypassed += other.nodes_bypassed;
+		nodes_deduplicated += other.nodes_deduplicated;
+		nodes_removed += other.nodes_removed;
+	}
+
+	size_t nodes_folded;		/* nodes with outputs replaced by a constant */
+	size_t nodes_bypassed;		/* nodes with outputs replaced by an input */
+	size_t nodes_deduplicated;	/* nodes merged with an identical node */
+	size_t nodes_removed;		/* total nodes removed, including unused ones */
+};
+
 /* Graph
  *
  * Shader graph of nodes. Also does graph manipulations for default inputs,
@@ -234,6 +270,7 @@ public:
 	list<ShaderNode*> nodes;
 	size_t num_node_ids;
 	bool finalized;
+	ShaderGraphStats stats;
 
 	ShaderGraph();
 	~ShaderGraph();
@@ -255,8 +292,12 @@ protected:
 	void find_dependencies(set<ShaderNode*>& dependencies, ShaderInput *input);
 	void copy_nodes(set<ShaderNode*>& nodes, map<ShaderNode*, ShaderNode*>& nnodemap);
 
+	void find_topological_order(vector<ShaderNode*>& order);
 	void break_cycles(ShaderNode *node, vector<bool>& visited, vector<bool>& on_stack);
 	void clean();
+	void optimize();
+	void constant_fold();
+	void deduplicate_nodes();
 	void bump_from_displacement();
 	void refine_bump_nodes();
 	void default_inputs(bool do_osl);
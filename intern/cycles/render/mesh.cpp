@@ -68,6 +68,33 @@ void Mesh::Curve::bounds_grow(const int k, const float4 *curve_keys, BoundBox& b
 	bounds.grow(upper, mr);
 }
 
+/* bounds in a rotated space, the curve basis is affine so the extrema can be
+ * found the same way after transforming the control points */
+void Mesh::Curve::bounds_grow(const int k, const float4 *curve_keys, const Transform& aligned_space, BoundBox& bounds) const
+{
+	float3 P[4];
+
+	P[0] = float4_to_float3(curve_keys[max(first_key + k - 1,first_key)]);
+	P[1] = float4_to_float3(curve_keys[first_key + k]);
+	P[2] = float4_to_float3(curve_keys[first_key + k + 1]);
+	P[3] = float4_to_float3(curve_keys[min(first_key + k + 2, first_key + num_keys - 1)]);
+
+	for(int i = 0; i < 4; i++)
+		P[i] = transform_point(&aligned_space, P[i]);
+
+	float3 lower;
+	float3 upper;
+
+	curvebounds(&lower.x, &upper.x, P, 0);
+	curvebounds(&lower.y, &upper.y, P, 1);
+	curvebounds(&lower.z, &upper.z, P, 2);
+
+	float mr = max(curve_keys[first_key + k].w, curve_keys[first_key + k + 1].w);
+
+	bounds.grow(lower, mr);
+	bounds.grow(upper, mr);
+}
+
 /* Mesh */
 
 Mesh::Mesh()
@@ -520,6 +547,8 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 			BVHParams bparams;
 			bparams.use_cache = params->use_bvh_cache;
 			bparams.use_spatial_split = params->use_bvh_spatial_split;
+			bparams.use_unaligned_nodes = params->use_bvh_unaligned_nodes;
+			bparams.curve_merge_segments = params->bvh_curve_merge_segments;
 			bparams.use_qbvh = params->use_qbvh;
 
 			delete bvh;
@@ -978,6 +1007,8 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	bparams.top_level = true;
 	bparams.use_qbvh = scene->params.use_qbvh;
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
+	bparams.use_unaligned_nodes = scene->params.use_bvh_unaligned_nodes && device->info.advanced_shading;
+	bparams.curve_merge_segments = scene->params.bvh_curve_merge_segments;
 	bparams.use_cache = scene->params.use_bvh_cache;
 
 	delete bvh;
@@ -1079,11 +1110,15 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 		if(mesh->need_update && !mesh->transform_applied)
 			num_bvh++;
 
+	/* unaligned nodes are only traversed by kernels with hair support */
+	SceneParams bvh_params = scene->params;
+	bvh_params.use_bvh_unaligned_nodes = scene->params.use_bvh_unaligned_nodes && device->info.advanced_shading;
+
 	TaskPool pool;
 
 	foreach(Mesh *mesh, scene->meshes) {
 		if(mesh->need_update) {
-			pool.push(function_bind(&Mesh::compute_bvh, mesh, &scene->params, &progress, i, num_bvh));
+			pool.push(function_bind(&Mesh::compute_bvh, mesh, &bvh_params, &progress, i, num_bvh));
 			i++;
 		}
 	}
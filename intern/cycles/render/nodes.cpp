@@ -19,7 +19,9 @@
 #include "svm.h"
 #include "osl.h"
 #include "sky_model.h"
+#include "svm_math_util.h"
 
+#include "util_color.h"
 #include "util_foreach.h"
 #include "util_transform.h"
 
@@ -1444,6 +1446,37 @@ void ConvertNode::compile(OSLCompiler& compiler)
 		assert(0);
 }
 
+bool ConvertNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *in = inputs[0];
+	float3 value = in->value;
+
+	/* int and string sockets store their values differently, leave those */
+	if(in->link || from == SHADER_SOCKET_INT || to == SHADER_SOCKET_INT ||
+	   from == SHADER_SOCKET_STRING || to == SHADER_SOCKET_STRING)
+		return false;
+
+	if(from == SHADER_SOCKET_FLOAT)
+		*optimized_value = make_float3(value.x, value.x, value.x);
+	else if(to == SHADER_SOCKET_FLOAT && from == SHADER_SOCKET_COLOR)
+		*optimized_value = make_float3(linear_rgb_to_gray(value), 0.0f, 0.0f);
+	else if(to == SHADER_SOCKET_FLOAT)
+		*optimized_value = make_float3((value.x + value.y + value.z)*(1.0f/3.0f), 0.0f, 0.0f);
+	else
+		*optimized_value = value;
+
+	return true;
+}
+
+bool ConvertNode::equals(const ShaderNode *other)
+{
+	if(!inputs_equal(other))
+		return false;
+
+	const ConvertNode *convert_node = static_cast<const ConvertNode*>(other);
+	return from == convert_node->from && to == convert_node->to;
+}
+
 /* Proxy */
 
 ProxyNode::ProxyNode(ShaderSocketType type_)
@@ -2332,6 +2365,12 @@ void TextureCoordinateNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_texture_coordinate");
 }
 
+bool TextureCoordinateNode::equals(const ShaderNode *other)
+{
+	return inputs_equal(other) &&
+	       from_dupli == static_cast<const TextureCoordinateNode*>(other)->from_dupli;
+}
+
 UVMapNode::UVMapNode()
 : ShaderNode("uvmap")
 {
@@ -2782,6 +2821,12 @@ void ValueNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_value");
 }
 
+bool ValueNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	*optimized_value = make_float3(value, 0.0f, 0.0f);
+	return true;
+}
+
 /* Color */
 
 ColorNode::ColorNode()
@@ -2810,6 +2855,12 @@ void ColorNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_value");
 }
 
+bool ColorNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	*optimized_value = value;
+	return true;
+}
+
 /* Add Closure */
 
 AddClosureNode::AddClosureNode()
@@ -2853,6 +2904,21 @@ void MixClosureNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_mix_closure");
 }
 
+ShaderInput *MixClosureNode::bypass(ShaderOutput *socket)
+{
+	ShaderInput *fac_in = input("Fac");
+
+	/* the factor is clamped, only one closure is used outside 0..1 */
+	if(fac_in->link)
+		return NULL;
+	else if(fac_in->value.x <= 0.0f)
+		return input("Closure1");
+	else if(fac_in->value.x >= 1.0f)
+		return input("Closure2");
+
+	return NULL;
+}
+
 /* Mix Closure */
 
 MixClosureWeightNode::MixClosureWeightNode()
@@ -2914,6 +2980,28 @@ void InvertNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_invert");
 }
 
+bool InvertNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	if(!all_inputs_constant())
+		return false;
+
+	float fac = input("Fac")->value.x;
+	float3 color = input("Color")->value;
+
+	*optimized_value = make_float3(invert(color.x, fac), invert(color.y, fac), invert(color.z, fac));
+	return true;
+}
+
+ShaderInput *InvertNode::bypass(ShaderOutput *socket)
+{
+	ShaderInput *fac_in = input("Fac");
+
+	if(!fac_in->link && fac_in->value.x == 0.0f)
+		return input("Color");
+
+	return NULL;
+}
+
 /* Mix */
 
 MixNode::MixNode()
@@ -2985,6 +3073,76 @@ void MixNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_mix");
 }
 
+bool MixNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	if(!all_inputs_constant())
+		return false;
+
+	float fac = input("Fac")->value.x;
+	float3 color1 = input("Color1")->value;
+	float3 color2 = input("Color2")->value;
+	float3 result = svm_mix((NodeMix)type_enum[type], fac, color1, color2);
+
+	if(use_clamp)
+		result = svm_mix_clamp(result);
+
+	*optimized_value = result;
+	return true;
+}
+
+ShaderInput *MixNode::bypass(ShaderOutput *socket)
+{
+	ShaderInput *fac_in = input("Fac");
+	ShaderInput *color1_in = input("Color1");
+	ShaderInput *color2_in = input("Color2");
+	NodeMix mix_type = (NodeMix)type_enum[type];
+
+	if(use_clamp)
+		return NULL;
+
+	/* mixing a color with itself */
+	if(mix_type == NODE_MIX_BLEND && color1_in->link && color1_in->link == color2_in->link)
+		return color1_in;
+
+	if(fac_in->link)
+		return NULL;
+
+	float fac = clamp(fac_in->value.x, 0.0f, 1.0f);
+
+	/* these blend types return the first color unmodified for factor 0 */
+	if(fac == 0.0f) {
+		switch(mix_type) {
+			case NODE_MIX_BLEND:
+			case NODE_MIX_ADD:
+			case NODE_MIX_MUL:
+			case NODE_MIX_SUB:
+			case NODE_MIX_DIV:
+			case NODE_MIX_DIFF:
+			case NODE_MIX_DARK:
+			case NODE_MIX_HUE:
+			case NODE_MIX_COLOR:
+			case NODE_MIX_SOFT:
+			case NODE_MIX_LINEAR:
+				return color1_in;
+			default:
+				break;
+		}
+	}
+	else if(fac == 1.0f && mix_type == NODE_MIX_BLEND)
+		return color2_in;
+
+	return NULL;
+}
+
+bool MixNode::equals(const ShaderNode *other)
+{
+	if(!inputs_equal(other))
+		return false;
+
+	const MixNode *mix_node = static_cast<const MixNode*>(other);
+	return type == mix_node->type && use_clamp == mix_node->use_clamp;
+}
+
 /* Combine RGB */
 CombineRGBNode::CombineRGBNode()
 : ShaderNode("combine_rgb")
@@ -3019,6 +3177,15 @@ void CombineRGBNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_combine_rgb");
 }
 
+bool CombineRGBNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	if(!all_inputs_constant())
+		return false;
+
+	*optimized_value = make_float3(input("R")->value.x, input("G")->value.x, input("B")->value.x);
+	return true;
+}
+
 /* Combine HSV */
 CombineHSVNode::CombineHSVNode()
 : ShaderNode("combine_hsv")
@@ -3143,6 +3310,23 @@ void SeparateRGBNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_separate_rgb");
 }
 
+bool SeparateRGBNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	if(!all_inputs_constant())
+		return false;
+
+	float3 color = input("Image")->value;
+
+	for(int channel = 0; channel < 3; channel++) {
+		if(outputs[channel] == socket) {
+			*optimized_value = make_float3(color[channel], 0.0f, 0.0f);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /* Separate HSV */
 SeparateHSVNode::SeparateHSVNode()
 : ShaderNode("separate_hsv")
@@ -3574,6 +3758,76 @@ void MathNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_math");
 }
 
+bool MathNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	ShaderInput *value1_in = input("Value1");
+	ShaderInput *value2_in = input("Value2");
+	NodeMath math_type = (NodeMath)type_enum[type];
+	float value;
+
+	if(!value1_in->link && !value2_in->link) {
+		value = svm_math(math_type, value1_in->value.x, value2_in->value.x);
+
+		if(use_clamp)
+			value = clamp(value, 0.0f, 1.0f);
+	}
+	else if(math_type == NODE_MATH_MULTIPLY &&
+	        ((!value1_in->link && value1_in->value.x == 0.0f) ||
+	         (!value2_in->link && value2_in->value.x == 0.0f)))
+	{
+		/* multiply by zero */
+		value = 0.0f;
+	}
+	else
+		return false;
+
+	*optimized_value = make_float3(value, 0.0f, 0.0f);
+	return true;
+}
+
+ShaderInput *MathNode::bypass(ShaderOutput *socket)
+{
+	ShaderInput *value1_in = input("Value1");
+	ShaderInput *value2_in = input("Value2");
+	bool value1_constant = !value1_in->link;
+	bool value2_constant = !value2_in->link;
+	float value1 = value1_in->value.x;
+	float value2 = value2_in->value.x;
+
+	if(use_clamp)
+		return NULL;
+
+	switch((NodeMath)type_enum[type]) {
+		case NODE_MATH_ADD:
+			if(value1_constant && value1 == 0.0f) return value2_in;
+			if(value2_constant && value2 == 0.0f) return value1_in;
+			break;
+		case NODE_MATH_SUBTRACT:
+			if(value2_constant && value2 == 0.0f) return value1_in;
+			break;
+		case NODE_MATH_MULTIPLY:
+			if(value1_constant && value1 == 1.0f) return value2_in;
+			if(value2_constant && value2 == 1.0f) return value1_in;
+			break;
+		case NODE_MATH_DIVIDE:
+			if(value2_constant && value2 == 1.0f) return value1_in;
+			break;
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
+bool MathNode::equals(const ShaderNode *other)
+{
+	if(!inputs_equal(other))
+		return false;
+
+	const MathNode *math_node = static_cast<const MathNode*>(other);
+	return type == math_node->type && use_clamp == math_node->use_clamp;
+}
+
 /* VectorMath */
 
 VectorMathNode::VectorMathNode()
@@ -3625,6 +3879,30 @@ void VectorMathNode::compile(OSLCompiler& compiler)
 	compiler.add(this, "node_vector_math");
 }
 
+bool VectorMathNode::constant_fold(ShaderOutput *socket, float3 *optimized_value)
+{
+	if(!all_inputs_constant())
+		return false;
+
+	float value;
+	float3 vector;
+
+	svm_vector_math(&value, &vector, (NodeVectorMath)type_enum[type],
+		input("Vector1")->value, input("Vector2")->value);
+
+	if(socket == output("Value"))
+		*optimized_value = make_float3(value, 0.0f, 0.0f);
+	else
+		*optimized_value = vector;
+
+	return true;
+}
+
+bool VectorMathNode::equals(const ShaderNode *other)
+{
+	return inputs_equal(other) && type == static_cast<const VectorMathNode*>(other)->type;
+}
+
 /* VectorTransform */
 
 VectorTransformNode::VectorTransformNode()
@@ -193,6 +193,9 @@ public:
 	ConvertNode(ShaderSocketType from, ShaderSocketType to, bool autoconvert = false);
 	SHADER_NODE_BASE_CLASS(ConvertNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other);
+
 	ShaderSocketType from, to;
 };
 
@@ -346,6 +349,7 @@ public:
 	SHADER_NODE_CLASS(GeometryNode)
 	void attributes(Shader *shader, AttributeRequestSet *attributes);
 	bool has_spatial_varying() { return true; }
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class TextureCoordinateNode : public ShaderNode {
@@ -353,6 +357,7 @@ public:
 	SHADER_NODE_CLASS(TextureCoordinateNode)
 	void attributes(Shader *shader, AttributeRequestSet *attributes);
 	bool has_spatial_varying() { return true; }
+	bool equals(const ShaderNode *other);
 	
 	bool from_dupli;
 };
@@ -370,6 +375,7 @@ public:
 class LightPathNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(LightPathNode)
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class LightFalloffNode : public ShaderNode {
@@ -401,6 +407,8 @@ class ValueNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(ValueNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+
 	float value;
 };
 
@@ -408,6 +416,8 @@ class ColorNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(ColorNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+
 	float3 value;
 };
 
@@ -419,6 +429,8 @@ public:
 class MixClosureNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(MixClosureNode)
+
+	ShaderInput *bypass(ShaderOutput *socket);
 };
 
 class MixClosureWeightNode : public ShaderNode {
@@ -429,12 +441,20 @@ public:
 class InvertNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(InvertNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	ShaderInput *bypass(ShaderOutput *socket);
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class MixNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(MixNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	ShaderInput *bypass(ShaderOutput *socket);
+	bool equals(const ShaderNode *other);
+
 	bool use_clamp;
 
 	ustring type;
@@ -444,36 +464,52 @@ public:
 class CombineRGBNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(CombineRGBNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class CombineHSVNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(CombineHSVNode)
+
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class GammaNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(GammaNode)
+
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class BrightContrastNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(BrightContrastNode)
+
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class SeparateRGBNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(SeparateRGBNode)
+
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class SeparateHSVNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(SeparateHSVNode)
+
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class HSVNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(HSVNode)
+
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class AttributeNode : public ShaderNode {
@@ -495,12 +531,14 @@ class FresnelNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(FresnelNode)
 	bool has_spatial_varying() { return true; }
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class LayerWeightNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(LayerWeightNode)
 	bool has_spatial_varying() { return true; }
+	bool equals(const ShaderNode *other) { return inputs_equal(other); }
 };
 
 class WireframeNode : public ShaderNode {
@@ -527,6 +565,10 @@ class MathNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(MathNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	ShaderInput *bypass(ShaderOutput *socket);
+	bool equals(const ShaderNode *other);
+
 	bool use_clamp;
 
 	ustring type;
@@ -544,6 +586,9 @@ class VectorMathNode : public ShaderNode {
 public:
 	SHADER_NODE_CLASS(VectorMathNode)
 
+	bool constant_fold(ShaderOutput *socket, float3 *optimized_value);
+	bool equals(const ShaderNode *other);
+
 	ustring type;
 	static ShaderEnum type_enum;
 };
@@ -124,6 +124,8 @@ public:
 	enum BVHType { BVH_DYNAMIC, BVH_STATIC } bvh_type;
 	bool use_bvh_cache;
 	bool use_bvh_spatial_split;
+	bool use_bvh_unaligned_nodes;
+	int bvh_curve_merge_segments;
 	bool use_qbvh;
 	bool persistent_data;
 
@@ -133,6 +135,8 @@ public:
 		bvh_type = BVH_DYNAMIC;
 		use_bvh_cache = false;
 		use_bvh_spatial_split = false;
+		use_bvh_unaligned_nodes = true;
+		bvh_curve_merge_segments = 1;
 #ifdef __QBVH__
 		use_qbvh = true;
 #else
@@ -146,6 +150,8 @@ public:
 		&& bvh_type == params.bvh_type
 		&& use_bvh_cache == params.use_bvh_cache
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
+		&& use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes
+		&& bvh_curve_merge_segments == params.bvh_curve_merge_segments
 		&& use_qbvh == params.use_qbvh
 		&& persistent_data == params.persistent_data); }
 };
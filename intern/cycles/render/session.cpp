@@ -20,6 +20,7 @@
 #include "buffers.h"
 #include "camera.h"
 #include "device.h"
+#include "film.h"
 #include "integrator.h"
 #include "scene.h"
 #include "session.h"
@@ -51,6 +52,10 @@ Session::Session(const SessionParams& params_)
 
 	device = Device::create(params.device, stats, params.background);
 
+	/* render tiles around the gaze center first */
+	if(params.foveated)
+		tile_manager.set_tile_order_center(params.foveated_center);
+
 	if(params.background && params.output_path.empty()) {
 		buffers = NULL;
 		display = NULL;
@@ -370,6 +375,7 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	rtile.start_sample = tile_manager.state.sample;
 	rtile.num_samples = tile_manager.state.num_samples;
 	rtile.resolution = tile_manager.state.resolution_divider;
+	rtile.tile_index = tile.index;
 
 	tile_lock.unlock();
 
@@ -453,6 +459,8 @@ void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
+	tile_manager.finish_tile(rtile.tile_index);
+
 	if(write_render_tile_cb) {
 		if(params.progressive_refine == false) {
 			/* todo: optimize this by making it thread safe and removing lock */
@@ -619,10 +627,20 @@ void Session::run()
 		/* reset number of rendered samples */
 		progress.reset_sample();
 
+		if(params.profiling) {
+			stats.profiler.reset();
+			stats.profiler.start();
+		}
+
 		if(device_use_gl)
 			run_gpu();
 		else
 			run_cpu();
+
+		if(params.profiling) {
+			stats.profiler.stop();
+			progress.set_profiling(stats.profiler.summary());
+		}
 	}
 
 	/* progress update */
@@ -642,15 +660,22 @@ bool Session::draw(BufferParams& buffer_params, DeviceDrawParams &draw_params)
 
 void Session::reset_(BufferParams& buffer_params, int samples)
 {
+	/* foveated sampling stores the number of samples per pixel in an extra
+	 * pass, which only the render buffers need to know about */
+	BufferParams render_params = buffer_params;
+
+	if(params.foveated)
+		Pass::add(PASS_SAMPLE_COUNT, render_params.passes);
+
 	if(buffers) {
-		if(buffer_params.modified(buffers->params)) {
+		if(render_params.modified(buffers->params)) {
 			gpu_draw_ready = false;
-			buffers->reset(device, buffer_params);
+			buffers->reset(device, render_params);
 			display->reset(device, buffer_params);
 		}
 	}
 
-	tile_manager.reset(buffer_params, samples);
+	tile_manager.reset(render_params, samples);
 
 	start_time = time_dt();
 	preview_time = 0.0;
@@ -750,6 +775,31 @@ void Session::update_scene()
 		}
 	}
 
+	/* foveated sampling settings, and the pass with the number of samples per
+	 * pixel that was added to the buffers in reset_() */
+	Film *film = scene->film;
+
+	if(params.foveated && !Pass::contains(film->passes, PASS_SAMPLE_COUNT)) {
+		Pass::add(PASS_SAMPLE_COUNT, film->passes);
+		film->tag_update(scene);
+	}
+
+	if(film->use_foveated != params.foveated ||
+	   film->foveated_center != params.foveated_center ||
+	   film->foveated_radius != params.foveated_radius ||
+	   film->foveated_min_density != params.foveated_min_density ||
+	   film->foveated_map != params.foveated_map)
+	{
+		film->use_foveated = params.foveated;
+		film->foveated_center = params.foveated_center;
+		film->foveated_radius = params.foveated_radius;
+		film->foveated_min_density = params.foveated_min_density;
+		film->foveated_map = params.foveated_map;
+		film->foveated_map_width = params.foveated_map_size.x;
+		film->foveated_map_height = params.foveated_map_size.y;
+		film->tag_update(scene);
+	}
+
 	/* update scene */
 	if(scene->need_update()) {
 		progress.set_status("Updating Scene");
@@ -811,6 +861,9 @@ void Session::update_status_time(bool show_pause, bool show_done)
 		substatus.clear();
 	}
 
+	if(params.profiling)
+		progress.set_profiling(stats.profiler.summary());
+
 	progress.set_status(status, substatus);
 
 	/* update timing */
@@ -903,9 +956,10 @@ bool Session::update_progressive_refine(bool cancel)
 	return write;
 }
 
-void Session::device_free()
+void Session::device_free(bool free_scene)
 {
-	scene->device_free();
+	if(free_scene)
+		scene->device_free();
 
 	foreach(RenderBuffers *buffers, tile_buffers)
 		delete buffers;
@@ -54,6 +54,18 @@ public:
 	int threads;
 
 	bool display_buffer_linear;
+	bool profiling;
+
+	/* foveated sampling, with fewer samples away from the gaze center. the
+	 * center is in 0..1 image coordinates, the radius of full density is
+	 * relative to the image width, or to 180 degrees for panoramas. an
+	 * optional density map covers the full image, bottom row first */
+	bool foveated;
+	float2 foveated_center;
+	float foveated_radius;
+	float foveated_min_density;
+	vector<float> foveated_map;
+	int2 foveated_map_size;
 
 	double cancel_timeout;
 	double reset_timeout;
@@ -75,6 +87,13 @@ public:
 		threads = 0;
 
 		display_buffer_linear = false;
+		profiling = false;
+
+		foveated = false;
+		foveated_center = make_float2(0.5f, 0.5f);
+		foveated_radius = 0.1f;
+		foveated_min_density = 0.1f;
+		foveated_map_size = make_int2(0, 0);
 
 		cancel_timeout = 0.1;
 		reset_timeout = 0.1;
@@ -97,6 +116,13 @@ public:
 		&& start_resolution == params.start_resolution
 		&& threads == params.threads
 		&& display_buffer_linear == params.display_buffer_linear
+		&& profiling == params.profiling
+		&& foveated == params.foveated
+		&& foveated_center == params.foveated_center
+		&& foveated_radius == params.foveated_radius
+		&& foveated_min_density == params.foveated_min_density
+		&& foveated_map == params.foveated_map
+		&& foveated_map_size == params.foveated_map_size
 		&& cancel_timeout == params.cancel_timeout
 		&& reset_timeout == params.reset_timeout
 		&& text_timeout == params.text_timeout
@@ -137,7 +163,7 @@ public:
 	void set_pause(bool pause);
 
 	void update_scene();
-	void device_free();
+	void device_free(bool free_scene = true);
 protected:
 	struct DelayedReset {
 		thread_mutex mutex;
@@ -221,6 +221,8 @@ void ShaderManager::device_update_common(Device *device, DeviceScene *dscene, Sc
 	device->tex_free(dscene->shader_flag);
 	dscene->shader_flag.clear();
 
+	graph_stats = ShaderGraphStats();
+
 	if(scene->shaders.size() == 0)
 		return;
 
@@ -233,6 +235,11 @@ void ShaderManager::device_update_common(Device *device, DeviceScene *dscene, Sc
 	foreach(Shader *shader, scene->shaders) {
 		uint flag = 0;
 
+		if(shader->graph)
+			graph_stats.add(shader->graph->stats);
+		if(shader->graph_bump)
+			graph_stats.add(shader->graph_bump->stats);
+
 		if(shader->use_mis)
 			flag |= SD_USE_MIS;
 		if(shader->has_surface_transparent && shader->use_transparent_shadow)
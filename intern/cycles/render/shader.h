@@ -18,6 +18,7 @@
 #define __SHADER_H__
 
 #include "attribute.h"
+#include "graph.h"
 #include "kernel_types.h"
 
 #include "util_map.h"
@@ -136,6 +137,9 @@ public:
 	 * have any shader assigned explicitly */
 	static void add_default(Scene *scene);
 
+	/* nodes removed from the shader graphs of the scene, see ShaderGraph::optimize() */
+	ShaderGraphStats graph_stats;
+
 protected:
 	ShaderManager();
 
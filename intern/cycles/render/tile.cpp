@@ -17,6 +17,7 @@
 #include "tile.h"
 
 #include "util_algorithm.h"
+#include "util_time.h"
 #include "util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -27,6 +28,7 @@ TileManager::TileManager(bool progressive_, int num_samples_, int2 tile_size_, i
 	progressive = progressive_;
 	tile_size = tile_size_;
 	tile_order = tile_order_;
+	tile_order_center = make_float2(0.5f, 0.5f);
 	start_resolution = start_resolution_;
 	num_devices = num_devices_;
 	preserve_tile_device = preserve_tile_device_;
@@ -65,6 +67,9 @@ void TileManager::reset(BufferParams& params_, int num_samples_)
 	state.num_samples = 0;
 	state.resolution_divider = divider;
 	state.tiles.clear();
+
+	device_load.clear();
+	tile_load.clear();
 }
 
 void TileManager::set_samples(int num_samples_)
@@ -155,6 +160,10 @@ void TileManager::set_tiles()
 
 	state.num_tiles = state.tiles.size();
 
+	TileLoad unassigned = {-1, 0.0};
+	tile_load.clear();
+	tile_load.resize(state.num_tiles, unassigned);
+
 	state.buffer.width = image_w;
 	state.buffer.height = image_h;
 
@@ -189,7 +198,7 @@ list<Tile>::iterator TileManager::next_background_tile(int device, TileOrder til
 	int64_t cordy = max(1, params.height/resolution);
 	int64_t mindist = INT_MAX;
 	
-	int64_t centx = cordx / 2, centy = cordy / 2;
+	int64_t centx = (int64_t)(cordx * tile_order_center.x), centy = (int64_t)(cordy * tile_order_center.y);
 
 	for(iter = state.tiles.begin(); iter != state.tiles.end(); iter++) {
 		if(iter->device == logical_device && iter->rendering == false) {
@@ -230,9 +239,59 @@ list<Tile>::iterator TileManager::next_background_tile(int device, TileOrder til
 	return best;
 }
 
+TileManager::DeviceLoad& TileManager::get_device_load(int device)
+{
+	/* network devices may be added at runtime, so the number of devices is not known */
+	if(device >= (int)device_load.size())
+		device_load.resize(device + 1);
+
+	return device_load[device];
+}
+
+/* pixel samples per second finished by the device so far */
+double TileManager::device_throughput(int device)
+{
+	DeviceLoad& load = get_device_load(device);
+
+	if(load.work_done == 0.0)
+		return 0.0;
+
+	double elapsed = time_dt() - load.start_time;
+	return (elapsed > 0.0)? load.work_done/elapsed: 0.0;
+}
+
+bool TileManager::leave_tile_to_faster_device(int device)
+{
+	/* a device must be this much faster for another to leave tiles to it */
+	const double speedup = 2.0;
+
+	if(!background || preserve_tile_device || device < 0)
+		return false;
+
+	double throughput = device_throughput(device);
+
+	if(throughput == 0.0)
+		return false;
+
+	/* count how many tiles faster devices can render at the same time */
+	int faster_capacity = 0;
+
+	for(int i = 0; i < (int)device_load.size(); i++)
+		if(i != device && device_throughput(i) > throughput*speedup)
+			faster_capacity += device_load[i].max_rendering;
+
+	/* only near the end, when the faster devices can take all remaining tiles */
+	int num_remaining = state.num_tiles - state.num_rendered_tiles;
+
+	return (num_remaining <= faster_capacity);
+}
+
 bool TileManager::next_tile(Tile& tile, int device)
 {
 	list<Tile>::iterator tile_it;
+
+	if(leave_tile_to_faster_device(device))
+		return false;
 	
 	if (background)
 		tile_it = next_background_tile(device, tile_order);
@@ -244,12 +303,38 @@ bool TileManager::next_tile(Tile& tile, int device)
 		tile = *tile_it;
 		state.num_rendered_tiles++;
 
+		if(device >= 0) {
+			DeviceLoad& load = get_device_load(device);
+
+			if(load.start_time == 0.0)
+				load.start_time = time_dt();
+
+			load.num_rendering++;
+			load.max_rendering = max(load.max_rendering, load.num_rendering);
+
+			tile_load[tile.index].device = device;
+			tile_load[tile.index].work = (double)tile.w*tile.h*state.num_samples;
+		}
+
 		return true;
 	}
 
 	return false;
 }
 
+void TileManager::finish_tile(int index)
+{
+	if(index < 0 || index >= (int)tile_load.size() || tile_load[index].device == -1)
+		return;
+
+	DeviceLoad& load = get_device_load(tile_load[index].device);
+
+	load.work_done += tile_load[index].work;
+	load.num_rendering--;
+
+	tile_load[index].device = -1;
+}
+
 bool TileManager::done()
 {
 	return (state.sample+state.num_samples >= num_samples && state.resolution_divider == 1);
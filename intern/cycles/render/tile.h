@@ -21,6 +21,7 @@
 
 #include "buffers.h"
 #include "util_list.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -77,9 +78,12 @@ public:
 	void set_samples(int num_samples);
 	bool next();
 	bool next_tile(Tile& tile, int device = 0);
+	void finish_tile(int index);
 	bool done();
 	
 	void set_tile_order(TileOrder tile_order_) { tile_order = tile_order_; }
+	/* center for TILE_CENTER order, in 0..1 image coordinates */
+	void set_tile_order_center(float2 center) { tile_order_center = center; }
 protected:
 
 	void set_tiles();
@@ -87,6 +91,7 @@ protected:
 	bool progressive;
 	int2 tile_size;
 	TileOrder tile_order;
+	float2 tile_order_center;
 	int start_resolution;
 	int num_devices;
 
@@ -120,6 +125,31 @@ protected:
 
 	/* returns first unhandled tile for viewport render */
 	list<Tile>::iterator next_viewport_tile(int device);
+
+	/* load balancing between devices of different speed, for example a
+	 * cluster of network render servers. Throughput is measured per device,
+	 * and near the end of the render slow devices leave the remaining tiles
+	 * to faster ones instead of holding up the render. */
+	struct DeviceLoad {
+		double start_time;
+		double work_done;
+		int num_rendering;
+		int max_rendering;
+
+		DeviceLoad() : start_time(0.0), work_done(0.0), num_rendering(0), max_rendering(0) {}
+	};
+
+	struct TileLoad {
+		int device;
+		double work;
+	};
+
+	vector<DeviceLoad> device_load;
+	vector<TileLoad> tile_load;
+
+	DeviceLoad& get_device_load(int device);
+	double device_throughput(int device);
+	bool leave_tile_to_faster_device(int device);
 };
 
 CCL_NAMESPACE_END
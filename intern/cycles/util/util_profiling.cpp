@@ -0,0 +1,261 @@
+/*
+ * Copyright 2011-2014 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#include <algorithm>
+
+#include "util_foreach.h"
+#include "util_function.h"
+#include "util_profiling.h"
+#include "util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+Profiler::Profiler()
+: sample_interval(0.001), worker(NULL), do_stop(false)
+{
+	reset();
+}
+
+Profiler::~Profiler()
+{
+	stop();
+}
+
+void Profiler::reset()
+{
+	thread_scoped_lock lock(mutex);
+
+	num_threads = 0;
+
+	memset(event_samples, 0, sizeof(event_samples));
+	memset(rays, 0, sizeof(rays));
+
+	shader_samples.clear();
+	node_samples.clear();
+	threads.clear();
+	tiles.clear();
+}
+
+void Profiler::start()
+{
+	if(worker)
+		return;
+
+	do_stop = false;
+	worker = new thread(function_bind(&Profiler::run, this));
+}
+
+void Profiler::stop()
+{
+	if(!worker)
+		return;
+
+	do_stop = true;
+	worker->join();
+
+	delete worker;
+	worker = NULL;
+}
+
+void Profiler::run()
+{
+	while(!do_stop) {
+		time_sleep(sample_interval);
+
+		thread_scoped_lock lock(mutex);
+
+		foreach(ProfilingState *state, states) {
+			int event = state->event;
+			int shader = state->shader;
+			int node = state->node;
+
+			if(event < 0 || event >= PROFILING_NUM_EVENTS)
+				continue;
+
+			event_samples[event]++;
+			state->event_samples[event]++;
+
+			if(event == PROFILING_SHADER_EVAL) {
+				if(shader >= 0) {
+					if(shader >= (int)shader_samples.size())
+						shader_samples.resize(shader + 1, 0);
+					shader_samples[shader]++;
+				}
+
+				if(node >= 0) {
+					if(node >= (int)node_samples.size())
+						node_samples.resize(node + 1, 0);
+					node_samples[node]++;
+				}
+			}
+		}
+	}
+}
+
+void Profiler::add_state(ProfilingState *state)
+{
+	thread_scoped_lock lock(mutex);
+
+	memset(state, 0, sizeof(*state));
+	state->event = PROFILING_IDLE;
+	state->shader = -1;
+	state->node = -1;
+	state->thread_index = num_threads++;
+	state->active = 1;
+
+	states.push_back(state);
+}
+
+void Profiler::remove_state(ProfilingState *state)
+{
+	thread_scoped_lock lock(mutex);
+
+	vector<ProfilingState*>::iterator it = std::find(states.begin(), states.end(), state);
+
+	if(it == states.end())
+		return;
+
+	states.erase(it);
+	state->active = 0;
+
+	/* keep per thread results */
+	ProfilingThread result;
+
+	result.thread_index = state->thread_index;
+	memcpy(result.event_samples, state->event_samples, sizeof(result.event_samples));
+	memcpy(result.rays, state->rays, sizeof(result.rays));
+
+	for(int i = 0; i < PROFILING_NUM_RAYS; i++)
+		rays[i] += state->rays[i];
+
+	threads.push_back(result);
+}
+
+void Profiler::add_tile(const ProfilingTile& tile)
+{
+	thread_scoped_lock lock(mutex);
+	tiles.push_back(tile);
+}
+
+uint64_t Profiler::get_event(ProfilingEvent event)
+{
+	thread_scoped_lock lock(mutex);
+	return event_samples[event];
+}
+
+uint64_t Profiler::get_total()
+{
+	thread_scoped_lock lock(mutex);
+	uint64_t total = 0;
+
+	for(int i = 0; i < PROFILING_NUM_EVENTS; i++)
+		total += event_samples[i];
+
+	return total;
+}
+
+uint64_t Profiler::get_rays(ProfilingRay type)
+{
+	thread_scoped_lock lock(mutex);
+	uint64_t total = rays[type];
+
+	/* include threads that are still rendering */
+	foreach(ProfilingState *state, states)
+		total += state->rays[type];
+
+	return total;
+}
+
+void Profiler::get_shaders(vector<uint64_t>& samples)
+{
+	thread_scoped_lock lock(mutex);
+	samples = shader_samples;
+}
+
+void Profiler::get_svm_nodes(vector<uint64_t>& samples)
+{
+	thread_scoped_lock lock(mutex);
+	samples = node_samples;
+}
+
+void Profiler::get_threads(vector<ProfilingThread>& threads_)
+{
+	thread_scoped_lock lock(mutex);
+	threads_ = threads;
+}
+
+void Profiler::get_tiles(vector<ProfilingTile>& tiles_)
+{
+	thread_scoped_lock lock(mutex);
+	tiles_ = tiles;
+}
+
+string Profiler::summary()
+{
+	uint64_t total = get_total() - get_event(PROFILING_IDLE);
+
+	if(total == 0)
+		return "";
+
+	string result;
+
+	for(int i = PROFILING_IDLE + 1; i < PROFILING_NUM_EVENTS; i++) {
+		uint64_t samples = get_event((ProfilingEvent)i);
+
+		if(samples == 0)
+			continue;
+
+		if(result.size())
+			result += ", ";
+
+		result += string_printf("%s %d%%", event_name((ProfilingEvent)i), (int)(samples*100/total));
+	}
+
+	return result;
+}
+
+const char *Profiler::event_name(ProfilingEvent event)
+{
+	switch(event) {
+		case PROFILING_IDLE: return "Idle";
+		case PROFILING_RAY_SETUP: return "Ray Setup";
+		case PROFILING_PATH_INTEGRATE: return "Path Integration";
+		case PROFILING_INTERSECT: return "Intersect";
+		case PROFILING_SHADOW_RAY: return "Shadow Rays";
+		case PROFILING_SHADER_EVAL: return "Shader Evaluation";
+		case PROFILING_LIGHT_SAMPLE: return "Light Sampling";
+		case PROFILING_WRITE_RESULT: return "Film Write";
+		case PROFILING_NUM_EVENTS: break;
+	}
+
+	return "";
+}
+
+const char *Profiler::ray_name(ProfilingRay type)
+{
+	switch(type) {
+		case PROFILING_RAY_CAMERA: return "camera";
+		case PROFILING_RAY_INTERSECT: return "intersect";
+		case PROFILING_RAY_SHADOW: return "shadow";
+		case PROFILING_RAY_SUBSURFACE: return "subsurface";
+		case PROFILING_NUM_RAYS: break;
+	}
+
+	return "";
+}
+
+CCL_NAMESPACE_END
+
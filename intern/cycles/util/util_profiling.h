@@ -0,0 +1,106 @@
+/*
+ * Copyright 2011-2014 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#ifndef __UTIL_PROFILING_H__
+#define __UTIL_PROFILING_H__
+
+#include <string.h>
+
+#include "util_profiling_state.h"
+#include "util_string.h"
+#include "util_thread.h"
+#include "util_types.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Profiling
+ *
+ * Sampling profiler for the CPU kernel. Each render thread has a
+ * ProfilingState (util_profiling_state.h) in its KernelGlobals in which the
+ * kernel stores what it is currently doing. A separate thread samples all
+ * registered states at a fixed interval, so the kernel only pays for a few
+ * stores per phase, and for a check of the active flag when not profiling. */
+
+/* Results */
+
+struct ProfilingTile {
+	int x, y, w, h;
+	int samples;
+	int thread_index;
+	double time;
+	uint64_t rays[PROFILING_NUM_RAYS];
+};
+
+struct ProfilingThread {
+	int thread_index;
+	uint64_t event_samples[PROFILING_NUM_EVENTS];
+	uint64_t rays[PROFILING_NUM_RAYS];
+};
+
+class Profiler {
+public:
+	Profiler();
+	~Profiler();
+
+	void reset();
+	void start();
+	void stop();
+	bool active() { return worker != NULL; }
+
+	/* render threads */
+	void add_state(ProfilingState *state);
+	void remove_state(ProfilingState *state);
+	void add_tile(const ProfilingTile& tile);
+
+	/* results, in number of samples taken every sample_interval seconds */
+	uint64_t get_event(ProfilingEvent event);
+	uint64_t get_total();
+	uint64_t get_rays(ProfilingRay type);
+	void get_shaders(vector<uint64_t>& samples);
+	void get_svm_nodes(vector<uint64_t>& samples);
+	void get_threads(vector<ProfilingThread>& threads);
+	void get_tiles(vector<ProfilingTile>& tiles);
+
+	/* short human readable summary */
+	string summary();
+
+	static const char *event_name(ProfilingEvent event);
+	static const char *ray_name(ProfilingRay type);
+
+	double sample_interval;
+
+protected:
+	void run();
+
+	thread_mutex mutex;
+	thread *worker;
+	volatile bool do_stop;
+	int num_threads;
+
+	vector<ProfilingState*> states;
+	uint64_t event_samples[PROFILING_NUM_EVENTS];
+	uint64_t rays[PROFILING_NUM_RAYS];
+	vector<uint64_t> shader_samples;
+	vector<uint64_t> node_samples;
+	vector<ProfilingThread> threads;
+	vector<ProfilingTile> tiles;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_PROFILING_H__ */
+
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2011-2014 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License
+ */
+
+#ifndef __UTIL_PROFILING_STATE_H__
+#define __UTIL_PROFILING_STATE_H__
+
+#include "util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Profiling State
+ *
+ * Plain per thread state of the sampling profiler in util_profiling.h. It is
+ * part of the CPU KernelGlobals, so this header is kept free of threading and
+ * container includes. */
+
+enum ProfilingEvent {
+	PROFILING_IDLE = 0,
+	PROFILING_RAY_SETUP,
+	PROFILING_PATH_INTEGRATE,
+	PROFILING_INTERSECT,
+	PROFILING_SHADOW_RAY,
+	PROFILING_SHADER_EVAL,
+	PROFILING_LIGHT_SAMPLE,
+	PROFILING_WRITE_RESULT,
+
+	PROFILING_NUM_EVENTS
+};
+
+enum ProfilingRay {
+	PROFILING_RAY_CAMERA = 0,
+	PROFILING_RAY_INTERSECT,
+	PROFILING_RAY_SHADOW,
+	PROFILING_RAY_SUBSURFACE,
+
+	PROFILING_NUM_RAYS
+};
+
+/* Written by the kernel only while active is set, read by the sampling thread */
+
+typedef struct ProfilingState {
+	int active;
+
+	volatile int event;
+	volatile int shader;
+	volatile int node;
+
+	/* ray counts, only written by the owning thread */
+	uint64_t rays[PROFILING_NUM_RAYS];
+
+	/* only written by the sampling thread */
+	int thread_index;
+	uint64_t event_samples[PROFILING_NUM_EVENTS];
+} ProfilingState;
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_PROFILING_STATE_H__ */
+
@@ -43,6 +43,7 @@ public:
 		substatus = "";
 		sync_status = "";
 		sync_substatus = "";
+		profiling = "";
 		update_cb = NULL;
 		cancel = false;
 		cancel_message = "";
@@ -217,6 +218,20 @@ public:
 		}
 	}
 
+	/* profiling summary, see util_profiling.h */
+
+	void set_profiling(const string& profiling_)
+	{
+		thread_scoped_lock lock(progress_mutex);
+		profiling = profiling_;
+	}
+
+	string get_profiling()
+	{
+		thread_scoped_lock lock(progress_mutex);
+		return profiling;
+	}
+
 	/* callback */
 
 	void set_update()
@@ -251,6 +266,8 @@ protected:
 	string sync_status;
 	string sync_substatus;
 
+	string profiling;
+
 	volatile bool cancel;
 	string cancel_message;
 };
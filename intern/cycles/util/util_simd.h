@@ -142,6 +142,28 @@ ccl_device_inline const __m128 blend(const __m128& mask, const __m128& a, const
 }
 #endif
 
+#ifdef __KERNEL_AVX2__
+
+/* calculate a*b+c with fused multiply-add */
+ccl_device_inline const __m128 fma(const __m128& a, const __m128& b, const __m128& c)
+{
+	return _mm_fmadd_ps(a, b, c);
+}
+
+/* calculate a*b-c with fused multiply-subtract */
+ccl_device_inline const __m128 fms(const __m128& a, const __m128& b, const __m128& c)
+{
+	return _mm_fmsub_ps(a, b, c);
+}
+
+/* calculate -a*b+c with fused negated multiply-add */
+ccl_device_inline const __m128 fnma(const __m128& a, const __m128& b, const __m128& c)
+{
+	return _mm_fnmadd_ps(a, b, c);
+}
+
+#else
+
 /* calculate a*b+c (replacement for fused multiply-add on SSE CPUs) */
 ccl_device_inline const __m128 fma(const __m128& a, const __m128& b, const __m128& c)
 {
@@ -160,6 +182,8 @@ ccl_device_inline const __m128 fnma(const __m128& a, const __m128& b, const __m1
 	return _mm_sub_ps(c, _mm_mul_ps(a, b));
 }
 
+#endif
+
 template<size_t N> ccl_device_inline const __m128 broadcast(const __m128& a)
 {
 	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(a), _MM_SHUFFLE(N, N, N, N)));
@@ -270,6 +294,75 @@ ccl_device_inline const __m128 cross(const __m128& a, const __m128& b)
 
 #endif /* __KERNEL_SSE2__ */
 
+#ifdef __KERNEL_AVX__
+
+/* AVX 8-wide utility functions, lanes 0-3 and 4-7 often hold two 4-wide
+ * SSE values processed at once */
+
+ccl_device_inline const __m256 m256_combine(const __m128& lo, const __m128& hi)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+ccl_device_inline const __m256 m256_splat2(const __m128& a)
+{
+	return m256_combine(a, a);
+}
+
+ccl_device_inline const __m128 m256_lo(const __m256& a)
+{
+	return _mm256_castps256_ps128(a);
+}
+
+ccl_device_inline const __m128 m256_hi(const __m256& a)
+{
+	return _mm256_extractf128_ps(a, 1);
+}
+
+/* Blend 2 vectors based on mask: (a[i] & mask[i]) | (b[i] & ~mask[i]) */
+ccl_device_inline const __m256 blend(const __m256& mask, const __m256& a, const __m256& b)
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+#ifdef __KERNEL_AVX2__
+
+ccl_device_inline const __m256 fma(const __m256& a, const __m256& b, const __m256& c)
+{
+	return _mm256_fmadd_ps(a, b, c);
+}
+
+ccl_device_inline const __m256 fms(const __m256& a, const __m256& b, const __m256& c)
+{
+	return _mm256_fmsub_ps(a, b, c);
+}
+
+ccl_device_inline const __m256 fnma(const __m256& a, const __m256& b, const __m256& c)
+{
+	return _mm256_fnmadd_ps(a, b, c);
+}
+
+#else
+
+ccl_device_inline const __m256 fma(const __m256& a, const __m256& b, const __m256& c)
+{
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+}
+
+ccl_device_inline const __m256 fms(const __m256& a, const __m256& b, const __m256& c)
+{
+	return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+}
+
+ccl_device_inline const __m256 fnma(const __m256& a, const __m256& b, const __m256& c)
+{
+	return _mm256_sub_ps(c, _mm256_mul_ps(a, b));
+}
+
+#endif
+
+#endif /* __KERNEL_AVX__ */
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_SIMD_H__ */
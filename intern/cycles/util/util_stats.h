@@ -17,6 +17,8 @@
 #ifndef __UTIL_STATS_H__
 #define __UTIL_STATS_H__
 
+#include "util_profiling.h"
+
 CCL_NAMESPACE_BEGIN
 
 class Stats {
@@ -35,6 +37,9 @@ public:
 
 	size_t mem_used;
 	size_t mem_peak;
+
+	/* kernel profiling, see util_profiling.h */
+	Profiler profiler;
 };
 
 CCL_NAMESPACE_END
@@ -61,13 +61,13 @@ int system_cpu_thread_count()
 static void __cpuid(int data[4], int selector)
 {
 #ifdef __x86_64__
-	asm("cpuid" : "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector));
+	asm("cpuid" : "=a" (data[0]), "=b" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector), "c"(0));
 #else
 #ifdef __i386__
 	asm("pushl %%ebx    \n\t"
 		"cpuid          \n\t"
 		"movl %%ebx, %1 \n\t"
-		"popl %%ebx     \n\t" : "=a" (data[0]), "=r" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector));
+		"popl %%ebx     \n\t" : "=a" (data[0]), "=r" (data[1]), "=c" (data[2]), "=d" (data[3]) : "a"(selector), "c"(0));
 #else
 	data[0] = data[1] = data[2] = data[3] = 0;
 #endif
@@ -127,9 +127,14 @@ struct CPUCapabilities {
 	bool sse42;
 	bool sse4a;
 	bool avx;
+	bool avx2;
+	bool bmi1;
+	bool bmi2;
 	bool xop;
 	bool fma3;
 	bool fma4;
+	bool f16c;
+	bool lzcnt;
 };
 
 static CPUCapabilities& system_cpu_capabilities()
@@ -138,17 +143,15 @@ static CPUCapabilities& system_cpu_capabilities()
 	static bool caps_init = false;
 
 	if(!caps_init) {
-		int result[4], num; //, num_ex;
+		int result[4], num, num_ex;
 
 		memset(&caps, 0, sizeof(caps));
 
 		__cpuid(result, 0);
 		num = result[0];
 
-#if 0
 		__cpuid(result, 0x80000000);
 		num_ex = result[0];
-#endif
 
 		if(num >= 1) {
 			__cpuid(result, 0x00000001);
@@ -162,6 +165,7 @@ static CPUCapabilities& system_cpu_capabilities()
 			caps.sse42 = (result[2] & ((int)1 << 20)) != 0;
 
 			caps.fma3 = (result[2] & ((int)1 << 12)) != 0;
+			caps.f16c = (result[2] & ((int)1 << 29)) != 0;
 			caps.avx = false;
 			bool os_uses_xsave_xrestore = (result[2] & ((int)1 << 27)) != 0;
 			bool cpu_avx_support = (result[2] & ((int)1 << 28)) != 0;
@@ -182,6 +186,24 @@ static CPUCapabilities& system_cpu_capabilities()
 			}
 		}
 
+		if(num >= 7) {
+			/* extended features, sub-leaf 0 */
+#if defined(_WIN32) && !defined(FREE_WINDOWS)
+			__cpuidex(result, 0x00000007, 0);
+#else
+			__cpuid(result, 0x00000007);
+#endif
+			caps.bmi1 = (result[1] & ((int)1 <<  3)) != 0;
+			caps.avx2 = (result[1] & ((int)1 <<  5)) != 0;
+			caps.bmi2 = (result[1] & ((int)1 <<  8)) != 0;
+		}
+
+		if((unsigned int)num_ex >= 0x80000001) {
+			__cpuid(result, 0x80000001);
+			/* LZCNT is reported by the ABM bit */
+			caps.lzcnt = (result[2] & ((int)1 <<  5)) != 0;
+		}
+
 #if 0
 		if(num_ex >= 0x80000001) {
 			__cpuid(result, 0x80000001);
@@ -221,6 +243,12 @@ bool system_cpu_support_avx()
 	CPUCapabilities& caps = system_cpu_capabilities();
 	return caps.sse && caps.sse2 && caps.sse3 && caps.ssse3 && caps.sse41 && caps.avx;
 }
+
+bool system_cpu_support_avx2()
+{
+	CPUCapabilities& caps = system_cpu_capabilities();
+	return caps.sse && caps.sse2 && caps.sse3 && caps.ssse3 && caps.sse41 && caps.avx && caps.f16c && caps.avx2 && caps.fma3 && caps.bmi1 && caps.bmi2 && caps.lzcnt;
+}
 #else
 
 bool system_cpu_support_sse2()
@@ -243,6 +271,11 @@ bool system_cpu_support_avx()
 	return false;
 }
 
+bool system_cpu_support_avx2()
+{
+	return false;
+}
+
 #endif
 
 CCL_NAMESPACE_END
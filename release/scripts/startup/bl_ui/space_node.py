@@ -402,6 +402,8 @@ class NODE_PT_quality(bpy.types.Panel):
         col.prop(tree, "use_groupnode_buffer")
         col.prop(tree, "use_two_pass")
         col.prop(tree, "use_viewer_border")
+        col.prop(tree, "use_viewer_visible_area")
+        col.prop(tree, "use_profiling")
         col.prop(snode, "show_highlight")
 
 
@@ -149,6 +149,9 @@ bool BKE_image_has_ibuf(struct Image *ima, struct ImageUser *iuser);
 struct ImBuf *BKE_image_acquire_ibuf(struct Image *ima, struct ImageUser *iuser, void **lock_r);
 void BKE_image_release_ibuf(struct Image *ima, struct ImBuf *ibuf, void *lock);
 
+/* load a frame of an image sequence into the image cache, can be called from a background thread */
+bool BKE_image_prefetch_frame(struct Image *ima, struct ImageUser *iuser, int cfra);
+
 struct ImagePool *BKE_image_pool_new(void);
 void BKE_image_pool_free(struct ImagePool *pool);
 struct ImBuf *BKE_image_pool_acquire_ibuf(struct Image *ima, struct ImageUser *iuser, struct ImagePool *pool);
@@ -204,6 +207,9 @@ void    BKE_image_free_all_textures(void);
 /* does one image! */
 void    BKE_image_free_anim_ibufs(struct Image *ima, int except_frame);
 
+/* same, but keeps the image frames from except_sfra to except_efra, for frames that are loaded ahead */
+void    BKE_image_free_anim_ibufs_range(struct Image *ima, int except_sfra, int except_efra);
+
 /* does all images with type MOVIE or SEQUENCE */
 void BKE_image_all_free_anim_ibufs(int except_frame);
 
@@ -103,6 +103,8 @@ void BKE_library_make_local(struct Main *bmain, struct Library *lib, bool untagg
 
 struct ID *BKE_libblock_find_name(const short type, const char *name) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
+unsigned int BKE_id_data_hash(struct ID *id, int cfra) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+
 void set_free_windowmanager_cb(void (*func)(struct bContext *, struct wmWindowManager *) );
 void set_free_notifier_reference_cb(void (*func)(const void *) );
 
@@ -996,22 +996,30 @@ void BKE_image_free_all_textures(void)
 
 static bool imagecache_check_free_anim(ImBuf *ibuf, void *UNUSED(userkey), void *userdata)
 {
-	int except_frame = *(int *)userdata;
+	const int *except_range = userdata;
+	const int frame = IMA_INDEX_FRAME(ibuf->index);
 	return (ibuf->userflags & IB_BITMAPDIRTY) == 0 &&
 	       (ibuf->index != IMA_NO_INDEX) &&
-	       (except_frame != IMA_INDEX_FRAME(ibuf->index));
+	       (frame < except_range[0] || frame > except_range[1]);
 }
 
-/* except_frame is weak, only works for seqs without offset... */
-void BKE_image_free_anim_ibufs(Image *ima, int except_frame)
+void BKE_image_free_anim_ibufs_range(Image *ima, int except_sfra, int except_efra)
 {
+	int except_range[2] = {except_sfra, except_efra};
+
 	BLI_spin_lock(&image_spin);
 	if (ima->cache != NULL) {
-		IMB_moviecache_cleanup(ima->cache, imagecache_check_free_anim, &except_frame);
+		IMB_moviecache_cleanup(ima->cache, imagecache_check_free_anim, except_range);
 	}
 	BLI_spin_unlock(&image_spin);
 }
 
+/* except_frame is weak, only works for seqs without offset... */
+void BKE_image_free_anim_ibufs(Image *ima, int except_frame)
+{
+	BKE_image_free_anim_ibufs_range(ima, except_frame, except_frame);
+}
+
 void BKE_image_all_free_anim_ibufs(int cfra)
 {
 	Image *ima;
@@ -3157,6 +3165,64 @@ void BKE_image_release_ibuf(Image *ima, ImBuf *ibuf, void *lock)
 	}
 }
 
+/* Load the frame of an image sequence that is used at scene frame cfra into the image cache.
+ * The file is read without holding the image lock, so this can run in a background thread
+ * while the image is used for other frames. Only sequences of which a frame was loaded
+ * before are prefetched, multilayer files and movies are still loaded on use since their
+ * type is only known then. Returns true if the frame is cached. */
+bool BKE_image_prefetch_frame(Image *ima, ImageUser *iuser, int cfra)
+{
+	ImageUser iuser_frame = *iuser;
+	ImBuf *ibuf;
+	char name[FILE_MAX];
+	char colorspace[64];  /* MAX_COLORSPACE_NAME */
+	int frame, flag;
+	bool cached = true;
+
+	frame = iuser_frame.framenr = BKE_image_user_frame_get(iuser, cfra, 0, NULL);
+
+	BLI_spin_lock(&image_spin);
+	if (ima->source != IMA_SRC_SEQUENCE || ima->type != IMA_TYPE_IMAGE || ima->ok != IMA_OK_LOADED) {
+		BLI_spin_unlock(&image_spin);
+		return false;
+	}
+	ibuf = image_get_cached_ibuf_for_index_frame(ima, 0, frame);
+	BKE_image_user_file_path(&iuser_frame, ima, name);
+	BLI_strncpy(colorspace, ima->colorspace_settings.name, sizeof(colorspace));
+	flag = IB_rect | imbuf_alpha_flags_for_image(ima);
+	BLI_spin_unlock(&image_spin);
+
+	if (ibuf) {
+		BKE_image_release_ibuf(ima, ibuf, NULL);
+		return true;
+	}
+
+	ibuf = IMB_loadiffname(name, flag, colorspace);
+	if (ibuf == NULL)
+		return false;
+
+	BLI_spin_lock(&image_spin);
+	{
+		/* the frame may have been loaded by a user of the image meanwhile,
+		 * or the image may have changed type or been reloaded */
+		ImBuf *cached_ibuf = image_get_cached_ibuf_for_index_frame(ima, 0, frame);
+		if (cached_ibuf) {
+			IMB_freeImBuf(cached_ibuf);
+		}
+		else if (ima->source == IMA_SRC_SEQUENCE && ima->type == IMA_TYPE_IMAGE && ima->ok == IMA_OK_LOADED) {
+			image_initialize_after_load(ima, ibuf);
+			image_assign_ibuf(ima, ibuf, 0, frame);
+		}
+		else {
+			cached = false;
+		}
+	}
+	IMB_freeImBuf(ibuf);
+	BLI_spin_unlock(&image_spin);
+
+	return cached;
+}
+
 /* checks whether there's an image buffer for given image and user */
 bool BKE_image_has_ibuf(Image *ima, ImageUser *iuser)
 {
@@ -46,6 +46,7 @@
 #include "DNA_armature_types.h"
 #include "DNA_brush_types.h"
 #include "DNA_camera_types.h"
+#include "DNA_color_types.h"
 #include "DNA_group_types.h"
 #include "DNA_gpencil_types.h"
 #include "DNA_ipo_types.h"
@@ -81,6 +82,7 @@
 #include "BKE_camera.h"
 #include "BKE_context.h"
 #include "BKE_curve.h"
+#include "BKE_customdata.h"
 #include "BKE_depsgraph.h"
 #include "BKE_fcurve.h"
 #include "BKE_font.h"
@@ -1586,3 +1588,187 @@ void BKE_library_filepath_set(Library *lib, const char *filepath)
 		BLI_path_abs(lib->filepath, basepath);
 	}
 }
+
+/* ***************** DATA HASH ************************ */
+
+/* Render engines that keep their data in memory between renders can't rely on the
+ * recalc flags, those are cleared before a final render starts. Instead they compare
+ * a hash of the data with the one of the previous render. The hash may change when
+ * the data doesn't (e.g. selection or runtime pointers), but not the other way around. */
+
+static unsigned int data_hash_mem(unsigned int hash, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+
+	while (len--)
+		hash = (hash << 5) + hash + *p++;
+
+	return hash;
+}
+
+static unsigned int data_hash_str(unsigned int hash, const char *str)
+{
+	return data_hash_mem(hash, str, strlen(str));
+}
+
+static unsigned int data_hash_idprop(unsigned int hash, IDProperty *prop)
+{
+	IDProperty *link;
+	int i;
+
+	hash = data_hash_mem(hash, &prop->type, sizeof(prop->type));
+	hash = data_hash_str(hash, prop->name);
+
+	switch (prop->type) {
+		case IDP_GROUP:
+			for (link = prop->data.group.first; link; link = link->next)
+				hash = data_hash_idprop(hash, link);
+			break;
+		case IDP_IDPARRAY:
+			for (i = 0; i < prop->len; i++)
+				hash = data_hash_idprop(hash, IDP_GetIndexArray(prop, i));
+			break;
+		case IDP_ARRAY:
+			hash = data_hash_mem(hash, prop->data.pointer,
+			                     (size_t)prop->len * ((prop->subtype == IDP_DOUBLE) ? sizeof(double) : sizeof(int)));
+			break;
+		case IDP_STRING:
+			hash = data_hash_mem(hash, prop->data.pointer, (size_t)prop->len);
+			break;
+		default:
+			/* numbers are stored in place, ID properties as pointer */
+			hash = data_hash_mem(hash, &prop->data.pointer, sizeof(prop->data.pointer));
+			hash = data_hash_mem(hash, &prop->data.val, sizeof(prop->data.val) + sizeof(prop->data.val2));
+			break;
+	}
+
+	return hash;
+}
+
+static unsigned int data_hash_customdata(unsigned int hash, CustomData *data, int totelem)
+{
+	int i;
+
+	hash = data_hash_mem(hash, &totelem, sizeof(totelem));
+
+	for (i = 0; i < data->totlayer; i++) {
+		CustomDataLayer *layer = &data->layers[i];
+
+		hash = data_hash_mem(hash, &layer->type, sizeof(layer->type));
+		hash = data_hash_mem(hash, &layer->active_rnd, sizeof(layer->active_rnd));
+		hash = data_hash_str(hash, layer->name);
+
+		if (layer->data)
+			hash = data_hash_mem(hash, layer->data, (size_t)CustomData_sizeof(layer->type) * totelem);
+	}
+
+	return hash;
+}
+
+static unsigned int data_hash_ntree(unsigned int hash, bNodeTree *ntree, int cfra)
+{
+	bNode *node;
+	bNodeSocket *sock;
+	bNodeLink *link;
+
+	for (node = ntree->nodes.first; node; node = node->next) {
+		const int flag = node->flag & (NODE_MUTED | NODE_DO_OUTPUT);
+
+		hash = data_hash_str(hash, node->idname);
+		hash = data_hash_str(hash, node->name);
+		hash = data_hash_mem(hash, &flag, sizeof(flag));
+		hash = data_hash_mem(hash, &node->custom1, sizeof(node->custom1));
+		hash = data_hash_mem(hash, &node->custom2, sizeof(node->custom2));
+		hash = data_hash_mem(hash, &node->custom3, sizeof(node->custom3));
+		hash = data_hash_mem(hash, &node->custom4, sizeof(node->custom4));
+
+		if (node->storage) {
+			hash = data_hash_mem(hash, node->storage, MEM_allocN_len(node->storage));
+
+			/* curve points are not part of the storage */
+			if (ELEM(node->type, SH_NODE_CURVE_VEC, SH_NODE_CURVE_RGB)) {
+				CurveMapping *cumap = node->storage;
+				int i;
+
+				for (i = 0; i < CM_TOT; i++) {
+					if (cumap->cm[i].curve)
+						hash = data_hash_mem(hash, cumap->cm[i].curve, sizeof(CurveMapPoint) * cumap->cm[i].totpoint);
+				}
+			}
+		}
+
+		if (node->prop)
+			hash = data_hash_idprop(hash, node->prop);
+
+		if (node->id) {
+			hash = data_hash_mem(hash, &node->id, sizeof(node->id));
+
+			if (GS(node->id->name) == ID_NT)
+				hash = data_hash_ntree(hash, (bNodeTree *)node->id, cfra);
+			else if (GS(node->id->name) == ID_IM && BKE_image_is_animated((Image *)node->id))
+				hash = data_hash_mem(hash, &cfra, sizeof(cfra));
+		}
+
+		/* value and color nodes store their value in the output socket */
+		for (sock = node->inputs.first; sock; sock = sock->next) {
+			hash = data_hash_str(hash, sock->identifier);
+			if (sock->default_value)
+				hash = data_hash_mem(hash, sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+		for (sock = node->outputs.first; sock; sock = sock->next) {
+			hash = data_hash_str(hash, sock->identifier);
+			if (sock->default_value)
+				hash = data_hash_mem(hash, sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+	}
+
+	for (link = ntree->links.first; link; link = link->next) {
+		hash = data_hash_mem(hash, &link->fromsock, sizeof(link->fromsock));
+		hash = data_hash_mem(hash, &link->tosock, sizeof(link->tosock));
+	}
+
+	return hash;
+}
+
+/**
+ * Hash of the data of a datablock: its struct, custom properties, and for meshes and
+ * node trees the data they point to. Other datablocks are only hashed by pointer, image
+ * sequences and movies used by nodes add \a cfra.
+ */
+unsigned int BKE_id_data_hash(ID *id, int cfra)
+{
+	unsigned int hash = 5381;
+	bNodeTree *ntree;
+
+	hash = data_hash_mem(hash, (char *)id + sizeof(ID), MEM_allocN_len(id) - sizeof(ID));
+
+	if (id->properties)
+		hash = data_hash_idprop(hash, id->properties);
+
+	switch (GS(id->name)) {
+		case ID_ME:
+		{
+			Mesh *me = (Mesh *)id;
+
+			hash = data_hash_customdata(hash, &me->vdata, me->totvert);
+			hash = data_hash_customdata(hash, &me->edata, me->totedge);
+			hash = data_hash_customdata(hash, &me->fdata, me->totface);
+			hash = data_hash_customdata(hash, &me->pdata, me->totpoly);
+			hash = data_hash_customdata(hash, &me->ldata, me->totloop);
+
+			if (me->mat)
+				hash = data_hash_mem(hash, me->mat, sizeof(*me->mat) * me->totcol);
+			break;
+		}
+		case ID_NT:
+			hash = data_hash_ntree(hash, (bNodeTree *)id, cfra);
+			break;
+	}
+
+	/* node trees of materials, lamps, worlds and textures */
+	ntree = ntreeFromID(id);
+	if (ntree)
+		hash = data_hash_ntree(hash, ntree, cfra);
+
+	return hash;
+}
@@ -54,11 +54,14 @@ typedef struct bCallbackFuncStore {
 	void (*func)(struct Main *, struct ID *, void *arg);
 	void *arg;
 	short alloc;
+	/* optional, returns false when calling func would do nothing */
+	int (*poll)(void *arg);
 } bCallbackFuncStore;
 
 
 void BLI_callback_exec(struct Main *main, struct ID *self, eCbEvent evt);
 void BLI_callback_add(bCallbackFuncStore *funcstore, eCbEvent evt);
+int BLI_callback_poll(eCbEvent evt);
 
 void BLI_callback_global_init(void);
 void BLI_callback_global_finalize(void);
@@ -48,6 +48,21 @@ void BLI_callback_add(bCallbackFuncStore *funcstore, eCbEvent evt)
 	BLI_addtail(lb, funcstore);
 }
 
+/* are there callbacks for evt that would do something when executed */
+int BLI_callback_poll(eCbEvent evt)
+{
+	ListBase *lb = &callback_slots[evt];
+	bCallbackFuncStore *funcstore;
+
+	for (funcstore = (bCallbackFuncStore *)lb->first; funcstore; funcstore = (bCallbackFuncStore *)funcstore->next) {
+		if (funcstore->poll == NULL || funcstore->poll(funcstore->arg)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
 void BLI_callback_global_init(void)
 {
 	/* do nothing */
@@ -2630,6 +2630,7 @@ static void direct_link_nodetree(FileData *fd, bNodeTree *ntree)
 	link_list(fd, &ntree->nodes);
 	for (node = ntree->nodes.first; node; node = node->next) {
 		node->typeinfo = NULL;
+		node->exec_time = 0.0f;
 		
 		link_list(fd, &node->inputs);
 		link_list(fd, &node->outputs);
@@ -107,8 +107,40 @@ typedef enum OrderOfChunks {
 
 #define COM_NUMBER_OF_CHANNELS 4
 
+/**
+ * Number of channels a MemoryBuffer stores per pixel for each DataType.
+ * Readers always get COM_NUMBER_OF_CHANNELS floats, the channels that are not stored are zero.
+ */
+#define COM_NUM_CHANNELS_VALUE 1
+#define COM_NUM_CHANNELS_VECTOR 3
+#define COM_NUM_CHANNELS_COLOR 4
+
+/**
+ * Maximum number of pixels calculated by a single SocketReader.executeRow call.
+ * Operations keep their input rows on the stack, so this is kept small.
+ */
+#define COM_ROW_SIZE 32
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * Radius (in pixels) from which the gaussian and box filters of the Blur node use
+ * recursive filters or running sums, with a cost per pixel that does not depend on the radius.
+ */
+#define COM_BLUR_CONSTANT_TIME_RADIUS 100.0f
+
+/**
+ * Radius (in pixels) from which the Bokeh Blur node convolves the image with the bokeh
+ * in the frequency domain, see FFTConvolution.
+ */
+#define COM_FFT_CONVOLUTION_RADIUS 32
+
+/**
+ * Memory budget (in MB) of the ResultCache, the intermediate results that are kept
+ * between executions. Least recently used results are freed first.
+ */
+#define COM_RESULT_CACHE_LIMIT 1024
+
 /**
  * The fast gaussien blur is not an accurate blur.
  * This setting can be used to increase/decrease the 
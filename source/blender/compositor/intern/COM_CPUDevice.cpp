@@ -22,16 +22,20 @@
 
 #include "COM_CPUDevice.h"
 
+#include "PIL_time.h"
+
 void CPUDevice::execute(WorkPackage *work)
 {
 	const unsigned int chunkNumber = work->getChunkNumber();
 	ExecutionGroup *executionGroup = work->getExecutionGroup();
 	rcti rect;
+	const double start_time = PIL_check_seconds_timer();
 
 	executionGroup->determineChunkRect(&rect, chunkNumber);
 
 	executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
 
+	executionGroup->profileChunk(start_time, PIL_check_seconds_timer());
 	executionGroup->finalizeChunkExecution(chunkNumber, NULL);
 }
 
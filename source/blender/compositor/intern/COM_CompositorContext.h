@@ -166,6 +166,13 @@ public:
 	 */
 	const CompositorQuality getQuality() const { return this->m_quality; }
 
+	/**
+	 * @brief store intermediate buffers in half precision
+	 * halves the memory and bandwidth of the buffers, calculations are still done on floats.
+	 * Used for the medium and low quality settings.
+	 */
+	bool useHalfFloatBuffers() const { return this->m_quality != COM_QUALITY_HIGH; }
+
 	/**
 	 * @brief get the current framenumber of the scene in this context
 	 */
@@ -183,6 +190,12 @@ public:
 	
 	int getChunksize() const { return this->getbNodeTree()->chunksize; }
 	
+	/**
+	 * @brief measure the execution time of the ExecutionGroup's and nodes
+	 * @see Profiler
+	 */
+	bool isProfiling() const { return (this->getbNodeTree()->flag & NTREE_COM_PROFILE) != 0; }
+	
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() const { return this->m_fastCalculation; }
 	bool isGroupnodeBufferEnabled() const { return this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER; }
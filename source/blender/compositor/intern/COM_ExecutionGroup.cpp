@@ -62,6 +62,8 @@ ExecutionGroup::ExecutionGroup()
 	this->m_chunksFinished = 0;
 	BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
 	this->m_executionStartTime = 0;
+	this->m_profiling = false;
+	Profiler::init(&this->m_profile);
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -116,10 +118,20 @@ void ExecutionGroup::initExecution()
 	determineNumberOfChunks();
 
 	this->m_chunkExecutionStates = NULL;
+	Profiler::init(&this->m_profile);
+	if (this->m_profiling) {
+		BLI_mutex_init(&this->m_profileMutex);
+	}
 	if (this->m_numberOfChunks != 0) {
+		/* results taken from the ResultCache don't need to be calculated */
+		NodeOperation *operation = this->getOutputOperation();
+		const bool cached = operation->isWriteBufferOperation() &&
+		                    ((WriteBufferOperation *)operation)->getMemoryProxy()->isCached();
+		const ChunkExecutionState state = cached ? COM_ES_EXECUTED : COM_ES_NOT_SCHEDULED;
+
 		this->m_chunkExecutionStates = (ChunkExecutionState *)MEM_mallocN(sizeof(ChunkExecutionState) * this->m_numberOfChunks, __func__);
 		for (index = 0; index < this->m_numberOfChunks; index++) {
-			this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
+			this->m_chunkExecutionStates[index] = state;
 		}
 	}
 
@@ -139,6 +151,16 @@ void ExecutionGroup::initExecution()
 
 }
 
+bool ExecutionGroup::isFullyExecuted() const
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void ExecutionGroup::deinitExecution()
 {
 	if (this->m_chunkExecutionStates != NULL) {
@@ -150,6 +172,9 @@ void ExecutionGroup::deinitExecution()
 	this->m_numberOfYChunks = 0;
 	this->m_cachedReadOperations.clear();
 	this->m_bTree = NULL;
+	if (this->m_profiling) {
+		BLI_mutex_end(&this->m_profileMutex);
+	}
 }
 void ExecutionGroup::determineResolution(unsigned int resolution[2])
 {
@@ -435,6 +460,15 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
 	}
 }
 
+void ExecutionGroup::profileChunk(double start_time, double end_time)
+{
+	if (this->m_profiling) {
+		BLI_mutex_lock(&this->m_profileMutex);
+		Profiler::add_chunk(&this->m_profile, start_time, end_time);
+		BLI_mutex_unlock(&this->m_profileMutex);
+	}
+}
+
 inline void ExecutionGroup::determineChunkRect(rcti *rect, const unsigned int xChunk, const unsigned int yChunk) const
 {
 	const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
@@ -598,6 +632,24 @@ void ExecutionGroup::setViewerBorder(float xmin, float xmax, float ymin, float y
 	}
 }
 
+void ExecutionGroup::setViewerVisibleArea(const rctf *visible)
+{
+	NodeOperation *operation = this->getOutputOperation();
+
+	if (operation->isViewerOperation()) {
+		const float centerX = this->m_width * 0.5f;
+		const float centerY = this->m_height * 0.5f;
+		rcti area;
+
+		BLI_rcti_init(&area, floorf(centerX + visible->xmin), ceilf(centerX + visible->xmax),
+		              floorf(centerY + visible->ymin), ceilf(centerY + visible->ymax));
+		if (!BLI_rcti_isect(&this->m_viewerBorder, &area, &this->m_viewerBorder)) {
+			/* nothing of the viewer is visible */
+			BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
+		}
+	}
+}
+
 void ExecutionGroup::setRenderBorder(float xmin, float xmax, float ymin, float ymax)
 {
 	NodeOperation *operation = this->getOutputOperation();
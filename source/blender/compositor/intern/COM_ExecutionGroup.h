@@ -30,6 +30,7 @@
 #include "COM_MemoryProxy.h"
 #include "COM_Device.h"
 #include "COM_CompositorContext.h"
+#include "COM_Profiler.h"
 
 using std::vector;
 
@@ -178,6 +179,14 @@ private:
 	 */
 	double m_executionStartTime;
 
+	/**
+	 * @brief timing statistics of the chunks, only collected when profiling
+	 * @see CompositorContext.isProfiling
+	 */
+	bool m_profiling;
+	ThreadMutex m_profileMutex;
+	ExecutionGroupProfile m_profile;
+
 	// methods
 	/**
 	 * @brief check whether parameter operation can be added to the execution group
@@ -358,6 +367,11 @@ public:
 	 */
 	void finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers);
 	
+	/**
+	 * @brief have all chunks of this ExecutionGroup been calculated
+	 */
+	bool isFullyExecuted() const;
+
 	/**
 	 * @brief deinitExecution is called just after execution the whole graph.
 	 * @note It will release all needed resources
@@ -416,8 +430,27 @@ public:
 	 */
 	void setViewerBorder(float xmin, float xmax, float ymin, float ymax);
 
+	/**
+	 * @brief limit a viewer operation to the part that is visible in the backdrop
+	 * only the chunks in the area are scheduled, their inputs follow through
+	 * determineDependingAreaOfInterest.
+	 * @note the coordinates are in pixels relative to the center of the image
+	 */
+	void setViewerVisibleArea(const rctf *visible);
+
 	void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
+	void setProfiling(bool profiling) { this->m_profiling = profiling; }
+
+	/**
+	 * @brief add a chunk to the profile of this group
+	 * called by the devices after a chunk is executed, does nothing when not profiling
+	 */
+	void profileChunk(double start_time, double end_time);
+
+	const ExecutionGroupProfile &getProfile() const { return this->m_profile; }
+	const Operations &getOperations() const { return this->m_operations; }
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
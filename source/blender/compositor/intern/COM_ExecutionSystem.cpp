@@ -34,7 +34,9 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
 #include "COM_Debug.h"
+#include "COM_Profiler.h"
 
 #include "BKE_global.h"
 
@@ -75,12 +77,15 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
 	bool use_viewer_border = (editingtree->flag & NTREE_VIEWER_BORDER) &&
 	                         viewer_border->xmin < viewer_border->xmax &&
 	                         viewer_border->ymin < viewer_border->ymax;
+	/* when editing only the part of the viewer visible in the backdrop is calculated */
+	bool use_viewer_visible = !rendering && (editingtree->flag & NTREE_VIEWER_VISIBLE);
 
 	for (index = 0; index < this->m_groups.size(); index++) {
 		resolution[0] = 0;
 		resolution[1] = 0;
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->determineResolution(resolution);
+		executionGroup->setProfiling(this->m_context.isProfiling());
 
 		if (rendering) {
 			/* case when cropping to render border happens is handled in
@@ -96,6 +101,10 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
 			executionGroup->setViewerBorder(viewer_border->xmin, viewer_border->xmax,
 			                                viewer_border->ymin, viewer_border->ymax);
 		}
+
+		if (use_viewer_visible) {
+			executionGroup->setViewerVisibleArea(&editingtree->viewer_visible);
+		}
 	}
 
 //	DebugInfo::graphviz(this);
@@ -124,6 +133,8 @@ void ExecutionSystem::set_operations(const Operations &operations, const Groups
 
 void ExecutionSystem::execute()
 {
+	const double start_time = PIL_check_seconds_timer();
+
 	DebugInfo::execute_started(this);
 	
 	unsigned int order = 0;
@@ -166,6 +177,25 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	/* fully calculated buffers are kept in the ResultCache when the operations are deinitialized.
+	 * chunks of a cancelled execution are finished early, so nothing is kept in that case */
+	const bNodeTree *bTree = this->m_context.getbNodeTree();
+	if (!(bTree->test_break && bTree->test_break(bTree->tbh))) {
+		for (index = 0; index < this->m_groups.size(); index++) {
+			ExecutionGroup *executionGroup = this->m_groups[index];
+			NodeOperation *operation = executionGroup->getOutputOperation();
+			if (operation->isWriteBufferOperation() && executionGroup->isFullyExecuted()) {
+				((WriteBufferOperation *)operation)->getMemoryProxy()->setComplete();
+			}
+		}
+	}
+
+	/* the group buffers are still allocated for the report */
+	if (this->m_context.isProfiling()) {
+		Profiler::update_nodes(this);
+		Profiler::report(this, PIL_check_seconds_timer() - start_time);
+	}
+
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		operation->deinitExecution();
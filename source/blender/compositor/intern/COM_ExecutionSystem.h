@@ -176,6 +176,8 @@ public:
 	 */
 	const CompositorContext &getContext() const { return this->m_context; }
 
+	const Groups &getExecutionGroups() const { return this->m_groups; }
+
 private:
 	void executeGroups(CompositorPriority priority);
 
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_HalfFloat_h_
+#define _COM_HalfFloat_h_
+
+#include "BLI_sys_types.h"
+
+#ifdef __F16C__
+#  include <immintrin.h>
+#endif
+
+/* Conversion between 32 bit floats and 16 bit half floats (IEEE 754 binary16),
+ * used by MemoryBuffers that store their pixels in half precision.
+ * Calculations are always done on 32 bit floats. */
+
+typedef union FloatBits {
+	uint32_t u;
+	float f;
+} FloatBits;
+
+/* based on "half <-> float conversions" by Fabian Giesen, rounds to nearest even */
+inline unsigned short half_from_float(float value)
+{
+	const uint32_t f32infty = 255u << 23;
+	const uint32_t f16max = (127u + 16u) << 23;
+	FloatBits denorm_magic;
+	FloatBits f;
+	unsigned short o;
+
+	denorm_magic.u = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+	f.f = value;
+
+	const uint32_t sign = f.u & 0x80000000u;
+	f.u ^= sign;
+
+	if (f.u >= f16max) {
+		/* overflow to infinity, NaN stays NaN */
+		o = (f.u > f32infty) ? 0x7e00 : 0x7c00;
+	}
+	else if (f.u < (113u << 23)) {
+		/* denormal or zero, let the FPU do the rounding */
+		f.f += denorm_magic.f;
+		o = (unsigned short)(f.u - denorm_magic.u);
+	}
+	else {
+		const uint32_t mant_odd = (f.u >> 13) & 1u;
+		f.u += ((uint32_t)(15 - 127) << 23) + 0xfffu;
+		f.u += mant_odd;
+		o = (unsigned short)(f.u >> 13);
+	}
+
+	return o | (unsigned short)(sign >> 16);
+}
+
+inline float float_from_half(unsigned short value)
+{
+	const uint32_t shifted_exp = 0x7c00u << 13;
+	FloatBits magic;
+	FloatBits o;
+
+	magic.u = 113u << 23;
+	o.u = (uint32_t)(value & 0x7fff) << 13;
+
+	const uint32_t exp = shifted_exp & o.u;
+	o.u += (127u - 15u) << 23;
+
+	if (exp == shifted_exp) {
+		/* infinity or NaN */
+		o.u += (128u - 16u) << 23;
+	}
+	else if (exp == 0) {
+		/* zero or denormal */
+		o.u += 1u << 23;
+		o.f -= magic.f;
+	}
+
+	o.u |= (uint32_t)(value & 0x8000) << 16;
+	return o.f;
+}
+
+/**
+ * @brief convert num half floats to floats
+ */
+inline void half_to_float_n(float *dst, const unsigned short *src, int num)
+{
+	int i = 0;
+#ifdef __F16C__
+	for (; i + 4 <= num; i += 4) {
+		_mm_storeu_ps(&dst[i], _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)&src[i])));
+	}
+#endif
+	for (; i < num; i++) {
+		dst[i] = float_from_half(src[i]);
+	}
+}
+
+/**
+ * @brief convert num floats to half floats
+ */
+inline void float_to_half_n(unsigned short *dst, const float *src, int num)
+{
+	int i = 0;
+#ifdef __F16C__
+	for (; i + 4 <= num; i += 4) {
+		_mm_storel_epi64((__m128i *)&dst[i], _mm_cvtps_ph(_mm_loadu_ps(&src[i]), 0));
+	}
+#endif
+	for (; i < num; i++) {
+		dst[i] = half_from_float(src[i]);
+	}
+}
+
+#endif
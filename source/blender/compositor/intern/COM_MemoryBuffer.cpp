@@ -27,6 +27,19 @@
 using std::min;
 using std::max;
 
+static int num_channels_for_datatype(DataType datatype)
+{
+	switch (datatype) {
+		case COM_DT_VALUE:
+			return COM_NUM_CHANNELS_VALUE;
+		case COM_DT_VECTOR:
+			return COM_NUM_CHANNELS_VECTOR;
+		case COM_DT_COLOR:
+		default:
+			return COM_NUM_CHANNELS_COLOR;
+	}
+}
+
 unsigned int MemoryBuffer::determineBufferSize()
 {
 	return getWidth() * getHeight();
@@ -46,9 +59,17 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
-	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, "COM_MemoryBuffer");
+	this->m_datatype = memoryProxy->getDataType();
+	this->m_num_channels = num_channels_for_datatype(this->m_datatype);
+	if (memoryProxy->isHalfFloat()) {
+		this->m_buffer = NULL;
+		this->m_halfBuffer = (unsigned short *)MEM_mallocN(sizeof(unsigned short) * determineBufferSize() * this->m_num_channels, "COM_MemoryBuffer");
+	}
+	else {
+		this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_num_channels, "COM_MemoryBuffer");
+		this->m_halfBuffer = NULL;
+	}
 	this->m_state = COM_MB_ALLOCATED;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
 }
 
@@ -57,20 +78,43 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = -1;
-	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * COM_NUMBER_OF_CHANNELS, "COM_MemoryBuffer");
+	this->m_datatype = (memoryProxy) ? memoryProxy->getDataType() : COM_DT_COLOR;
+	this->m_num_channels = num_channels_for_datatype(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_num_channels, "COM_MemoryBuffer");
+	this->m_halfBuffer = NULL;
+	this->m_state = COM_MB_TEMPORARILY;
+	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
+}
+
+MemoryBuffer::MemoryBuffer(DataType datatype, rcti *rect)
+{
+	BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
+	this->m_memoryProxy = NULL;
+	this->m_chunkNumber = -1;
+	this->m_datatype = datatype;
+	this->m_num_channels = num_channels_for_datatype(this->m_datatype);
+	this->m_buffer = (float *)MEM_mallocN(sizeof(float) * determineBufferSize() * this->m_num_channels, "COM_MemoryBuffer");
+	this->m_halfBuffer = NULL;
 	this->m_state = COM_MB_TEMPORARILY;
-	this->m_datatype = COM_DT_COLOR;
 	this->m_chunkWidth = this->m_rect.xmax - this->m_rect.xmin;
 }
+
 MemoryBuffer *MemoryBuffer::duplicate()
 {
-	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	/* the duplicate is always a float buffer, it is used for calculations */
+	MemoryBuffer *result = new MemoryBuffer(this->m_datatype, &this->m_rect);
+	result->m_memoryProxy = this->m_memoryProxy;
+	result->copyContentFrom(this);
 	return result;
 }
 void MemoryBuffer::clear()
 {
-	memset(this->m_buffer, 0, this->determineBufferSize() * COM_NUMBER_OF_CHANNELS * sizeof(float));
+	if (this->m_halfBuffer) {
+		memset(this->m_halfBuffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(unsigned short));
+	}
+	else {
+		memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	}
 }
 
 float *MemoryBuffer::convertToValueBuffer()
@@ -80,10 +124,18 @@ float *MemoryBuffer::convertToValueBuffer()
 
 	float *result = (float *)MEM_mallocN(sizeof(float) * size, __func__);
 
+	if (this->m_halfBuffer) {
+		const unsigned short *hp_src = this->m_halfBuffer;
+		for (i = 0; i < size; i++, hp_src += this->m_num_channels) {
+			result[i] = float_from_half(*hp_src);
+		}
+		return result;
+	}
+
 	const float *fp_src = this->m_buffer;
 	float       *fp_dst = result;
 
-	for (i = 0; i < size; i++, fp_dst++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_dst++, fp_src += this->m_num_channels) {
 		*fp_dst = *fp_src;
 	}
 
@@ -92,13 +144,23 @@ float *MemoryBuffer::convertToValueBuffer()
 
 float MemoryBuffer::getMaximumValue()
 {
-	float result = this->m_buffer[0];
 	const unsigned int size = this->determineBufferSize();
 	unsigned int i;
 
+	if (this->m_halfBuffer) {
+		float result = float_from_half(this->m_halfBuffer[0]);
+		const unsigned short *hp_src = this->m_halfBuffer;
+		for (i = 0; i < size; i++, hp_src += this->m_num_channels) {
+			result = max_ff(result, float_from_half(*hp_src));
+		}
+		return result;
+	}
+
+	float result = this->m_buffer[0];
+
 	const float *fp_src = this->m_buffer;
 
-	for (i = 0; i < size; i++, fp_src += COM_NUMBER_OF_CHANNELS) {
+	for (i = 0; i < size; i++, fp_src += this->m_num_channels) {
 		float value = *fp_src;
 		if (value > result) {
 			result = value;
@@ -116,7 +178,7 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 	BLI_rcti_isect(rect, &this->m_rect, &rect_clamp);
 
 	if (!BLI_rcti_is_empty(&rect_clamp)) {
-		MemoryBuffer *temp = new MemoryBuffer(NULL, &rect_clamp);
+		MemoryBuffer *temp = new MemoryBuffer(this->m_datatype, &rect_clamp);
 		temp->copyContentFrom(this);
 		float result = temp->getMaximumValue();
 		delete temp;
@@ -134,6 +196,10 @@ MemoryBuffer::~MemoryBuffer()
 		MEM_freeN(this->m_buffer);
 		this->m_buffer = NULL;
 	}
+	if (this->m_halfBuffer) {
+		MEM_freeN(this->m_halfBuffer);
+		this->m_halfBuffer = NULL;
+	}
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -142,6 +208,7 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 		BLI_assert(0);
 		return;
 	}
+	BLI_assert(this->m_num_channels == otherBuffer->m_num_channels);
 	unsigned int otherY;
 	unsigned int minX = max(this->m_rect.xmin, otherBuffer->m_rect.xmin);
 	unsigned int maxX = min(this->m_rect.xmax, otherBuffer->m_rect.xmax);
@@ -152,9 +219,21 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 
 
 	for (otherY = minY; otherY < maxY; otherY++) {
-		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * COM_NUMBER_OF_CHANNELS * sizeof(float));
+		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_chunkWidth + minX - otherBuffer->m_rect.xmin) * this->m_num_channels;
+		offset = ((otherY - this->m_rect.ymin) * this->m_chunkWidth + minX - this->m_rect.xmin) * this->m_num_channels;
+		const int num = (maxX - minX) * this->m_num_channels;
+		if (this->m_halfBuffer && otherBuffer->m_halfBuffer) {
+			memcpy(&this->m_halfBuffer[offset], &otherBuffer->m_halfBuffer[otherOffset], num * sizeof(unsigned short));
+		}
+		else if (this->m_halfBuffer) {
+			float_to_half_n(&this->m_halfBuffer[offset], &otherBuffer->m_buffer[otherOffset], num);
+		}
+		else if (otherBuffer->m_halfBuffer) {
+			half_to_float_n(&this->m_buffer[offset], &otherBuffer->m_halfBuffer[otherOffset], num);
+		}
+		else {
+			memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], num * sizeof(float));
+		}
 	}
 }
 
@@ -163,8 +242,45 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		copy_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		if (this->m_halfBuffer) {
+			float_to_half_n(&this->m_halfBuffer[offset], color, this->m_num_channels);
+		}
+		else {
+			memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+		}
+	}
+}
+
+void MemoryBuffer::writeRow(int x, int y, int num, const float *row)
+{
+	BLI_assert(x >= this->m_rect.xmin && x + num <= this->m_rect.xmax &&
+	           y >= this->m_rect.ymin && y < this->m_rect.ymax);
+
+	const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+
+	if (this->m_halfBuffer) {
+		unsigned short *dst = &this->m_halfBuffer[offset];
+		if (this->m_num_channels == COM_NUMBER_OF_CHANNELS) {
+			float_to_half_n(dst, row, COM_NUMBER_OF_CHANNELS * num);
+		}
+		else {
+			for (int i = 0; i < num; i++, dst += this->m_num_channels, row += COM_NUMBER_OF_CHANNELS) {
+				float_to_half_n(dst, row, this->m_num_channels);
+			}
+		}
+		return;
+	}
+
+	float *dst = &this->m_buffer[offset];
+
+	if (this->m_num_channels == COM_NUMBER_OF_CHANNELS) {
+		memcpy(dst, row, sizeof(float) * COM_NUMBER_OF_CHANNELS * num);
+	}
+	else {
+		for (int i = 0; i < num; i++, dst += this->m_num_channels, row += COM_NUMBER_OF_CHANNELS) {
+			memcpy(dst, row, sizeof(float) * this->m_num_channels);
+		}
 	}
 }
 
@@ -173,8 +289,17 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	if (x >= this->m_rect.xmin && x < this->m_rect.xmax &&
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
-		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * COM_NUMBER_OF_CHANNELS;
-		add_v4_v4(&this->m_buffer[offset], color);
+		const int offset = (this->m_chunkWidth * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		if (this->m_halfBuffer) {
+			for (int c = 0; c < this->m_num_channels; c++) {
+				this->m_halfBuffer[offset + c] = half_from_float(float_from_half(this->m_halfBuffer[offset + c]) + color[c]);
+			}
+		}
+		else {
+			for (int c = 0; c < this->m_num_channels; c++) {
+				this->m_buffer[offset + c] += color[c];
+			}
+		}
 	}
 }
 
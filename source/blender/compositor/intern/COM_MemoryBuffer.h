@@ -28,6 +28,7 @@ class MemoryBuffer;
 #include "COM_ExecutionGroup.h"
 #include "COM_MemoryProxy.h"
 #include "COM_SocketReader.h"
+#include "COM_HalfFloat.h"
 
 extern "C" {
 #  include "BLI_math.h"
@@ -69,6 +70,11 @@ private:
 	 * @brief the type of buffer COM_DT_VALUE, COM_DT_VECTOR, COM_DT_COLOR
 	 */
 	DataType m_datatype;
+
+	/**
+	 * @brief number of floats stored per pixel, depends on the datatype
+	 */
+	int m_num_channels;
 	
 	
 	/**
@@ -97,6 +103,12 @@ private:
 	 */
 	float *m_buffer;
 
+	/**
+	 * @brief the data when stored in half precision, m_buffer is NULL then
+	 * @see MemoryProxy.isHalfFloat
+	 */
+	unsigned short *m_halfBuffer;
+
 public:
 	/**
 	 * @brief construct new MemoryBuffer for a chunk
@@ -107,6 +119,11 @@ public:
 	 * @brief construct new temporarily MemoryBuffer for an area
 	 */
 	MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect);
+
+	/**
+	 * @brief construct new temporarily MemoryBuffer for an area, not related to a MemoryProxy
+	 */
+	MemoryBuffer(DataType datatype, rcti *rect);
 	
 	/**
 	 * @brief destructor
@@ -121,8 +138,25 @@ public:
 	/**
 	 * @brief get the data of this MemoryBuffer
 	 * @note buffer should already be available in memory
+	 * @note NULL for half float buffers, these are only accessed through the read and write methods
 	 */
 	float *getBuffer() { return this->m_buffer; }
+
+	/**
+	 * @brief are the pixels stored in half precision
+	 */
+	bool isHalfFloat() const { return this->m_halfBuffer != NULL; }
+
+	/**
+	 * @brief get the number of floats stored per pixel in the buffer
+	 * @note operations accessing the buffer directly must use this as pixel stride
+	 */
+	int getNumberOfChannels() const { return this->m_num_channels; }
+
+	/**
+	 * @brief get the datatype of the data stored in this buffer
+	 */
+	DataType getDataType() const { return this->m_datatype; }
 	
 	/**
 	 * @brief after execution the state will be set to available by calling this method
@@ -132,6 +166,27 @@ public:
 		this->m_state = COM_MB_AVAILABLE;
 	}
 	
+	/**
+	 * @brief expand the pixel stored at offset to COM_NUMBER_OF_CHANNELS floats
+	 * @note channels that are not stored in this buffer are zero
+	 */
+	inline void readPixel(float result[4], const int offset)
+	{
+		if (this->m_halfBuffer) {
+			if (this->m_num_channels != COM_NUMBER_OF_CHANNELS) {
+				zero_v4(result);
+			}
+			half_to_float_n(result, &this->m_halfBuffer[offset], this->m_num_channels);
+		}
+		else if (this->m_num_channels == COM_NUMBER_OF_CHANNELS) {
+			copy_v4_v4(result, &this->m_buffer[offset]);
+		}
+		else {
+			zero_v4(result);
+			memcpy(result, &this->m_buffer[offset], sizeof(float) * this->m_num_channels);
+		}
+	}
+
 	inline void wrap_pixel(int &x, int &y, MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 	{
 		int w = m_rect.xmax - m_rect.xmin;
@@ -176,8 +231,8 @@ public:
 		}
 		else {
 			wrap_pixel(x, y, extend_x, extend_y);
-			const int offset = (this->m_chunkWidth * y + x) * COM_NUMBER_OF_CHANNELS;
-			copy_v4_v4(result, &this->m_buffer[offset]);
+			const int offset = (this->m_chunkWidth * y + x) * this->m_num_channels;
+			readPixel(result, offset);
 		}
 	}
 
@@ -186,23 +241,65 @@ public:
 	                        MemoryBufferExtend extend_y = COM_MB_CLIP)
 	{
 		wrap_pixel(x, y, extend_x, extend_y);
-		const int offset = (this->m_chunkWidth * y + x) * COM_NUMBER_OF_CHANNELS;
+		const int offset = (this->m_chunkWidth * y + x) * this->m_num_channels;
 
 		BLI_assert(offset >= 0);
-		BLI_assert(offset < this->determineBufferSize() * COM_NUMBER_OF_CHANNELS);
+		BLI_assert(offset < this->determineBufferSize() * this->m_num_channels);
 		BLI_assert(!(extend_x == COM_MB_CLIP && (x < m_rect.xmin || x >= m_rect.xmax)) &&
 		           !(extend_y == COM_MB_CLIP && (y < m_rect.ymin || y >= m_rect.ymax)));
 
 #if 0
 		/* always true */
 		BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
-		           (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
+		           (int)(this->determineBufferSize() * this->m_num_channels));
 #endif
 
-		copy_v4_v4(result, &this->m_buffer[offset]);
+		readPixel(result, offset);
 	}
 	
+	/**
+	 * @brief read num pixels starting at x, y
+	 * @note same as calling read for every pixel, pixels outside the buffer are zero
+	 */
+	inline void readRow(float *result, int x, int y, int num)
+	{
+		const int start = max_ii(x, m_rect.xmin) - x;
+		const int end = min_ii(x + num, m_rect.xmax) - x;
+
+		if (y < m_rect.ymin || y >= m_rect.ymax || start >= end) {
+			memset(result, 0, sizeof(float) * COM_NUMBER_OF_CHANNELS * num);
+			return;
+		}
+
+		if (start > 0)
+			memset(result, 0, sizeof(float) * COM_NUMBER_OF_CHANNELS * start);
+
+		const int offset = (this->m_chunkWidth * (y - m_rect.ymin) + (x + start - m_rect.xmin)) * this->m_num_channels;
+		if (this->m_num_channels == COM_NUMBER_OF_CHANNELS && this->m_halfBuffer) {
+			half_to_float_n(&result[start * COM_NUMBER_OF_CHANNELS], &this->m_halfBuffer[offset],
+			                COM_NUMBER_OF_CHANNELS * (end - start));
+		}
+		else if (this->m_num_channels == COM_NUMBER_OF_CHANNELS) {
+			memcpy(&result[start * COM_NUMBER_OF_CHANNELS], &this->m_buffer[offset],
+			       sizeof(float) * COM_NUMBER_OF_CHANNELS * (end - start));
+		}
+		else {
+			for (int i = start; i < end; i++) {
+				readPixel(&result[i * COM_NUMBER_OF_CHANNELS], offset + (i - start) * this->m_num_channels);
+			}
+		}
+
+		if (end < num)
+			memset(&result[end * COM_NUMBER_OF_CHANNELS], 0, sizeof(float) * COM_NUMBER_OF_CHANNELS * (num - end));
+	}
+
 	void writePixel(int x, int y, const float color[4]);
+
+	/**
+	 * @brief store num pixels of COM_NUMBER_OF_CHANNELS floats, starting at x, y
+	 * @note only the channels of this buffer's datatype are stored, pixels must be inside the buffer
+	 */
+	void writeRow(int x, int y, int num, const float *row);
 	void addPixel(int x, int y, const float color[4]);
 	inline void readBilinear(float result[4], float x, float y,
 	                         MemoryBufferExtend extend_x = COM_MB_CLIP,
@@ -21,12 +21,20 @@
  */
 
 #include "COM_MemoryProxy.h"
+#include "COM_ResultCache.h"
 
 
-MemoryProxy::MemoryProxy()
+MemoryProxy::MemoryProxy(DataType datatype)
 {
 	this->m_writeBufferOperation = NULL;
 	this->m_executor = NULL;
+	this->m_buffer = NULL;
+	this->m_datatype = datatype;
+	this->m_cacheKey = 0;
+	this->m_cacheFlags = COM_RC_UNCACHEABLE;
+	this->m_cached = false;
+	this->m_complete = false;
+	this->m_halfFloat = false;
 }
 
 void MemoryProxy::allocate(unsigned int width, unsigned int height)
@@ -37,14 +45,34 @@ void MemoryProxy::allocate(unsigned int width, unsigned int height)
 	result.ymin = 0;
 	result.ymax = height;
 
+	this->m_complete = false;
+	this->m_cached = false;
+	if (!(this->m_cacheFlags & COM_RC_UNCACHEABLE)) {
+		this->m_buffer = ResultCache::acquire(this->m_cacheKey, this->m_datatype, width, height);
+		if (this->m_buffer) {
+			this->m_cached = true;
+			return;
+		}
+	}
+
 	this->m_buffer = new MemoryBuffer(this, 1, &result);
 }
 
 void MemoryProxy::free()
 {
 	if (this->m_buffer) {
-		delete this->m_buffer;
+		if (this->m_cached) {
+			ResultCache::release(this->m_buffer);
+		}
+		else if (this->m_complete && !(this->m_cacheFlags & COM_RC_UNCACHEABLE)) {
+			ResultCache::store(this->m_cacheKey, this->m_cacheFlags, this->m_buffer);
+		}
+		else {
+			delete this->m_buffer;
+		}
 		this->m_buffer = NULL;
 	}
+	this->m_cached = false;
+	this->m_complete = false;
 }
 
@@ -49,9 +49,9 @@ private:
 	ExecutionGroup *m_executor;
 	
 	/**
-	 * @brief datatype of this MemoryProxy
+	 * @brief datatype of this MemoryProxy, determines the number of channels of the buffer
 	 */
-	/* DataType m_datatype; */ /* UNUSED */
+	DataType m_datatype;
 	
 	/**
 	 * @brief channel information of this buffer
@@ -63,8 +63,33 @@ private:
 	 */
 	MemoryBuffer *m_buffer;
 
+	/**
+	 * @brief key of the result in the ResultCache
+	 */
+	uint64_t m_cacheKey;
+
+	/**
+	 * @brief ResultCacheFlag's of the result
+	 */
+	int m_cacheFlags;
+
+	/**
+	 * @brief the buffer is owned by the ResultCache and already contains the result
+	 */
+	bool m_cached;
+
+	/**
+	 * @brief all chunks of the buffer have been calculated
+	 */
+	bool m_complete;
+
+	/**
+	 * @brief store the buffer in half precision
+	 */
+	bool m_halfFloat;
+
 public:
-	MemoryProxy();
+	MemoryProxy(DataType datatype);
 	
 	/**
 	 * @brief set the ExecutionGroup that can be scheduled to calculate a certain chunk.
@@ -90,12 +115,40 @@ public:
 	WriteBufferOperation *getWriteBufferOperation() { return this->m_writeBufferOperation; }
 
 	/**
-	 * @brief allocate memory of size width x height
+	 * @brief set the key identifying the result in the ResultCache
+	 * @param flags ResultCacheFlag's of the result
+	 */
+	void setCacheKey(uint64_t key, int flags) { this->m_cacheKey = key; this->m_cacheFlags = flags; }
+
+	/**
+	 * @brief store the buffer in half precision
+	 * @note only for buffers that are not accessed directly by complex operations
+	 * @see CompositorContext.useHalfFloatBuffers
+	 */
+	void setHalfFloat(bool halfFloat) { this->m_halfFloat = halfFloat; }
+
+	/**
+	 * @brief is the buffer stored in half precision
+	 */
+	bool isHalfFloat() const { return this->m_halfFloat; }
+
+	/**
+	 * @brief is the buffer taken from the ResultCache, no chunks need to be calculated
+	 */
+	bool isCached() const { return this->m_cached; }
+
+	/**
+	 * @brief mark the buffer as fully calculated, it will be stored in the ResultCache when freed
+	 */
+	void setComplete() { this->m_complete = true; }
+
+	/**
+	 * @brief allocate memory of size width x height, or take it from the ResultCache
 	 */
 	void allocate(unsigned int width, unsigned int height);
 
 	/**
-	 * @brief free the allocated memory
+	 * @brief free the allocated memory, or hand it over to the ResultCache
 	 */
 	void free();
 
@@ -104,6 +157,11 @@ public:
 	 */
 	inline MemoryBuffer *getBuffer() { return this->m_buffer; }
 
+	/**
+	 * @brief get the datatype of the data stored in this MemoryProxy
+	 */
+	inline DataType getDataType() { return this->m_datatype; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
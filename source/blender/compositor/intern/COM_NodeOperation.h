@@ -120,6 +120,12 @@ private:
 	 * @brief reference to the editing bNodeTree, used for break and update callback
 	 */
 	const bNodeTree *m_btree;
+	
+	/**
+	 * @brief the node this operation is converted from, used to report profiling results.
+	 * NULL for operations that are added by the compositor itself (buffers, conversions...)
+	 */
+	bNode *m_bnode;
 
 	/**
 	 * @brief set to truth when resolution for this operation is set
@@ -166,6 +172,8 @@ public:
 	virtual int isSingleThreaded() { return false; }
 
 	void setbNodeTree(const bNodeTree *tree) { this->m_btree = tree; }
+	void setbNode(bNode *node) { this->m_bnode = node; }
+	bNode *getbNode() const { return this->m_bnode; }
 	virtual void initExecution();
 	
 	/**
@@ -19,6 +19,8 @@
  *		Lukas Toenne
  */
 
+#include <typeinfo>
+
 extern "C" {
 #include "BLI_utildefines.h"
 }
@@ -62,6 +64,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 		
 		m_current_node = node;
 		
+		ResultCacheKey node_key;
+		m_current_node_key.flags = ResultCache::addNodeToKey(node_key, *m_context, node->getbNode());
+		m_current_node_key.key = node_key.get();
+		
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(converter, *m_context);
 	}
@@ -122,6 +128,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 	/* create execution groups */
 	group_operations();
 	
+	determine_half_float_buffers();
+	
+	determine_cache_keys();
+	
 	/* transfer resulting operations to the system */
 	system->set_operations(m_operations, m_groups);
 }
@@ -129,6 +139,11 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
 	m_operations.push_back(operation);
+	
+	if (m_current_node) {
+		m_node_keys[operation] = m_current_node_key;
+		operation->setbNode(m_current_node->getbNode());
+	}
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket, NodeOperationInput *operation_socket)
@@ -448,7 +463,7 @@ void NodeOperationBuilder::add_input_buffers(NodeOperation *operation, NodeOpera
 	/* check of other end already has write operation, otherwise add a new one */
 	WriteBufferOperation *writeoperation = find_attached_write_buffer_operation(output);
 	if (!writeoperation) {
-		writeoperation = new WriteBufferOperation();
+		writeoperation = new WriteBufferOperation(output->getDataType());
 		writeoperation->setbNodeTree(m_context->getbNodeTree());
 		addOperation(writeoperation);
 		
@@ -458,7 +473,7 @@ void NodeOperationBuilder::add_input_buffers(NodeOperation *operation, NodeOpera
 	}
 	
 	/* add readbuffer op for the input */
-	ReadBufferOperation *readoperation = new ReadBufferOperation();
+	ReadBufferOperation *readoperation = new ReadBufferOperation(output->getDataType());
 	readoperation->setMemoryProxy(writeoperation->getMemoryProxy());
 	this->addOperation(readoperation);
 	
@@ -491,7 +506,7 @@ void NodeOperationBuilder::add_output_buffers(NodeOperation *operation, NodeOper
 	
 	/* if no write buffer operation exists yet, create a new one */
 	if (!writeOperation) {
-		writeOperation = new WriteBufferOperation();
+		writeOperation = new WriteBufferOperation(output->getDataType());
 		writeOperation->setbNodeTree(m_context->getbNodeTree());
 		addOperation(writeOperation);
 		
@@ -506,7 +521,7 @@ void NodeOperationBuilder::add_output_buffers(NodeOperation *operation, NodeOper
 		if (&target->getOperation() == writeOperation)
 			continue; /* skip existing write op links */
 		
-		ReadBufferOperation *readoperation = new ReadBufferOperation();
+		ReadBufferOperation *readoperation = new ReadBufferOperation(output->getDataType());
 		readoperation->setMemoryProxy(writeOperation->getMemoryProxy());
 		addOperation(readoperation);
 		
@@ -664,3 +679,127 @@ void NodeOperationBuilder::group_operations()
 		}
 	}
 }
+
+void NodeOperationBuilder::determine_half_float_buffers()
+{
+	if (!m_context->useHalfFloatBuffers())
+		return;
+	
+	/* complex operations access the float data of their input buffers directly */
+	Tags float_proxies;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		
+		if (!op->isComplex())
+			continue;
+		
+		for (int i = 0; i < op->getNumberOfInputSockets(); ++i) {
+			NodeOperationInput *input = op->getInputSocket(i);
+			if (input->isConnected() && input->getLink()->getOperation().isReadBufferOperation()) {
+				ReadBufferOperation *read_op = (ReadBufferOperation *)&input->getLink()->getOperation();
+				float_proxies.insert(read_op->getMemoryProxy()->getWriteBufferOperation());
+			}
+		}
+	}
+	
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		
+		if (op->isWriteBufferOperation() && float_proxies.find(op) == float_proxies.end())
+			((WriteBufferOperation *)op)->getMemoryProxy()->setHalfFloat(true);
+	}
+}
+
+typedef NodeOperationBuilder::CacheKey CacheKey;
+typedef NodeOperationBuilder::CacheKeyMap CacheKeyMap;
+
+static CacheKey operation_cache_key_recursive(CacheKeyMap &keys, const CacheKeyMap &node_keys,
+                                              const CacheKey &context_key, NodeOperation *op)
+{
+	CacheKeyMap::const_iterator found = keys.find(op);
+	if (found != keys.end())
+		return found->second;
+	
+	ResultCacheKey key;
+	int flags = context_key.flags;
+	key.addKey(context_key.key);
+	key.addString(typeid(*op).name());
+	key.addInt(op->getWidth());
+	key.addInt(op->getHeight());
+	
+	CacheKeyMap::const_iterator node_key = node_keys.find(op);
+	if (node_key != node_keys.end()) {
+		key.addKey(node_key->second.key);
+		flags |= node_key->second.flags;
+	}
+	
+	if (op->isSetOperation() && !(flags & COM_RC_UNCACHEABLE)) {
+		/* constants added for unconnected inputs don't belong to a node,
+		 * uncacheable ones (track position) are only valid after initExecution */
+		float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		op->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+		key.addData(value, sizeof(value));
+	}
+	
+	for (int i = 0; i < op->getNumberOfInputSockets(); ++i) {
+		NodeOperationInput *input = op->getInputSocket(i);
+		key.addInt(input->getResizeMode());
+		
+		NodeOperationOutput *link = input->getLink();
+		if (link) {
+			NodeOperation &from_op = link->getOperation();
+			CacheKey from_key = operation_cache_key_recursive(keys, node_keys, context_key, &from_op);
+			key.addKey(from_key.key);
+			flags |= from_key.flags;
+			
+			for (int j = 0; j < from_op.getNumberOfOutputSockets(); ++j) {
+				if (from_op.getOutputSocket(j) == link)
+					key.addInt(j);
+			}
+		}
+		else {
+			key.addInt(-1);
+		}
+	}
+	
+	/* read buffers depend on the operations writing the buffer */
+	if (op->isReadBufferOperation()) {
+		ReadBufferOperation *read_op = (ReadBufferOperation *)op;
+		CacheKey write_key = operation_cache_key_recursive(keys, node_keys, context_key,
+		                                                   read_op->getMemoryProxy()->getWriteBufferOperation());
+		key.addKey(write_key.key);
+		flags |= write_key.flags;
+	}
+	
+	CacheKey result;
+	result.key = key.get();
+	result.flags = flags;
+	keys[op] = result;
+	return result;
+}
+
+void NodeOperationBuilder::determine_cache_keys()
+{
+	ResultCacheKey context_key;
+	ResultCache::addContextToKey(context_key, *m_context);
+	
+	CacheKey context;
+	context.key = context_key.get();
+	/* profiling measures what the nodes cost, results taken from the cache would hide it */
+	context.flags = m_context->isProfiling() ? COM_RC_UNCACHEABLE : 0;
+	
+	CacheKeyMap keys;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		
+		if (op->isWriteBufferOperation()) {
+			WriteBufferOperation *write_op = (WriteBufferOperation *)op;
+			CacheKey key = operation_cache_key_recursive(keys, m_node_keys, context, write_op);
+			/* the same result can be stored in a different precision */
+			ResultCacheKey proxy_key;
+			proxy_key.addKey(key.key);
+			proxy_key.addInt(write_op->getMemoryProxy()->isHalfFloat());
+			write_op->getMemoryProxy()->setCacheKey(proxy_key.get(), key.flags);
+		}
+	}
+}
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "COM_NodeGraph.h"
+#include "COM_ResultCache.h"
 
 using std::vector;
 
@@ -72,6 +73,13 @@ public:
 	typedef std::vector<NodeOperationInput *> OpInputs;
 	typedef std::map<NodeInput *, OpInputs> OpInputInverseMap;
 	
+	/** ResultCache key and ResultCacheFlag's */
+	typedef struct CacheKey {
+		uint64_t key;
+		int flags;
+	} CacheKey;
+	typedef std::map<NodeOperation *, CacheKey> CacheKeyMap;
+	
 private:
 	const CompositorContext *m_context;
 	NodeGraph m_graph;
@@ -87,6 +95,10 @@ private:
 	
 	Node *m_current_node;
 	
+	/** Maps operations to the cache key of the node they are converted from */
+	CacheKeyMap m_node_keys;
+	CacheKey m_current_node_key;
+	
 public:
 	NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree);
 	~NodeOperationBuilder();
@@ -147,6 +159,12 @@ protected:
 	void group_operations();
 	ExecutionGroup *make_group(NodeOperation *op);
 	
+	/** Store buffers in half precision when the context allows it */
+	void determine_half_float_buffers();
+	
+	/** Identify the results of write buffer operations for the ResultCache */
+	void determine_cache_keys();
+	
 private:
 	PreviewOperation *make_preview_operation() const;
 
@@ -23,6 +23,8 @@
 #include "COM_OpenCLDevice.h"
 #include "COM_WorkScheduler.h"
 
+#include "PIL_time.h"
+
 typedef enum COM_VendorID  {NVIDIA = 0x10DE, AMD = 0x1002} COM_VendorID;
 
 OpenCLDevice::OpenCLDevice(cl_context context, cl_device_id device, cl_program program, cl_int vendorId)
@@ -53,6 +55,7 @@ void OpenCLDevice::execute(WorkPackage *work)
 	const unsigned int chunkNumber = work->getChunkNumber();
 	ExecutionGroup *executionGroup = work->getExecutionGroup();
 	rcti rect;
+	const double start_time = PIL_check_seconds_timer();
 
 	executionGroup->determineChunkRect(&rect, chunkNumber);
 	MemoryBuffer **inputBuffers = executionGroup->getInputBuffersOpenCL(chunkNumber);
@@ -63,8 +66,22 @@ void OpenCLDevice::execute(WorkPackage *work)
 
 	delete outputBuffer;
 	
+	executionGroup->profileChunk(start_time, PIL_check_seconds_timer());
 	executionGroup->finalizeChunkExecution(chunkNumber, inputBuffers);
 }
+const cl_image_format *OpenCLDevice::determineImageFormat(MemoryBuffer *memoryBuffer)
+{
+	static const cl_image_format IMAGE_FORMAT_COLOR = {CL_RGBA, CL_FLOAT};
+	static const cl_image_format IMAGE_FORMAT_VALUE = {CL_R, CL_FLOAT};
+
+	/* there are no three channel float images, none of the kernels reads vectors */
+	BLI_assert(memoryBuffer->getNumberOfChannels() != COM_NUM_CHANNELS_VECTOR);
+
+	if (memoryBuffer->getNumberOfChannels() == COM_NUM_CHANNELS_VALUE)
+		return &IMAGE_FORMAT_VALUE;
+	return &IMAGE_FORMAT_COLOR;
+}
+
 cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel, int parameterIndex, int offsetIndex,
                                                                list<cl_mem> *cleanup, MemoryBuffer **inputMemoryBuffers,
                                                                SocketReader *reader)
@@ -80,12 +97,9 @@ cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel,
 	
 	MemoryBuffer *result = reader->getInputMemoryBuffer(inputMemoryBuffers);
 
-	const cl_image_format imageFormat = {
-		CL_RGBA,
-		CL_FLOAT
-	};
+	const cl_image_format *imageFormat = determineImageFormat(result);
 
-	cl_mem clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, &imageFormat, result->getWidth(),
+	cl_mem clBuffer = clCreateImage2D(this->m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, imageFormat, result->getWidth(),
 	                                  result->getHeight(), 0, result->getBuffer(), &error);
 
 	if (error != CL_SUCCESS) { printf("CLERROR[%d]: %s\n", error, clewErrorString(error));  }
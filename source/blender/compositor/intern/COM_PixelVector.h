@@ -0,0 +1,118 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_PixelVector_h_
+#define _COM_PixelVector_h_
+
+#include "COM_defines.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/**
+ * @brief all channels of a single pixel, used by SocketReader.executeRow implementations.
+ * A pixel has COM_NUMBER_OF_CHANNELS floats, with SSE2 it is kept in a single register,
+ * otherwise the functions below fall back to plain per channel math.
+ * @ingroup Execution
+ */
+#ifdef __SSE2__
+
+typedef __m128 PixelVector;
+
+inline PixelVector pixel_load(const float *p) { return _mm_loadu_ps(p); }
+inline void pixel_store(float *p, PixelVector a) { _mm_storeu_ps(p, a); }
+inline PixelVector pixel_set(float f) { return _mm_set1_ps(f); }
+inline PixelVector pixel_add(PixelVector a, PixelVector b) { return _mm_add_ps(a, b); }
+inline PixelVector pixel_sub(PixelVector a, PixelVector b) { return _mm_sub_ps(a, b); }
+inline PixelVector pixel_mul(PixelVector a, PixelVector b) { return _mm_mul_ps(a, b); }
+inline PixelVector pixel_min(PixelVector a, PixelVector b) { return _mm_min_ps(a, b); }
+inline PixelVector pixel_max(PixelVector a, PixelVector b) { return _mm_max_ps(a, b); }
+
+#else
+
+typedef struct PixelVector {
+	float v[4];
+} PixelVector;
+
+inline PixelVector pixel_load(const float *p)
+{
+	PixelVector r = {{p[0], p[1], p[2], p[3]}};
+	return r;
+}
+
+inline void pixel_store(float *p, PixelVector a)
+{
+	p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3];
+}
+
+inline PixelVector pixel_set(float f)
+{
+	PixelVector r = {{f, f, f, f}};
+	return r;
+}
+
+inline PixelVector pixel_add(PixelVector a, PixelVector b)
+{
+	PixelVector r = {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+	return r;
+}
+
+inline PixelVector pixel_sub(PixelVector a, PixelVector b)
+{
+	PixelVector r = {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+	return r;
+}
+
+inline PixelVector pixel_mul(PixelVector a, PixelVector b)
+{
+	PixelVector r = {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+	return r;
+}
+
+inline PixelVector pixel_min(PixelVector a, PixelVector b)
+{
+	PixelVector r = {{a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+	                  a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]}};
+	return r;
+}
+
+inline PixelVector pixel_max(PixelVector a, PixelVector b)
+{
+	PixelVector r = {{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+	                  a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3]}};
+	return r;
+}
+
+#endif
+
+inline PixelVector pixel_clamp(PixelVector a)
+{
+	return pixel_min(pixel_max(a, pixel_set(0.0f)), pixel_set(1.0f));
+}
+
+/**
+ * @brief store a with its alpha channel replaced, most operations pass alpha through unmodified
+ */
+inline void pixel_store_keep_alpha(float *p, PixelVector a, float alpha)
+{
+	pixel_store(p, a);
+	p[3] = alpha;
+}
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "COM_Profiler.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#  include "BLI_fileops.h"
+#  include "BLI_path_util.h"
+#  include "BLI_string.h"
+#  include "DNA_node_types.h"
+#  include "BKE_global.h"
+#  include "BKE_node.h"
+}
+
+typedef std::map<bNode *, double> NodeTimes;
+
+void Profiler::init(ExecutionGroupProfile *profile)
+{
+	profile->chunks = 0;
+	profile->chunk_time = 0.0;
+	profile->chunk_time_min = 0.0;
+	profile->chunk_time_max = 0.0;
+	profile->start_time = 0.0;
+	profile->end_time = 0.0;
+}
+
+void Profiler::add_chunk(ExecutionGroupProfile *profile, double start_time, double end_time)
+{
+	const double time = end_time - start_time;
+
+	if (profile->chunks == 0) {
+		profile->chunk_time_min = time;
+		profile->chunk_time_max = time;
+		profile->start_time = start_time;
+		profile->end_time = end_time;
+	}
+	else {
+		profile->chunk_time_min = std::min(profile->chunk_time_min, time);
+		profile->chunk_time_max = std::max(profile->chunk_time_max, time);
+		profile->start_time = std::min(profile->start_time, start_time);
+		profile->end_time = std::max(profile->end_time, end_time);
+	}
+	profile->chunks++;
+	profile->chunk_time += time;
+}
+
+/* divide the time of each group over the operations that are converted from a node */
+static void get_node_times(const ExecutionSystem *system, NodeTimes &times)
+{
+	const ExecutionSystem::Groups &groups = system->getExecutionGroups();
+
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		const ExecutionGroupProfile &profile = group->getProfile();
+		const ExecutionGroup::Operations &operations = group->getOperations();
+		unsigned int num_operations = 0;
+
+		for (unsigned int i = 0; i < operations.size(); i++) {
+			if (operations[i]->getbNode()) {
+				num_operations++;
+			}
+		}
+		if (num_operations == 0 || profile.chunks == 0) {
+			continue;
+		}
+
+		for (unsigned int i = 0; i < operations.size(); i++) {
+			bNode *node = operations[i]->getbNode();
+			if (node) {
+				times[node] += profile.chunk_time / num_operations;
+			}
+		}
+	}
+}
+
+static void clear_node_times(const bNodeTree *ntree)
+{
+	for (bNode *node = (bNode *)ntree->nodes.first; node; node = node->next) {
+		node->exec_time = 0.0f;
+		if (node->type == NODE_GROUP && node->id) {
+			clear_node_times((const bNodeTree *)node->id);
+		}
+	}
+}
+
+void Profiler::update_nodes(const ExecutionSystem *system)
+{
+	NodeTimes times;
+	get_node_times(system, times);
+
+	clear_node_times(system->getContext().getbNodeTree());
+	for (NodeTimes::iterator it = times.begin(); it != times.end(); ++it) {
+		it->first->exec_time = (float)it->second;
+	}
+}
+
+static bool node_time_greater(const std::pair<bNode *, double> &a, const std::pair<bNode *, double> &b)
+{
+	return a.second > b.second;
+}
+
+static size_t group_buffer_size(ExecutionGroup *group)
+{
+	NodeOperation *operation = group->getOutputOperation();
+	if (!operation->isWriteBufferOperation()) {
+		return 0;
+	}
+
+	MemoryBuffer *buffer = ((WriteBufferOperation *)operation)->getMemoryProxy()->getBuffer();
+	if (!buffer) {
+		return 0;
+	}
+
+	const size_t element_size = buffer->isHalfFloat() ? sizeof(unsigned short) : sizeof(float);
+	return element_size * buffer->getWidth() * buffer->getHeight() * buffer->getNumberOfChannels();
+}
+
+void Profiler::write_report(const ExecutionSystem *system, double execution_time, FILE *fp)
+{
+	const ExecutionSystem::Groups &groups = system->getExecutionGroups();
+	const int num_threads = std::max(WorkScheduler::getNumberOfCPUThreads(), 1);
+	double chunk_time = 0.0;
+	size_t buffer_size = 0;
+
+	fprintf(fp, "Compositor profile of \"%s\"\n\n", system->getContext().getbNodeTree()->id.name + 2);
+
+	fprintf(fp, "Groups:\n");
+	fprintf(fp, "  %5s %11s %7s %10s %10s %10s %10s %8s %10s  %s\n",
+	        "group", "size", "chunks", "total ms", "min ms", "mean ms", "max ms", "threads", "buffer MB", "nodes");
+
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		const ExecutionGroupProfile &profile = group->getProfile();
+		const ExecutionGroup::Operations &operations = group->getOperations();
+		const size_t size = group_buffer_size(group);
+		const double span = profile.end_time - profile.start_time;
+		char size_str[32];
+
+		chunk_time += profile.chunk_time;
+		buffer_size += size;
+
+		BLI_snprintf(size_str, sizeof(size_str), "%ux%u", group->getWidth(), group->getHeight());
+		fprintf(fp, "  %5u %11s %7u %10.2f %10.2f %10.2f %10.2f %8.2f %10.2f  ",
+		        index, size_str, profile.chunks,
+		        profile.chunk_time * 1000.0,
+		        profile.chunk_time_min * 1000.0,
+		        (profile.chunks ? profile.chunk_time / profile.chunks : 0.0) * 1000.0,
+		        profile.chunk_time_max * 1000.0,
+		        /* average number of threads working on the group while it was executed */
+		        (span > 0.0) ? profile.chunk_time / span : 0.0,
+		        size / (1024.0 * 1024.0));
+
+		bNode *last_node = NULL;
+		for (unsigned int i = 0; i < operations.size(); i++) {
+			bNode *node = operations[i]->getbNode();
+			if (node && node != last_node) {
+				fprintf(fp, "%s\"%s\"", last_node ? ", " : "", node->name);
+				last_node = node;
+			}
+		}
+		fprintf(fp, "%s\n", profile.chunks ? "" : " (not executed)");
+	}
+
+	NodeTimes times;
+	get_node_times(system, times);
+	std::vector<std::pair<bNode *, double> > sorted_times(times.begin(), times.end());
+	std::sort(sorted_times.begin(), sorted_times.end(), node_time_greater);
+
+	fprintf(fp, "\nNodes:\n");
+	fprintf(fp, "  %10s %7s  %s\n", "ms", "%", "node");
+	for (unsigned int i = 0; i < sorted_times.size(); i++) {
+		fprintf(fp, "  %10.2f %7.2f  \"%s\"\n",
+		        sorted_times[i].second * 1000.0,
+		        (chunk_time > 0.0) ? 100.0 * sorted_times[i].second / chunk_time : 0.0,
+		        sorted_times[i].first->name);
+	}
+
+	fprintf(fp, "\nExecution time: %.2f ms, chunk time: %.2f ms, threads: %d, occupancy: %.1f%%\n",
+	        execution_time * 1000.0, chunk_time * 1000.0, num_threads,
+	        (execution_time > 0.0) ? 100.0 * chunk_time / (execution_time * num_threads) : 0.0);
+	fprintf(fp, "Group buffers: %.2f MB, peak memory: %.2f MB\n",
+	        buffer_size / (1024.0 * 1024.0), MEM_get_peak_memory() / (1024.0 * 1024.0));
+}
+
+void Profiler::report(const ExecutionSystem *system, double execution_time)
+{
+	char filename[FILE_MAX];
+	BLI_join_dirfile(filename, sizeof(filename), BLI_temporary_dir(), "compositor_profile.txt");
+
+	FILE *fp = BLI_fopen(filename, "w");
+	if (fp) {
+		write_report(system, execution_time, fp);
+		fclose(fp);
+	}
+
+	if (G.background) {
+		write_report(system, execution_time, stdout);
+		fflush(stdout);
+	}
+}
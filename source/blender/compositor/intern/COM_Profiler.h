@@ -0,0 +1,83 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_Profiler_h_
+#define _COM_Profiler_h_
+
+#include <stdio.h>
+
+class ExecutionSystem;
+class ExecutionGroup;
+
+/**
+ * @brief timing statistics of the chunks of an ExecutionGroup
+ * times are in seconds, as returned by PIL_check_seconds_timer
+ * @ingroup Execution
+ */
+typedef struct ExecutionGroupProfile {
+	/** @brief number of chunks executed */
+	unsigned int chunks;
+	/** @brief sum of the time the devices spent on the chunks */
+	double chunk_time;
+	double chunk_time_min;
+	double chunk_time_max;
+	/** @brief start of the first and end of the last chunk */
+	double start_time;
+	double end_time;
+} ExecutionGroupProfile;
+
+/**
+ * @brief aggregates the ExecutionGroupProfile's of an ExecutionSystem
+ *
+ * Enabled with the NTREE_COM_PROFILE flag of the node tree. The operations of an ExecutionGroup
+ * are executed interleaved per chunk, so the time of a group is divided over the operations that
+ * were converted from a node. Buffers and conversions added by the compositor are not counted.
+ * @ingroup Execution
+ */
+class Profiler {
+public:
+	/**
+	 * @brief reset the statistics of a group before its execution
+	 */
+	static void init(ExecutionGroupProfile *profile);
+
+	/**
+	 * @brief add a chunk that was executed from start_time to end_time
+	 * @note not thread safe, the caller locks the group
+	 */
+	static void add_chunk(ExecutionGroupProfile *profile, double start_time, double end_time);
+
+	/**
+	 * @brief store the time spent in each node in bNode.exec_time, shown in the node editor
+	 */
+	static void update_nodes(const ExecutionSystem *system);
+
+	/**
+	 * @brief write the statistics of the groups and nodes of an executed system
+	 * @param execution_time: wall clock time of ExecutionSystem.execute
+	 */
+	static void write_report(const ExecutionSystem *system, double execution_time, FILE *fp);
+
+	/**
+	 * @brief write the report to compositor_profile.txt in the temporary directory
+	 * in background mode the report is also printed
+	 */
+	static void report(const ExecutionSystem *system, double execution_time);
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <list>
+#include <map>
+#include <string.h>
+
+#include "COM_ResultCache.h"
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#  include "DNA_color_types.h"
+#  include "DNA_image_types.h"
+#  include "DNA_node_types.h"
+#  include "DNA_scene_types.h"
+#  include "BKE_image.h"
+#  include "BKE_node.h"
+#  include "RE_pipeline.h"
+}
+
+/* 64 bit FNV-1a */
+ResultCacheKey::ResultCacheKey()
+{
+	this->m_hash = 14695981039346656037ULL;
+}
+
+void ResultCacheKey::addData(const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	uint64_t hash = this->m_hash;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	this->m_hash = hash;
+}
+
+void ResultCacheKey::addString(const char *str)
+{
+	if (str) {
+		addData(str, strlen(str));
+	}
+	addInt(0);
+}
+
+/* ******** Keys ******** */
+
+static void add_curve_mapping_to_key(ResultCacheKey &key, const CurveMapping *cumap)
+{
+	/* the curve points are not part of the node storage */
+	for (int i = 0; i < CM_TOT; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+		key.addInt(cuma->totpoint);
+		if (cuma->curve) {
+			key.addData(cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+		}
+	}
+}
+
+static int add_image_to_key(ResultCacheKey &key, const CompositorContext &context, bNode *node, Image *image)
+{
+	/* only images loaded from disk are identified by their file, reloading them
+	 * is handled by ntreeCompositClearCaches */
+	if (!ELEM3(image->source, IMA_SRC_FILE, IMA_SRC_SEQUENCE, IMA_SRC_MOVIE) || BKE_image_is_dirty(image)) {
+		return COM_RC_UNCACHEABLE;
+	}
+
+	key.addString(image->name);
+	key.addInt(image->source);
+	key.addInt(image->type);
+	key.addString(image->colorspace_settings.name);
+	key.addInt(image->alpha_mode);
+
+	/* still images are shared between frames */
+	if (BKE_image_is_animated(image)) {
+		key.addInt(context.getFramenumber());
+	}
+
+	if (node->type == CMP_NODE_IMAGE && node->storage) {
+		ImageUser iuser = *(ImageUser *)node->storage;
+		iuser.scene = NULL;
+		iuser.framenr = 0;
+		iuser.ok = 0;
+		key.addData(&iuser, sizeof(iuser));
+	}
+	return 0;
+}
+
+int ResultCache::addNodeToKey(ResultCacheKey &key, const CompositorContext &context, bNode *node)
+{
+	int flags = 0;
+
+	key.addInt(node->type);
+	key.addInt(node->custom1);
+	key.addInt(node->custom2);
+	key.addFloat(node->custom3);
+	key.addFloat(node->custom4);
+	key.addPointer(node->id);
+
+	if (node->storage && node->type != CMP_NODE_IMAGE) {
+		key.addData(node->storage, MEM_allocN_len(node->storage));
+	}
+
+	if (ELEM4(node->type, CMP_NODE_CURVE_RGB, CMP_NODE_CURVE_VEC, CMP_NODE_TIME, CMP_NODE_HUECORRECT) && node->storage) {
+		add_curve_mapping_to_key(key, (CurveMapping *)node->storage);
+	}
+
+	/* some nodes read their input values directly */
+	for (bNodeSocket *sock = (bNodeSocket *)node->inputs.first; sock; sock = sock->next) {
+		if (sock->default_value) {
+			key.addData(sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+	}
+
+	if (node->type == CMP_NODE_TIME) {
+		key.addInt(context.getFramenumber());
+	}
+	else if (node->type == CMP_NODE_DEFOCUS) {
+		/* reads the lens settings of the scene camera */
+		flags |= COM_RC_UNCACHEABLE;
+	}
+
+	if (node->id) {
+		switch (GS(node->id->name)) {
+			case ID_IM:
+				flags |= add_image_to_key(key, context, node, (Image *)node->id);
+				break;
+			case ID_SCE:
+				if (node->type == CMP_NODE_R_LAYERS) {
+					/* the render result changes with renders that are not composited and render slots */
+					Render *re = RE_GetRender(node->id->name);
+					key.addInt(re ? RE_GetResultVersion(re) : 0);
+					key.addInt(context.getFramenumber());
+					flags |= COM_RC_RENDER_RESULT;
+				}
+				else {
+					flags |= COM_RC_UNCACHEABLE;
+				}
+				break;
+			default:
+				/* masks, movie clips (tracking data) and textures are edited outside of the node tree */
+				flags |= COM_RC_UNCACHEABLE;
+				break;
+		}
+	}
+
+	return flags;
+}
+
+void ResultCache::addContextToKey(ResultCacheKey &key, const CompositorContext &context)
+{
+	const RenderData *rd = context.getRenderData();
+	const ColorManagedViewSettings *view_settings = context.getViewSettings();
+	const ColorManagedDisplaySettings *display_settings = context.getDisplaySettings();
+
+	key.addInt(context.getQuality());
+	key.addInt(context.isFastCalculation());
+
+	if (rd) {
+		key.addInt(rd->xsch);
+		key.addInt(rd->ysch);
+		key.addInt(rd->size);
+		key.addInt(rd->mode & (R_BORDER | R_CROP));
+		key.addInt(rd->scemode & R_FULL_SAMPLE);
+		key.addData(&rd->border, sizeof(rd->border));
+	}
+	if (view_settings) {
+		key.addString(view_settings->view_transform);
+		key.addString(view_settings->look);
+		key.addFloat(view_settings->exposure);
+		key.addFloat(view_settings->gamma);
+	}
+	if (display_settings) {
+		key.addString(display_settings->display_device);
+	}
+}
+
+/* ******** Cache ******** */
+
+typedef struct ResultCacheEntry {
+	uint64_t key;
+	int flags;
+	int users;
+	size_t size;
+	MemoryBuffer *buffer;
+} ResultCacheEntry;
+
+typedef std::list<ResultCacheEntry> ResultCacheEntries;
+
+/// @brief cached results, the most recently used result is at the front
+static ResultCacheEntries g_entries;
+static std::map<uint64_t, ResultCacheEntries::iterator> g_lookup;
+static size_t g_size = 0;
+
+static size_t buffer_size(MemoryBuffer *buffer)
+{
+	const size_t element_size = buffer->isHalfFloat() ? sizeof(unsigned short) : sizeof(float);
+	return element_size * buffer->getWidth() * buffer->getHeight() * buffer->getNumberOfChannels();
+}
+
+static void free_entry(ResultCacheEntries::iterator entry)
+{
+	g_size -= entry->size;
+	g_lookup.erase(entry->key);
+	delete entry->buffer;
+	g_entries.erase(entry);
+}
+
+static void free_least_recently_used(size_t limit)
+{
+	ResultCacheEntries::iterator entry = g_entries.end();
+	while (g_size > limit && entry != g_entries.begin()) {
+		--entry;
+		if (entry->users == 0) {
+			ResultCacheEntries::iterator next = entry;
+			++next;
+			free_entry(entry);
+			entry = next;
+		}
+	}
+}
+
+MemoryBuffer *ResultCache::acquire(uint64_t key, DataType datatype, unsigned int width, unsigned int height)
+{
+	std::map<uint64_t, ResultCacheEntries::iterator>::iterator found = g_lookup.find(key);
+	if (found == g_lookup.end()) {
+		return NULL;
+	}
+
+	ResultCacheEntries::iterator entry = found->second;
+	MemoryBuffer *buffer = entry->buffer;
+	if (buffer->getDataType() != datatype || (unsigned int)buffer->getWidth() != width || (unsigned int)buffer->getHeight() != height) {
+		return NULL;
+	}
+
+	entry->users++;
+	g_entries.splice(g_entries.begin(), g_entries, entry);
+	return buffer;
+}
+
+void ResultCache::release(MemoryBuffer *buffer)
+{
+	for (ResultCacheEntries::iterator entry = g_entries.begin(); entry != g_entries.end(); ++entry) {
+		if (entry->buffer == buffer) {
+			BLI_assert(entry->users > 0);
+			entry->users--;
+			return;
+		}
+	}
+	BLI_assert(!"buffer not found in result cache");
+}
+
+void ResultCache::store(uint64_t key, int flags, MemoryBuffer *buffer)
+{
+	const size_t limit = (size_t)COM_RESULT_CACHE_LIMIT * 1024 * 1024;
+	const size_t size = buffer_size(buffer);
+
+	if (size > limit || g_lookup.find(key) != g_lookup.end()) {
+		delete buffer;
+		return;
+	}
+
+	ResultCacheEntry entry;
+	entry.key = key;
+	entry.flags = flags;
+	entry.users = 0;
+	entry.size = size;
+	entry.buffer = buffer;
+
+	g_entries.push_front(entry);
+	g_lookup[key] = g_entries.begin();
+	g_size += size;
+
+	free_least_recently_used(limit);
+}
+
+void ResultCache::invalidateRenderResults()
+{
+	ResultCacheEntries::iterator entry = g_entries.begin();
+	while (entry != g_entries.end()) {
+		ResultCacheEntries::iterator next = entry;
+		++next;
+		if ((entry->flags & COM_RC_RENDER_RESULT) && entry->users == 0) {
+			free_entry(entry);
+		}
+		entry = next;
+	}
+}
+
+void ResultCache::clear()
+{
+	free_least_recently_used(0);
+}
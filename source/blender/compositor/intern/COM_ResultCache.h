@@ -0,0 +1,117 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_ResultCache_h_
+#define _COM_ResultCache_h_
+
+#include <stddef.h>
+
+#include "BLI_sys_types.h"
+
+#include "COM_defines.h"
+
+struct bNode;
+class CompositorContext;
+class MemoryBuffer;
+
+/**
+ * @brief flags describing what a cached result depends on
+ * @ingroup Memory
+ */
+typedef enum ResultCacheFlag {
+	/** @brief the result depends on data that is not part of the key (masks, tracking data, painted images...) */
+	COM_RC_UNCACHEABLE = (1 << 0),
+	/** @brief the result depends on a render result and is invalidated by the next render */
+	COM_RC_RENDER_RESULT = (1 << 1)
+} ResultCacheFlag;
+
+/**
+ * @brief hash identifying the result of a MemoryProxy
+ * the key of a result is build from the operations that calculate it: their type,
+ * resolution and settings and recursively the keys of their inputs.
+ * @ingroup Memory
+ */
+class ResultCacheKey {
+private:
+	uint64_t m_hash;
+
+public:
+	ResultCacheKey();
+
+	void addData(const void *data, size_t size);
+	void addInt(int value) { addData(&value, sizeof(value)); }
+	void addFloat(float value) { addData(&value, sizeof(value)); }
+	void addPointer(const void *pointer) { addData(&pointer, sizeof(pointer)); }
+	void addKey(uint64_t key) { addData(&key, sizeof(key)); }
+	void addString(const char *str);
+
+	uint64_t get() const { return this->m_hash; }
+};
+
+/**
+ * @brief cache of MemoryProxy buffers that is kept between executions of the compositor
+ *
+ * When a node near the viewer is tweaked, or a frame is calculated that shares parts of
+ * the tree with the previous one, ExecutionGroups with a cached result are not executed again.
+ * The cache is limited to COM_RESULT_CACHE_LIMIT, the least recently used results are freed first.
+ *
+ * All methods are called with the compositor mutex locked.
+ * @ingroup Memory
+ */
+class ResultCache {
+public:
+	/**
+	 * @brief add the settings of a node to the key of the operations it is converted to
+	 * @return ResultCacheFlag's of the node
+	 */
+	static int addNodeToKey(ResultCacheKey &key, const CompositorContext &context, bNode *node);
+
+	/**
+	 * @brief add the settings of the context that are used during conversion of nodes
+	 */
+	static void addContextToKey(ResultCacheKey &key, const CompositorContext &context);
+
+	/**
+	 * @brief find a cached result, the buffer stays owned by the cache
+	 * @return the buffer or NULL when no result with matching key and size is cached
+	 */
+	static MemoryBuffer *acquire(uint64_t key, DataType datatype, unsigned int width, unsigned int height);
+
+	/**
+	 * @brief give a buffer back that was retrieved with ResultCache.acquire
+	 */
+	static void release(MemoryBuffer *buffer);
+
+	/**
+	 * @brief store a fully calculated result, the cache takes ownership of the buffer
+	 * @param flags: ResultCacheFlag's of the result
+	 */
+	static void store(uint64_t key, int flags, MemoryBuffer *buffer);
+
+	/**
+	 * @brief free all results that depend on a render result
+	 */
+	static void invalidateRenderResults();
+
+	/**
+	 * @brief free all results
+	 */
+	static void clear();
+};
+
+#endif
@@ -90,6 +90,24 @@ protected:
 	 */
 	virtual void executePixelFiltered(float output[4], float x, float y, float dx[2], float dy[2], PixelSampler sampler) {}
 
+	/**
+	 * @brief calculate a row of pixels
+	 * @note this method is called for non-complex, it gives the same result as
+	 * calling executePixelSampled with COM_PS_NEAREST for every pixel in the row.
+	 * Pixel-wise operations override it to read whole rows from their inputs,
+	 * so a chain of them costs a few virtual calls per row instead of per pixel.
+	 * @param output array of COM_NUMBER_OF_CHANNELS floats per pixel to store the result
+	 * @param x the x-coordinate of the first pixel to calculate in image space
+	 * @param y the y-coordinate of the row to calculate in image space
+	 * @param num number of pixels to calculate, at most COM_ROW_SIZE
+	 */
+	virtual void executeRow(float *output, int x, int y, int num) {
+		for (int i = 0; i < num; i++) {
+			executePixelSampled(output, x + i, y, COM_PS_NEAREST);
+			output += COM_NUMBER_OF_CHANNELS;
+		}
+	}
+
 public:
 	inline void readSampled(float result[4], float x, float y, PixelSampler sampler) {
 		executePixelSampled(result, x, y, sampler);
@@ -97,6 +115,9 @@ public:
 	inline void read(float result[4], int x, int y, void *chunkData) {
 		executePixel(result, x, y, chunkData);
 	}
+	inline void readRow(float *result, int x, int y, int num) {
+		executeRow(result, x, y, num);
+	}
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2], PixelSampler sampler) {
 		executePixelFiltered(result, x, y, dx, dy, sampler);
 	}
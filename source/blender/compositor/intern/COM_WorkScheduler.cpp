@@ -34,6 +34,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "PIL_time.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -274,6 +275,63 @@ bool WorkScheduler::hasGPUDevices()
 #endif
 }
 
+int WorkScheduler::getNumberOfCPUThreads()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	return g_cpudevices.size();
+#else
+	return 1;
+#endif
+}
+
+typedef struct ParallelRangeTask {
+	ParallelRangeFunction func;
+	void *userdata;
+	int start;
+	int end;
+} ParallelRangeTask;
+
+static void parallel_range_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	ParallelRangeTask *task = (ParallelRangeTask *)taskdata;
+	task->func(task->userdata, task->start, task->end);
+}
+
+void WorkScheduler::parallelRange(int total, int grain, ParallelRangeFunction func, void *userdata)
+{
+	if (total <= 0) {
+		return;
+	}
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	/* a few ranges per thread, so threads that are slowed down by other work don't delay the result */
+	const int num_ranges = max(getNumberOfCPUThreads(), 1) * 4;
+	const int range_size = max(max(grain, 1), (total + num_ranges - 1) / num_ranges);
+
+	if (range_size < total) {
+		TaskPool *task_pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+		ParallelRangeTask *tasks = (ParallelRangeTask *)MEM_mallocN(sizeof(ParallelRangeTask) * ((total + range_size - 1) / range_size), __func__);
+		int num_tasks = 0;
+
+		for (int start = 0; start < total; start += range_size) {
+			ParallelRangeTask *task = &tasks[num_tasks++];
+			task->func = func;
+			task->userdata = userdata;
+			task->start = start;
+			task->end = min(start + range_size, total);
+			BLI_task_pool_push(task_pool, parallel_range_task, task, false, TASK_PRIORITY_HIGH);
+		}
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+		MEM_freeN(tasks);
+		return;
+	}
+#endif
+
+	func(userdata, 0, total);
+}
+
 static void clContextError(const char *errinfo, const void *private_info, size_t cb, void *user_data)
 {
 	printf("OPENCL error: %s\n", errinfo);
@@ -31,6 +31,11 @@ extern "C" {
 #include "COM_defines.h"
 #include "COM_Device.h"
 
+/**
+ * @brief function called by WorkScheduler::parallelRange for the items [start, end)
+ */
+typedef void (*ParallelRangeFunction)(void *userdata, int start, int end);
+
 /** @brief the workscheduler
  * @ingroup execution
  */
@@ -113,6 +118,20 @@ public:
 	 */
 	static bool hasGPUDevices();
 
+	/**
+	 * @brief number of threads that execute chunks on the CPU
+	 */
+	static int getNumberOfCPUThreads();
+
+	/**
+	 * @brief call func for the items [0, total) in parallel and wait until all are done
+	 * The items are split into ranges of at least grain items that are executed by the task scheduler.
+	 * Used by operations that calculate their whole result at once in initializeTileData, the other
+	 * compositor threads are waiting on the operation in the meantime.
+	 * @note func is called from different threads and must only write to data of its own range
+	 */
+	static void parallelRange(int total, int grain, ParallelRangeFunction func, void *userdata);
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkScheduler")
 #endif
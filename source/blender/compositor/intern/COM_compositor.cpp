@@ -34,13 +34,28 @@ extern "C" {
 #include "COM_WorkScheduler.h"
 #include "OCL_opencl.h"
 #include "COM_MovieDistortionOperation.h"
+#include "COM_ResultCache.h"
 
 static ThreadMutex s_compositorMutex;
 static bool is_compositorMutex_init = false;
 
+/* Testing of cancelled executions, see source/tests/compositor_cache_break.py.
+ * With this debug value the execution is cancelled after a number of break checks,
+ * the count is not exact as it is decremented from multiple threads. */
+#define COM_DEBUG_BREAK_VALUE 3001
+#define COM_DEBUG_BREAK_CHECKS 100
+
+static volatile int s_debugBreakChecks;
+
+static int intern_debugTestBreak(void *UNUSED(handle))
+{
+	return s_debugBreakChecks-- <= 0;
+}
+
 static void intern_freeCompositorCaches()
 {
 	deintializeDistortionCache();
+	ResultCache::clear();
 }
 
 void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rendering,
@@ -78,6 +93,17 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	/* set progress bar to 0% and status to init compositing */
 	editingtree->progress(editingtree->prh, 0.0);
 
+	/* render layers are rendered again before the compositor is executed for rendering */
+	if (rendering) {
+		ResultCache::invalidateRenderResults();
+	}
+
+	int (*test_break)(void *) = editingtree->test_break;
+	if (G.debug_value == COM_DEBUG_BREAK_VALUE) {
+		s_debugBreakChecks = COM_DEBUG_BREAK_CHECKS;
+		editingtree->test_break = intern_debugTestBreak;
+	}
+
 	bool twopass = (editingtree->flag & NTREE_TWO_PASS) > 0 && !rendering;
 	/* initialize execution system */
 	if (twopass) {
@@ -88,6 +114,7 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 		if (editingtree->test_break(editingtree->tbh)) {
 			// during editing multiple calls to this method can be triggered.
 			// make sure one the last one will be doing the work.
+			editingtree->test_break = test_break;
 			BLI_mutex_unlock(&s_compositorMutex);
 			return;
 		}
@@ -98,10 +125,12 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	system->execute();
 	delete system;
 
+	editingtree->test_break = test_break;
+
 	BLI_mutex_unlock(&s_compositorMutex);
 }
 
-static void UNUSED_FUNCTION(COM_freeCaches)()
+void COM_clearCaches(void)
 {
 	if (is_compositorMutex_init) {
 		BLI_mutex_lock(&s_compositorMutex);
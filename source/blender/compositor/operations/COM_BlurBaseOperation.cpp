@@ -21,6 +21,7 @@
  */
 
 #include "COM_BlurBaseOperation.h"
+#include "COM_FastGaussianBlurOperation.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 
@@ -39,6 +40,10 @@ BlurBaseOperation::BlurBaseOperation(DataType data_type) : NodeOperation()
 	memset(&m_data, 0, sizeof(NodeBlurData));
 	this->m_size = 1.0f;
 	this->m_sizeavailable = false;
+	this->m_recursiveRadius = 0.0f;
+	this->m_recursiveAxis = 0;
+	this->m_recursiveBuffer = NULL;
+	this->m_recursiveLines = NULL;
 }
 void BlurBaseOperation::initExecution()
 {
@@ -139,6 +144,197 @@ float *BlurBaseOperation::make_dist_fac_inverse(float rad, int size, int falloff
 	return dist_fac_invert;
 }
 
+/* ******** Recursive blur ******** */
+
+enum {
+	RECURSIVE_LINE_TODO = 0,
+	RECURSIVE_LINE_BUSY = 1,
+	RECURSIVE_LINE_DONE = 2
+};
+
+bool BlurBaseOperation::use_recursive_blur(float rad) const
+{
+	return (rad >= COM_BLUR_CONSTANT_TIME_RADIUS) && ELEM(this->m_data.filtertype, R_FILTER_GAUSS, R_FILTER_BOX);
+}
+
+void BlurBaseOperation::initRecursiveBlur(float rad, int xy)
+{
+	BLI_assert(this->m_recursiveRadius == 0.0f);
+	this->m_recursiveRadius = rad;
+	this->m_recursiveAxis = xy;
+	BLI_mutex_init(&this->m_recursiveMutex);
+	BLI_condition_init(&this->m_recursiveCondition);
+}
+
+void BlurBaseOperation::deinitRecursiveBlur()
+{
+	if (this->m_recursiveRadius == 0.0f) {
+		return;
+	}
+	if (this->m_recursiveBuffer) {
+		delete this->m_recursiveBuffer;
+		this->m_recursiveBuffer = NULL;
+	}
+	if (this->m_recursiveLines) {
+		MEM_freeN(this->m_recursiveLines);
+		this->m_recursiveLines = NULL;
+	}
+	BLI_condition_end(&this->m_recursiveCondition);
+	BLI_mutex_end(&this->m_recursiveMutex);
+	this->m_recursiveRadius = 0.0f;
+}
+
+/* average of all pixels within radius, clipped to the line, using a running sum */
+static void box_blur_line(const float *src, float *dst, int length, int radius)
+{
+	double sum[4] = {0.0, 0.0, 0.0, 0.0};
+	int count = 0;
+
+	for (int i = 0; i <= radius && i < length; i++) {
+		for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+			sum[c] += src[i * COM_NUMBER_OF_CHANNELS + c];
+		}
+		count++;
+	}
+
+	for (int i = 0; i < length; i++) {
+		const int add = i + radius + 1;
+		const int sub = i - radius;
+
+		for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+			dst[i * COM_NUMBER_OF_CHANNELS + c] = (float)(sum[c] / count);
+		}
+		if (add < length) {
+			for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				sum[c] += src[add * COM_NUMBER_OF_CHANNELS + c];
+			}
+			count++;
+		}
+		if (sub >= 0) {
+			for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				sum[c] -= src[sub * COM_NUMBER_OF_CHANNELS + c];
+			}
+			count--;
+		}
+	}
+}
+
+void BlurBaseOperation::blur_recursive_line(MemoryBuffer *input, int line)
+{
+	const rcti *rect = input->getRect();
+	const bool along_x = (this->m_recursiveAxis == 1);
+	const int length = along_x ? BLI_rcti_size_x(rect) : BLI_rcti_size_y(rect);
+
+	rcti line_rect;
+	if (along_x) {
+		BLI_rcti_init(&line_rect, 0, length, 0, 1);
+	}
+	else {
+		BLI_rcti_init(&line_rect, 0, 1, 0, length);
+	}
+	MemoryBuffer *src = new MemoryBuffer(COM_DT_COLOR, &line_rect);
+	float *src_data = src->getBuffer();
+
+	for (int i = 0; i < length; i++) {
+		if (along_x) {
+			input->read(&src_data[i * COM_NUMBER_OF_CHANNELS], rect->xmin + i, rect->ymin + line);
+		}
+		else {
+			input->read(&src_data[i * COM_NUMBER_OF_CHANNELS], rect->xmin + line, rect->ymin + i);
+		}
+	}
+
+	MemoryBuffer *dst = src;
+	if (this->m_data.filtertype == R_FILTER_GAUSS) {
+		/* sigma of the gaussian in RE_filter_value, exp(-(1.6 x)^2) with x normalized to the radius */
+		const float sigma = this->m_recursiveRadius / (1.6f * (float)M_SQRT2);
+		for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+			FastGaussianBlurOperation::IIR_gauss(src, sigma, c, this->m_recursiveAxis);
+		}
+	}
+	else {
+		dst = new MemoryBuffer(COM_DT_COLOR, &line_rect);
+		box_blur_line(src_data, dst->getBuffer(), length, (int)this->m_recursiveRadius);
+	}
+
+	const float *dst_data = dst->getBuffer();
+	for (int i = 0; i < length; i++) {
+		if (along_x) {
+			this->m_recursiveBuffer->writePixel(rect->xmin + i, rect->ymin + line, &dst_data[i * COM_NUMBER_OF_CHANNELS]);
+		}
+		else {
+			this->m_recursiveBuffer->writePixel(rect->xmin + line, rect->ymin + i, &dst_data[i * COM_NUMBER_OF_CHANNELS]);
+		}
+	}
+
+	if (dst != src) {
+		delete dst;
+	}
+	delete src;
+}
+
+MemoryBuffer *BlurBaseOperation::getRecursiveBlur(MemoryBuffer *input, rcti *rect)
+{
+	rcti *input_rect = input->getRect();
+	int first, last;
+
+	if (this->m_recursiveAxis == 1) {
+		first = max_ii(rect->ymin, input_rect->ymin) - input_rect->ymin;
+		last = min_ii(rect->ymax, input_rect->ymax) - input_rect->ymin;
+	}
+	else {
+		first = max_ii(rect->xmin, input_rect->xmin) - input_rect->xmin;
+		last = min_ii(rect->xmax, input_rect->xmax) - input_rect->xmin;
+	}
+
+	BLI_mutex_lock(&this->m_recursiveMutex);
+	if (this->m_recursiveBuffer == NULL) {
+		const int num_lines = (this->m_recursiveAxis == 1) ? BLI_rcti_size_y(input_rect) : BLI_rcti_size_x(input_rect);
+		this->m_recursiveBuffer = new MemoryBuffer(COM_DT_COLOR, input_rect);
+		this->m_recursiveLines = (char *)MEM_callocN(sizeof(char) * num_lines, __func__);
+	}
+
+	if (first >= last) {
+		BLI_mutex_unlock(&this->m_recursiveMutex);
+		return this->m_recursiveBuffer;
+	}
+
+	/* claim the lines no other chunk is working on */
+	char *claimed = (char *)MEM_callocN(sizeof(char) * (last - first), __func__);
+	for (int line = first; line < last; line++) {
+		if (this->m_recursiveLines[line] == RECURSIVE_LINE_TODO) {
+			this->m_recursiveLines[line] = RECURSIVE_LINE_BUSY;
+			claimed[line - first] = 1;
+		}
+	}
+	BLI_mutex_unlock(&this->m_recursiveMutex);
+
+	for (int line = first; line < last; line++) {
+		if (claimed[line - first]) {
+			blur_recursive_line(input, line);
+		}
+	}
+
+	BLI_mutex_lock(&this->m_recursiveMutex);
+	for (int line = first; line < last; line++) {
+		if (claimed[line - first]) {
+			this->m_recursiveLines[line] = RECURSIVE_LINE_DONE;
+		}
+	}
+	BLI_condition_notify_all(&this->m_recursiveCondition);
+
+	/* wait for the lines calculated by other chunks */
+	for (int line = first; line < last; line++) {
+		while (this->m_recursiveLines[line] != RECURSIVE_LINE_DONE) {
+			BLI_condition_wait(&this->m_recursiveCondition, &this->m_recursiveMutex);
+		}
+	}
+	BLI_mutex_unlock(&this->m_recursiveMutex);
+
+	MEM_freeN(claimed);
+	return this->m_recursiveBuffer;
+}
+
 void BlurBaseOperation::deinitExecution()
 {
 	this->m_inputProgram = NULL;
@@ -38,6 +38,25 @@ protected:
 
 	void updateSize();
 
+	/**
+	 * @brief should a blur with this radius use the recursive implementation
+	 * @see COM_BLUR_CONSTANT_TIME_RADIUS
+	 */
+	bool use_recursive_blur(float rad) const;
+
+	/**
+	 * @brief prepare a recursive blur along a single axis
+	 * @param xy: 1 to blur along the x axis, 2 along the y axis
+	 */
+	void initRecursiveBlur(float rad, int xy);
+	void deinitRecursiveBlur();
+
+	/**
+	 * @brief get the recursively blurred input, calculating the lines needed for rect
+	 * every line is calculated once, by the first chunk that needs it.
+	 */
+	MemoryBuffer *getRecursiveBlur(MemoryBuffer *input, rcti *rect);
+
 	/**
 	 * Cached reference to the inputProgram
 	 */
@@ -48,6 +67,22 @@ protected:
 	float m_size;
 	bool m_sizeavailable;
 
+	/**
+	 * @brief radius of the recursive blur, 0 when the filter table is used
+	 */
+	float m_recursiveRadius;
+
+private:
+	int m_recursiveAxis;
+	MemoryBuffer *m_recursiveBuffer;
+	/** state of every line of m_recursiveBuffer, see getRecursiveBlur */
+	char *m_recursiveLines;
+	ThreadMutex m_recursiveMutex;
+	ThreadCondition m_recursiveCondition;
+
+	void blur_recursive_line(MemoryBuffer *input, int line);
+
+
 public:
 	/**
 	 * Initialize the execution
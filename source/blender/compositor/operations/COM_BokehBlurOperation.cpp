@@ -23,6 +23,9 @@
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
+#include "COM_FFTConvolution.h"
+
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 #  include "RE_pipeline.h"
@@ -43,6 +46,13 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	this->m_convolved = NULL;
+}
+
+int BokehBlurOperation::getPixelSize()
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	return this->m_size * max_dim / 100.0f;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti *rect)
@@ -51,11 +61,91 @@ void *BokehBlurOperation::initializeTileData(rcti *rect)
 	if (!this->m_sizeavailable) {
 		updateSize();
 	}
-	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	MemoryBuffer *buffer = (MemoryBuffer *)getInputOperation(0)->initializeTileData(NULL);
+	if (!this->m_convolved) {
+		const int pixelSize = getPixelSize();
+		if (pixelSize >= COM_FFT_CONVOLUTION_RADIUS) {
+			this->m_convolved = createConvolvedBuffer(buffer, pixelSize);
+		}
+	}
 	unlockMutex();
 	return buffer;
 }
 
+/* Same result as executePixel at full quality for all pixels: the weighted sum of the pixels
+ * in [x - pixelSize, x + pixelSize) is a convolution with the bokeh, the sum of the weights
+ * inside the image is looked up in a summed area table of the bokeh. */
+MemoryBuffer *BokehBlurOperation::createConvolvedBuffer(MemoryBuffer *inputBuffer, int pixelSize)
+{
+	const int width = inputBuffer->getWidth();
+	const int height = inputBuffer->getHeight();
+	const int kernelSize = 2 * pixelSize + 1;
+	const int tableSize = kernelSize + 1;
+	const float m = this->m_bokehDimension / pixelSize;
+	float bokeh[4];
+
+	/* kernel pixel (i, j) weighs the input pixel at offset (pixelSize - i, pixelSize - j) */
+	rcti kernelRect;
+	BLI_rcti_init(&kernelRect, 0, kernelSize, 0, kernelSize);
+	MemoryBuffer *kernel = new MemoryBuffer(COM_DT_COLOR, &kernelRect);
+	float *kernelBuffer = kernel->getBuffer();
+	memset(kernelBuffer, 0, sizeof(float) * kernelSize * kernelSize * COM_NUMBER_OF_CHANNELS);
+
+	/* table[(b * tableSize + a)] is the sum of the weights of the offsets (dx, dy) < (a, b) - pixelSize */
+	double *table = (double *)MEM_callocN(sizeof(double) * tableSize * tableSize * COM_NUMBER_OF_CHANNELS, __func__);
+
+	for (int b = 0; b < kernelSize; b++) {
+		const int dy = b - pixelSize;
+		for (int a = 0; a < kernelSize; a++) {
+			const int dx = a - pixelSize;
+			double *sum = &table[((b + 1) * tableSize + a + 1) * COM_NUMBER_OF_CHANNELS];
+			const double *left = sum - COM_NUMBER_OF_CHANNELS;
+			const double *up = sum - tableSize * COM_NUMBER_OF_CHANNELS;
+			const double *upleft = up - COM_NUMBER_OF_CHANNELS;
+
+			/* the window of executePixel excludes the offset pixelSize */
+			if (dx < pixelSize && dy < pixelSize) {
+				this->m_inputBokehProgram->readSampled(bokeh, this->m_bokehMidX - dx * m, this->m_bokehMidY - dy * m, COM_PS_NEAREST);
+				copy_v4_v4(&kernelBuffer[((pixelSize - dy) * kernelSize + pixelSize - dx) * COM_NUMBER_OF_CHANNELS], bokeh);
+			}
+			else {
+				zero_v4(bokeh);
+			}
+			for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				sum[c] = bokeh[c] + left[c] + up[c] - upleft[c];
+			}
+		}
+	}
+
+	rcti rect;
+	BLI_rcti_init(&rect, 0, width, 0, height);
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, &rect);
+	float *resultBuffer = result->getBuffer();
+	FFTConvolution::convolve(resultBuffer, inputBuffer, kernel, COM_NUMBER_OF_CHANNELS);
+	delete kernel;
+
+	for (int y = 0; y < height; y++) {
+		const int b0 = max(-pixelSize, -y) + pixelSize;
+		const int b1 = min(pixelSize, height - y) + pixelSize;
+		for (int x = 0; x < width; x++) {
+			const int a0 = max(-pixelSize, -x) + pixelSize;
+			const int a1 = min(pixelSize, width - x) + pixelSize;
+			const double *s00 = &table[(b0 * tableSize + a0) * COM_NUMBER_OF_CHANNELS];
+			const double *s01 = &table[(b0 * tableSize + a1) * COM_NUMBER_OF_CHANNELS];
+			const double *s10 = &table[(b1 * tableSize + a0) * COM_NUMBER_OF_CHANNELS];
+			const double *s11 = &table[(b1 * tableSize + a1) * COM_NUMBER_OF_CHANNELS];
+			float *color = &resultBuffer[(y * width + x) * COM_NUMBER_OF_CHANNELS];
+
+			for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				color[c] *= 1.0f / (float)(s11[c] - s01[c] - s10[c] + s00[c]);
+			}
+		}
+	}
+
+	MEM_freeN(table);
+	return result;
+}
+
 void BokehBlurOperation::initExecution()
 {
 	initMutex();
@@ -81,7 +171,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_convolved) {
+		this->m_convolved->read(output, x, y);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -137,6 +230,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
 	deinitMutex();
+	if (this->m_convolved) {
+		delete this->m_convolved;
+		this->m_convolved = NULL;
+	}
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
@@ -161,6 +258,15 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 		newInput.ymin = input->ymin - (10.0f * max_dim / 100.0f);
 	}
 
+	/* the FFT convolution of initializeTileData needs the whole input, when the size is
+	 * not known yet it can be up to 10% of the image */
+	if ((this->m_sizeavailable ? getPixelSize() : (int)(10.0f * max_dim / 100.0f)) >= COM_FFT_CONVOLUTION_RADIUS) {
+		newInput.xmin = 0;
+		newInput.ymin = 0;
+		newInput.xmax = this->getWidth();
+		newInput.ymax = this->getHeight();
+	}
+
 	NodeOperation *operation = getInputOperation(1);
 	bokehInput.xmax = operation->getWidth();
 	bokehInput.xmin = 0;
@@ -37,6 +37,11 @@ private:
 	float m_bokehMidX;
 	float m_bokehMidY;
 	float m_bokehDimension;
+	/** @brief result of the FFT convolution for large radii, NULL when the bokeh is evaluated per pixel */
+	MemoryBuffer *m_convolved;
+
+	int getPixelSize();
+	MemoryBuffer *createConvolvedBuffer(MemoryBuffer *inputBuffer, int pixelSize);
 public:
 	BokehBlurOperation();
 
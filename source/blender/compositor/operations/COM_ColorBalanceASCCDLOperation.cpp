@@ -21,6 +21,7 @@
  */
 
 #include "COM_ColorBalanceASCCDLOperation.h"
+#include "COM_PixelVector.h"
 #include "BLI_math.h"
 
 inline float colorbalance_cdl(float in, float offset, float power, float slope)
@@ -68,6 +69,35 @@ void ColorBalanceASCCDLOperation::executePixelSampled(float output[4], float x,
 
 }
 
+void ColorBalanceASCCDLOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputColor[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float value[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	const float slope[4] = {this->m_slope[0], this->m_slope[1], this->m_slope[2], 1.0f};
+	const float offset[4] = {this->m_offset[0], this->m_offset[1], this->m_offset[2], 0.0f};
+	const PixelVector slope_v = pixel_load(slope);
+	const PixelVector offset_v = pixel_load(offset);
+
+	this->m_inputValueOperation->readRow(value, x, y, num);
+	this->m_inputColorOperation->readRow(inputColor, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float fac = min(1.0f, value[i]);
+		const PixelVector color = pixel_load(&inputColor[i]);
+		float balanced[4];
+
+		/* same as colorbalance_cdl, only the power is done per channel */
+		pixel_store(balanced, pixel_clamp(pixel_add(pixel_mul(color, slope_v), offset_v)));
+		balanced[0] = powf(balanced[0], this->m_power[0]);
+		balanced[1] = powf(balanced[1], this->m_power[1]);
+		balanced[2] = powf(balanced[2], this->m_power[2]);
+
+		const PixelVector result = pixel_add(pixel_mul(pixel_set(1.0f - fac), color),
+		                                     pixel_mul(pixel_set(fac), pixel_load(balanced)));
+		pixel_store_keep_alpha(&output[i], result, inputColor[i + 3]);
+	}
+}
+
 void ColorBalanceASCCDLOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
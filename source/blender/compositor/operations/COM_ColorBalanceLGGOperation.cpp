@@ -21,6 +21,7 @@
  */
 
 #include "COM_ColorBalanceLGGOperation.h"
+#include "COM_PixelVector.h"
 #include "BLI_math.h"
 
 
@@ -73,6 +74,30 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4], float x, flo
 
 }
 
+void ColorBalanceLGGOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputColor[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float value[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	this->m_inputValueOperation->readRow(value, x, y, num);
+	this->m_inputColorOperation->readRow(inputColor, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		const float fac = min(1.0f, value[i]);
+		const PixelVector color = pixel_load(&inputColor[i]);
+		float balanced[4];
+
+		balanced[0] = colorbalance_lgg(inputColor[i + 0], this->m_lift[0], this->m_gamma_inv[0], this->m_gain[0]);
+		balanced[1] = colorbalance_lgg(inputColor[i + 1], this->m_lift[1], this->m_gamma_inv[1], this->m_gain[1]);
+		balanced[2] = colorbalance_lgg(inputColor[i + 2], this->m_lift[2], this->m_gamma_inv[2], this->m_gain[2]);
+		balanced[3] = 0.0f;
+
+		const PixelVector result = pixel_add(pixel_mul(pixel_set(1.0f - fac), color),
+		                                     pixel_mul(pixel_set(fac), pixel_load(balanced)));
+		pixel_store_keep_alpha(&output[i], result, inputColor[i + 3]);
+	}
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
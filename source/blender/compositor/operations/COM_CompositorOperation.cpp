@@ -127,7 +127,7 @@ void CompositorOperation::deinitExecution()
 
 void CompositorOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 {
-	float color[8]; // 7 is enough
+	float row[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
 	float *buffer = this->m_outputBuffer;
 	float *zbuffer = this->m_depthBuffer;
 
@@ -184,20 +184,25 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int tileNumber)
 #endif
 
 	for (y = y1; y < y2 && (!breaked); y++) {
-		for (x = x1; x < x2 && (!breaked); x++) {
+		for (x = x1; x < x2 && (!breaked); x += COM_ROW_SIZE) {
+			const int num = min(COM_ROW_SIZE, x2 - x);
 			int input_x = x + dx, input_y = y + dy;
+			int i;
 
-			this->m_imageInput->readSampled(color, input_x, input_y, COM_PS_NEAREST);
+			this->m_imageInput->readRow(buffer + offset4, input_x, input_y, num);
 			if (this->m_useAlphaInput) {
-				this->m_alphaInput->readSampled(&(color[3]), input_x, input_y, COM_PS_NEAREST);
+				this->m_alphaInput->readRow(row, input_x, input_y, num);
+				for (i = 0; i < num; i++) {
+					buffer[offset4 + i * COM_NUMBER_OF_CHANNELS + 3] = row[i * COM_NUMBER_OF_CHANNELS];
+				}
 			}
 
-			copy_v4_v4(buffer + offset4, color);
-
-			this->m_depthInput->readSampled(color, input_x, input_y, COM_PS_NEAREST);
-			zbuffer[offset] = color[0];
-			offset4 += COM_NUMBER_OF_CHANNELS;
-			offset++;
+			this->m_depthInput->readRow(row, input_x, input_y, num);
+			for (i = 0; i < num; i++) {
+				zbuffer[offset + i] = row[i * COM_NUMBER_OF_CHANNELS];
+			}
+			offset4 += num * COM_NUMBER_OF_CHANNELS;
+			offset += num;
 			if (isBreaked()) {
 				breaked = true;
 			}
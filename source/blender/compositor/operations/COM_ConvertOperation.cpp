@@ -55,6 +55,17 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4], float x,
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeRow(float *output, int x, int y, int num)
+{
+	/* convert in place, every pixel in output has room for all channels */
+	this->m_inputOperation->readRow(output, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i + 1] = output[i + 2] = output[i];
+		output[i + 3] = 1.0f;
+	}
+}
+
 
 /* ******** Color to Value ******** */
 
@@ -71,6 +82,15 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4], float x,
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeRow(float *output, int x, int y, int num)
+{
+	this->m_inputOperation->readRow(output, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = (output[i] + output[i + 1] + output[i + 2]) / 3.0f;
+	}
+}
+
 
 /* ******** Color to BW ******** */
 
@@ -87,6 +107,15 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, fl
 	output[0] = rgb_to_bw(inputColor);
 }
 
+void ConvertColorToBWOperation::executeRow(float *output, int x, int y, int num)
+{
+	this->m_inputOperation->readRow(output, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = rgb_to_bw(&output[i]);
+	}
+}
+
 
 /* ******** Color to Vector ******** */
 
@@ -101,6 +130,11 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x
 	this->m_inputOperation->readSampled(output, x, y, sampler);
 }
 
+void ConvertColorToVectorOperation::executeRow(float *output, int x, int y, int num)
+{
+	this->m_inputOperation->readRow(output, x, y, num);
+}
+
 
 /* ******** Value to Vector ******** */
 
@@ -120,6 +154,16 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x
 	output[3] = 0.0f;
 }
 
+void ConvertValueToVectorOperation::executeRow(float *output, int x, int y, int num)
+{
+	this->m_inputOperation->readRow(output, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i + 1] = output[i + 2] = output[i];
+		output[i + 3] = 0.0f;
+	}
+}
+
 
 /* ******** Vector to Color ******** */
 
@@ -135,6 +179,15 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x
 	output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeRow(float *output, int x, int y, int num)
+{
+	this->m_inputOperation->readRow(output, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i + 3] = 1.0f;
+	}
+}
+
 
 /* ******** Vector to Value ******** */
 
@@ -151,6 +204,15 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x
 	output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeRow(float *output, int x, int y, int num)
+{
+	this->m_inputOperation->readRow(output, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i] = (output[i] + output[i + 1] + output[i + 2]) / 3.0f;
+	}
+}
+
 
 /* ******** RGB to YCC ******** */
 
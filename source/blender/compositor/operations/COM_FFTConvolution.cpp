@@ -0,0 +1,394 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "COM_FFTConvolution.h"
+#include "COM_WorkScheduler.h"
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#  include "BLI_math.h"
+}
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+typedef float fREAL;
+
+// returns next highest power of 2 of x, as well it's log2 in L2
+static unsigned int nextPow2(unsigned int x, unsigned int *L2)
+{
+	unsigned int pw, x_notpow2 = x & (x - 1);
+	*L2 = 0;
+	while (x >>= 1) ++(*L2);
+	pw = 1 << (*L2);
+	if (x_notpow2) { (*L2)++;  pw <<= 1; }
+	return pw;
+}
+
+//------------------------------------------------------------------------------
+
+// from FXT library by Joerg Arndt, faster in order bitreversal
+// use: r = revbin_upd(r, h) where h = N>>1
+static unsigned int revbin_upd(unsigned int r, unsigned int h)
+{
+	while (!((r ^= h) & h)) h >>= 1;
+	return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
+{
+	double tt, fc, dc, fs, ds, a = M_PI;
+	fREAL t1, t2;
+	int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+	int i, j = 0;
+	unsigned int Nh = len >> 1;
+	for (i = 1; i < (len - 1); ++i) {
+		j = revbin_upd(j, Nh);
+		if (j > i) {
+			t1 = data[i];
+			data[i] = data[j];
+			data[j] = t1;
+		}
+	}
+
+	do {
+		fREAL *data_n = &data[n];
+
+		istep = n << 1;
+		for (k = 0; k < len; k += istep) {
+			t1 = data_n[k];
+			data_n[k] = data[k] - t1;
+			data[k] += t1;
+		}
+
+		n2 = n >> 1;
+		if (n > 2) {
+			fc = dc = cos(a);
+			fs = ds = sqrt(1.0 - fc * fc); //sin(a);
+			bd = n - 2;
+			for (bl = 1; bl < n2; bl++) {
+				fREAL *data_nbd = &data_n[bd];
+				fREAL *data_bd = &data[bd];
+				for (k = bl; k < len; k += istep) {
+					t1 = fc * (double)data_n[k] + fs * (double)data_nbd[k];
+					t2 = fs * (double)data_n[k] - fc * (double)data_nbd[k];
+					data_n[k] = data[k] - t1;
+					data_nbd[k] = data_bd[k] - t2;
+					data[k] += t1;
+					data_bd[k] += t2;
+				}
+				tt = fc * dc - fs * ds;
+				fs = fs * dc + fc * ds;
+				fc = tt;
+				bd -= 2;
+			}
+		}
+
+		if (n > 1) {
+			for (k = n2; k < len; k += istep) {
+				t1 = data_n[k];
+				data_n[k] = data[k] - t1;
+				data[k] += t1;
+			}
+		}
+
+		n = istep;
+		a *= 0.5;
+	} while (n < len);
+
+	if (inverse) {
+		fREAL sc = (fREAL)1 / (fREAL)len;
+		for (k = 0; k < len; ++k)
+			data[k] *= sc;
+	}
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above */
+static void FHT2D(fREAL *data, unsigned int Mx, unsigned int My,
+                  unsigned int nzp, unsigned int inverse)
+{
+	unsigned int i, j, Nx, Ny, maxy;
+	fREAL t;
+
+	Nx = 1 << Mx;
+	Ny = 1 << My;
+
+	// rows (forward transform skips 0 pad data)
+	maxy = inverse ? Ny : nzp;
+	for (j = 0; j < maxy; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// transpose data
+	if (Nx == Ny) {  // square
+		for (j = 0; j < Ny; ++j)
+			for (i = j + 1; i < Nx; ++i) {
+				unsigned int op = i + (j << Mx), np = j + (i << My);
+				t = data[op], data[op] = data[np], data[np] = t;
+			}
+	}
+	else {  // rectangular
+		unsigned int k, Nym = Ny - 1, stm = 1 << (Mx + My);
+		for (i = 0; stm > 0; i++) {
+#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+			for (j = PRED(i); j > i; j = PRED(j)) ;
+			if (j < i) continue;
+			for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+				t = data[j], data[j] = data[k], data[k] = t;
+			}
+#undef PRED
+			stm--;
+		}
+	}
+	// swap Mx/My & Nx/Ny
+	i = Nx, Nx = Ny, Ny = i;
+	i = Mx, Mx = My, My = i;
+
+	// now columns == transposed rows
+	for (j = 0; j < Ny; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// finalize
+	for (j = 0; j <= (Ny >> 1); j++) {
+		unsigned int jm = (Ny - j) & (Ny - 1);
+		unsigned int ji = j << Mx;
+		unsigned int jmi = jm << Mx;
+		for (i = 0; i <= (Nx >> 1); i++) {
+			unsigned int im = (Nx - i) & (Nx - 1);
+			fREAL A = data[ji + i];
+			fREAL B = data[jmi + i];
+			fREAL C = data[ji + im];
+			fREAL D = data[jmi + im];
+			fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+			data[ji + i] = A - E;
+			data[jmi + i] = B + E;
+			data[ji + im] = C + E;
+			data[jmi + im] = D - E;
+		}
+	}
+
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height */
+static void fht_convolve(fREAL *d1, const fREAL *d2, unsigned int M, unsigned int N)
+{
+	fREAL a, b;
+	unsigned int i, j, k, L, mj, mL;
+	unsigned int m = 1 << M, n = 1 << N;
+	unsigned int m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+	unsigned int mn2 = m << (N - 1);
+
+	d1[0] *= d2[0];
+	d1[mn2] *= d2[mn2];
+	d1[m2] *= d2[m2];
+	d1[m2 + mn2] *= d2[m2 + mn2];
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		a = d1[i] * d2[i] - d1[k] * d2[k];
+		b = d1[k] * d2[i] + d1[i] * d2[k];
+		d1[i] = (b + a) * (fREAL)0.5;
+		d1[k] = (b - a) * (fREAL)0.5;
+		a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+		b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+		d1[i + mn2] = (b + a) * (fREAL)0.5;
+		d1[k + mn2] = (b - a) * (fREAL)0.5;
+	}
+	for (j = 1; j < n2; j++) {
+		L = n - j;
+		mj = j << M;
+		mL = L << M;
+		a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+		b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+		d1[mj] = (b + a) * (fREAL)0.5;
+		d1[mL] = (b - a) * (fREAL)0.5;
+		a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+		b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+		d1[m2 + mj] = (b + a) * (fREAL)0.5;
+		d1[m2 + mL] = (b - a) * (fREAL)0.5;
+	}
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		for (j = 1; j < n2; j++) {
+			L = n - j;
+			mj = j << M;
+			mL = L << M;
+			a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+			b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+			d1[i + mj] = (b + a) * (fREAL)0.5;
+			d1[k + mL] = (b - a) * (fREAL)0.5;
+			a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+			b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+			d1[i + mL] = (b + a) * (fREAL)0.5;
+			d1[k + mj] = (b - a) * (fREAL)0.5;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+
+typedef struct ConvolveData {
+	fREAL *data1;
+	const float *imageBuffer;
+	float *dstBuffer;
+	int num_channels, image_channels;
+	unsigned int w2, h2, hw, hh, log2_w, log2_h;
+	int imageWidth, imageHeight;
+	int xbsz, ybsz, nxb;
+	/* first row of blocks and the number of block rows between the rows of a pass */
+	int ybl_start, ybl_step;
+} ConvolveData;
+
+/* convolve a row of blocks of a channel, item = block row in the pass * num_channels + channel */
+static void convolve_block_rows(void *userdata, int start, int end)
+{
+	const ConvolveData *cd = (const ConvolveData *)userdata;
+	const unsigned int w2 = cd->w2, h2 = cd->h2;
+	fREAL *data2 = (fREAL *)MEM_mallocN(w2 * h2 * sizeof(fREAL), "convolve_fast FHT data2");
+	fREAL *fp;
+	int x, y;
+
+	for (int item = start; item < end; item++) {
+		const int ybl = cd->ybl_start + (item / cd->num_channels) * cd->ybl_step;
+		const int ch = item % cd->num_channels;
+		const fREAL *data1ch = &cd->data1[ch * w2 * h2];
+
+		for (int xbl = 0; xbl < cd->nxb; xbl++) {
+			// image, channel ch -> data2
+			memset(data2, 0, w2 * h2 * sizeof(fREAL));
+			for (y = 0; y < cd->ybsz; y++) {
+				int yy = ybl * cd->ybsz + y;
+				if (yy >= cd->imageHeight) continue;
+				fp = &data2[y * w2];
+				const float *colp = &cd->imageBuffer[yy * cd->imageWidth * cd->image_channels];
+				for (x = 0; x < cd->xbsz; x++) {
+					int xx = xbl * cd->xbsz + x;
+					if (xx >= cd->imageWidth) continue;
+					fp[x] = colp[xx * cd->image_channels + ch];
+				}
+			}
+
+			// forward FHT
+			// zero pad data starts after the rows of the block
+			FHT2D(data2, cd->log2_w, cd->log2_h, cd->ybsz, 0);
+
+			// FHT2D transposed data, row/col now swapped
+			// convolve & inverse FHT
+			fht_convolve(data2, data1ch, cd->log2_h, cd->log2_w);
+			FHT2D(data2, cd->log2_h, cd->log2_w, 0, 1);
+			// data again transposed, so in order again
+
+			// overlap-add result
+			for (y = 0; y < (int)h2; y++) {
+				const int yy = ybl * cd->ybsz + y - cd->hh;
+				if ((yy < 0) || (yy >= cd->imageHeight)) continue;
+				fp = &data2[y * w2];
+				float *colp = &cd->dstBuffer[yy * cd->imageWidth * COM_NUMBER_OF_CHANNELS];
+				for (x = 0; x < (int)w2; x++) {
+					const int xx = xbl * cd->xbsz + x - cd->hw;
+					if ((xx < 0) || (xx >= cd->imageWidth)) continue;
+					colp[xx * COM_NUMBER_OF_CHANNELS + ch] += fp[x];
+				}
+			}
+		}
+	}
+
+	MEM_freeN(data2);
+}
+
+void FFTConvolution::convolve(float *dst, MemoryBuffer *image, MemoryBuffer *kernel, int num_channels)
+{
+	ConvolveData cd;
+	fREAL *data1, *fp;
+	unsigned int w2, h2, log2_w, log2_h;
+	int x, y, ch;
+	int nyb, xbsz, ybsz, num_passes, pass;
+	const unsigned int kernelWidth = kernel->getWidth();
+	const unsigned int kernelHeight = kernel->getHeight();
+	const int kernel_channels = kernel->getNumberOfChannels();
+	const unsigned int imageWidth = image->getWidth();
+	const unsigned int imageHeight = image->getHeight();
+	const float *kernelBuffer = kernel->getBuffer();
+
+	BLI_assert(num_channels <= min(kernel_channels, image->getNumberOfChannels()));
+
+	memset(dst, 0, imageWidth * imageHeight * COM_NUMBER_OF_CHANNELS * sizeof(float));
+
+	// convolution result width & height
+	w2 = 2 * kernelWidth - 1;
+	h2 = 2 * kernelHeight - 1;
+	// FFT pow2 required size & log2
+	w2 = nextPow2(w2, &log2_w);
+	h2 = nextPow2(h2, &log2_h);
+
+	// the fht of the kernel is calculated once and re-used for every block
+	data1 = (fREAL *)MEM_callocN(num_channels * w2 * h2 * sizeof(fREAL), "convolve_fast FHT data1");
+	for (ch = 0; ch < num_channels; ch++) {
+		fREAL *data1ch = &data1[ch * w2 * h2];
+
+		// kernel, channel ch -> data1
+		for (y = 0; y < kernelHeight; y++) {
+			fp = &data1ch[y * w2];
+			const float *colp = &kernelBuffer[y * kernelWidth * kernel_channels];
+			for (x = 0; x < kernelWidth; x++)
+				fp[x] = colp[x * kernel_channels + ch];
+		}
+		FHT2D(data1ch, log2_w, log2_h, kernelHeight, 0);
+	}
+
+	// block add-overlap
+	xbsz = (w2 + 1) - kernelWidth;
+	ybsz = (h2 + 1) - kernelHeight;
+	nyb = imageHeight / ybsz;
+	if (imageHeight % ybsz) nyb++;
+
+	cd.data1 = data1;
+	cd.imageBuffer = image->getBuffer();
+	cd.dstBuffer = dst;
+	cd.num_channels = num_channels;
+	cd.image_channels = image->getNumberOfChannels();
+	cd.w2 = w2;
+	cd.h2 = h2;
+	cd.hw = kernelWidth >> 1;
+	cd.hh = kernelHeight >> 1;
+	cd.log2_w = log2_w;
+	cd.log2_h = log2_h;
+	cd.imageWidth = imageWidth;
+	cd.imageHeight = imageHeight;
+	cd.xbsz = xbsz;
+	cd.ybsz = ybsz;
+	cd.nxb = imageWidth / xbsz;
+	if (imageWidth % xbsz) cd.nxb++;
+
+	// the results of a block row are added to the rows of its neighbors, rows that are
+	// further apart than the convolution result are convolved in parallel
+	num_passes = (h2 + ybsz - 1) / ybsz;
+	cd.ybl_step = num_passes;
+	for (pass = 0; pass < num_passes && pass < nyb; pass++) {
+		const int num_block_rows = (nyb - pass + num_passes - 1) / num_passes;
+		cd.ybl_start = pass;
+		WorkScheduler::parallelRange(num_block_rows * num_channels, 1, convolve_block_rows, &cd);
+	}
+
+	MEM_freeN(data1);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_FFTConvolution_h
+#define _COM_FFTConvolution_h
+
+#include "COM_MemoryBuffer.h"
+
+/**
+ * @brief convolution with large kernels using the Fast Hartley Transform
+ *
+ * The image is split into blocks that are convolved one by one and added to the result
+ * (overlap-add), so the memory used depends on the size of the kernel and not on the size
+ * of the image. The blocks are convolved in parallel with WorkScheduler::parallelRange.
+ * Used by the fog glow glare and by the bokeh blur for large radii.
+ */
+class FFTConvolution {
+public:
+	/**
+	 * @brief convolve the first num_channels channels of image with kernel
+	 * @param dst: image sized buffer with COM_NUMBER_OF_CHANNELS floats per pixel, the other channels are set to zero
+	 * @param image: float buffer of the image
+	 * @param kernel: float buffer of the kernel, its center is at (width / 2, height / 2)
+	 */
+	static void convolve(float *dst, MemoryBuffer *image, MemoryBuffer *kernel, int num_channels);
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include <limits.h>
 
 #include "COM_FastGaussianBlurOperation.h"
+#include "COM_WorkScheduler.h"
 #include "MEM_guardedalloc.h"
 #include "BLI_utildefines.h"
 
@@ -208,22 +209,104 @@ void FastGaussianBlurOperation::deinitializeTileData(rcti *rect, void *data)
 }
 
 
+typedef struct IIRGaussData {
+	float *buffer;
+	unsigned int width, height, num_channels, chan;
+	double cf[4], tsM[9];
+} IIRGaussData;
+
+static void IIR_gauss_line(const IIRGaussData *data, const double *X, double *Y, double *W, const unsigned int L)
+{
+	const double *cf = data->cf;
+	const double *tsM = data->tsM;
+	double tsu[3], tsv[3];
+	unsigned int i;
+
+	W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0];
+	W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0];
+	W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0];
+	for (i = 3; i < L; i++) {
+		W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3];
+	}
+	tsu[0] = W[L - 1] - X[L - 1];
+	tsu[1] = W[L - 2] - X[L - 1];
+	tsu[2] = W[L - 3] - X[L - 1];
+	tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1];
+	tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1];
+	tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1];
+	Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2];
+	Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1];
+	Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0];
+	/* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */
+	for (i = L - 4; i != UINT_MAX; i--) {
+		Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3];
+	}
+}
+
+/* filter the rows [start, end) of a channel */
+static void IIR_gauss_rows(void *userdata, int start, int end)
+{
+	const IIRGaussData *data = (const IIRGaussData *)userdata;
+	const unsigned int width = data->width;
+	const unsigned int num_channels = data->num_channels;
+	double *X = (double *)MEM_mallocN(3 * width * sizeof(double), "IIR_gauss line bufs");
+	double *Y = X + width, *W = Y + width;
+	unsigned int x;
+	int y;
+
+	for (y = start; y < end; ++y) {
+		float *line = &data->buffer[(y * width) * num_channels + data->chan];
+		for (x = 0; x < width; ++x) {
+			X[x] = line[x * num_channels];
+		}
+		IIR_gauss_line(data, X, Y, W, width);
+		for (x = 0; x < width; ++x) {
+			line[x * num_channels] = Y[x];
+		}
+	}
+
+	MEM_freeN(X);
+}
+
+/* filter the columns [start, end) of a channel */
+static void IIR_gauss_columns(void *userdata, int start, int end)
+{
+	const IIRGaussData *data = (const IIRGaussData *)userdata;
+	const unsigned int height = data->height;
+	const unsigned int add = data->width * data->num_channels;
+	double *X = (double *)MEM_mallocN(3 * height * sizeof(double), "IIR_gauss line bufs");
+	double *Y = X + height, *W = Y + height;
+	unsigned int y;
+	int x;
+
+	for (x = start; x < end; ++x) {
+		float *line = &data->buffer[x * data->num_channels + data->chan];
+		for (y = 0; y < height; ++y) {
+			X[y] = line[y * add];
+		}
+		IIR_gauss_line(data, X, Y, W, height);
+		for (y = 0; y < height; ++y) {
+			line[y * add] = Y[y];
+		}
+	}
+
+	MEM_freeN(X);
+}
+
 void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsigned int chan, unsigned int xy)
 {
-	double q, q2, sc, cf[4], tsM[9], tsu[3], tsv[3];
-	double *X, *Y, *W;
+	IIRGaussData data;
+	double q, q2, sc;
+	double *cf = data.cf, *tsM = data.tsM;
 	const unsigned int src_width = src->getWidth();
 	const unsigned int src_height = src->getHeight();
-	unsigned int x, y, sz;
-	unsigned int i;
-	float *buffer = src->getBuffer();
 	
 	// <0.5 not valid, though can have a possibly useful sort of sharpening effect
 	if (sigma < 0.5f) return;
 	
 	if ((xy < 1) || (xy > 3)) xy = 3;
 	
-	// XXX The YVV macro defined below explicitly expects sources of at least 3x3 pixels,
+	// XXX IIR_gauss_line explicitly expects sources of at least 3x3 pixels,
 	//     so just skiping blur along faulty direction if src's def is below that limit!
 	if (src_width < 3) xy &= ~1;
 	if (src_height < 3) xy &= ~2;
@@ -262,76 +345,20 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsign
 	tsM[6] = sc * (cf[3] * cf[1] + cf[2] + cf[1] * cf[1] - cf[2] * cf[2]);
 	tsM[7] = sc * (cf[1] * cf[2] + cf[3] * cf[2] * cf[2] - cf[1] * cf[3] * cf[3] - cf[3] * cf[3] * cf[3] - cf[3] * cf[2] + cf[3]);
 	tsM[8] = sc * (cf[3] * (cf[1] + cf[3] * cf[2]));
-	
-#define YVV(L)                                                                          \
-{                                                                                       \
-	W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0];                   \
-	W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0];                   \
-	W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0];                   \
-	for (i = 3; i < L; i++) {                                                           \
-		W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3];   \
-	}                                                                                   \
-	tsu[0] = W[L - 1] - X[L - 1];                                                       \
-	tsu[1] = W[L - 2] - X[L - 1];                                                       \
-	tsu[2] = W[L - 3] - X[L - 1];                                                       \
-	tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1];            \
-	tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1];            \
-	tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1];            \
-	Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2];     \
-	Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1];   \
-	Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0]; \
-	/* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */   \
-	for (i = L - 4; i != UINT_MAX; i--) {                                               \
-		Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3];   \
-	}                                                                                   \
-} (void)0
-	
-	// intermediate buffers
-	sz = max(src_width, src_height);
-	X = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss X buf");
-	Y = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss Y buf");
-	W = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss W buf");
+
+	data.buffer = src->getBuffer();
+	data.width = src_width;
+	data.height = src_height;
+	data.num_channels = src->getNumberOfChannels();
+	data.chan = chan;
+
+	// the lines of a direction are independent, the columns are only filtered after all rows are done
 	if (xy & 1) {   // H
-		int offset;
-		for (y = 0; y < src_height; ++y) {
-			const int yx = y * src_width;
-			offset = yx * COM_NUMBER_OF_CHANNELS + chan;
-			for (x = 0; x < src_width; ++x) {
-				X[x] = buffer[offset];
-				offset += COM_NUMBER_OF_CHANNELS;
-			}
-			YVV(src_width);
-			offset = yx * COM_NUMBER_OF_CHANNELS + chan;
-			for (x = 0; x < src_width; ++x) {
-				buffer[offset] = Y[x];
-				offset += COM_NUMBER_OF_CHANNELS;
-			}
-		}
+		WorkScheduler::parallelRange(src_height, 16, IIR_gauss_rows, &data);
 	}
 	if (xy & 2) {   // V
-		int offset;
-		const int add = src_width * COM_NUMBER_OF_CHANNELS;
-
-		for (x = 0; x < src_width; ++x) {
-			offset = x * COM_NUMBER_OF_CHANNELS + chan;
-			for (y = 0; y < src_height; ++y) {
-				X[y] = buffer[offset];
-				offset += add;
-			}
-			YVV(src_height);
-			offset = x * COM_NUMBER_OF_CHANNELS + chan;
-			for (y = 0; y < src_height; ++y) {
-				buffer[offset] = Y[y];
-				offset += add;
-			}
-		}
+		WorkScheduler::parallelRange(src_width, 16, IIR_gauss_columns, &data);
 	}
-	
-	MEM_freeN(X);
-	MEM_freeN(W);
-	MEM_freeN(Y);
-#undef YVV
-	
 }
 
 
@@ -392,10 +419,12 @@ void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 		MemoryBuffer *copy = newBuf->duplicate();
 		FastGaussianBlurOperation::IIR_gauss(copy, this->m_sigma, 0, 3);
 
+		const int num_channels = copy->getNumberOfChannels();
+
 		if (this->m_overlay == FAST_GAUSS_OVERLAY_MIN) {
 			float *src = newBuf->getBuffer();
 			float *dst = copy->getBuffer();
-			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += COM_NUMBER_OF_CHANNELS, dst += COM_NUMBER_OF_CHANNELS) {
+			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += num_channels, dst += num_channels) {
 				if (*src < *dst) {
 					*dst = *src;
 				}
@@ -404,7 +433,7 @@ void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 		else if (this->m_overlay == FAST_GAUSS_OVERLAY_MAX) {
 			float *src = newBuf->getBuffer();
 			float *dst = copy->getBuffer();
-			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += COM_NUMBER_OF_CHANNELS, dst += COM_NUMBER_OF_CHANNELS) {
+			for (int i = copy->getWidth() * copy->getHeight(); i != 0; i--, src += num_channels, dst += num_channels) {
 				if (*src > *dst) {
 					*dst = *src;
 				}
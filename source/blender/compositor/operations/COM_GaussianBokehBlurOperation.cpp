@@ -21,6 +21,7 @@
  */
 
 #include "COM_GaussianBokehBlurOperation.h"
+#include "COM_PixelVector.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 extern "C" {
@@ -200,14 +201,52 @@ bool GaussianBokehBlurOperation::determineDependingAreaOfInterest(rcti *input, R
 GaussianBlurReferenceOperation::GaussianBlurReferenceOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
 	this->m_maintabs = NULL;
+	this->m_rowSums = NULL;
 }
 
 void *GaussianBlurReferenceOperation::initializeTileData(rcti *rect)
 {
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_data.filtertype == R_FILTER_BOX &&
+	    max(this->m_filtersizex, this->m_filtersizey) >= COM_BLUR_CONSTANT_TIME_RADIUS)
+	{
+		lockMutex();
+		if (this->m_rowSums == NULL) {
+			updateRowSums((MemoryBuffer *)buffer);
+		}
+		unlockMutex();
+	}
 	return buffer;
 }
 
+void GaussianBlurReferenceOperation::updateRowSums(MemoryBuffer *input)
+{
+	const int imgx = getWidth();
+	const int imgy = getHeight();
+	const int stride = COM_NUMBER_OF_CHANNELS * (imgx + 1);
+	double *sums = (double *)MEM_mallocN(sizeof(double) * stride * imgy, __func__);
+	const float *buffer = input->getBuffer();
+
+	/* accumulated in double, the difference of two large float sums loses the precision of the segment */
+	for (int y = 0; y < imgy; y++) {
+		const float *src = buffer + COM_NUMBER_OF_CHANNELS * y * imgx;
+		double *dst = sums + stride * y;
+		double sum[4] = {0.0, 0.0, 0.0, 0.0};
+		for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+			dst[c] = 0.0;
+		}
+		for (int x = 0; x < imgx; x++, src += COM_NUMBER_OF_CHANNELS) {
+			dst += COM_NUMBER_OF_CHANNELS;
+			for (int c = 0; c < COM_NUMBER_OF_CHANNELS; c++) {
+				sum[c] += src[c];
+				dst[c] = sum[c];
+			}
+		}
+	}
+
+	this->m_rowSums = sums;
+}
+
 void GaussianBlurReferenceOperation::initExecution()
 {
 	BlurBaseOperation::initExecution();
@@ -250,6 +289,7 @@ void GaussianBlurReferenceOperation::initExecution()
 		m_filtersizey = 1;
 	m_rady = (float)m_filtersizey;
 	updateGauss();
+	initMutex();
 }
 
 void GaussianBlurReferenceOperation::updateGauss()
@@ -293,6 +333,26 @@ void GaussianBlurReferenceOperation::executePixel(float output[4], int x, int y,
 		int minyr = y - refrady < 0 ? -y : -refrady;
 		int maxyr = y + refrady > imgy ? imgy - y : refrady;
 
+		if (this->m_rowSums) {
+			/* box filter: average of the rectangle, each row is the difference of two prefix sums */
+			const int stride = COM_NUMBER_OF_CHANNELS * (imgx + 1);
+			const double *row = this->m_rowSums + stride * (y + minyr);
+			const double *rowmax, *rowmin;
+			double color[4] = {0.0, 0.0, 0.0, 0.0};
+			const double fac = 1.0 / ((maxxr - minxr) * (maxyr - minyr));
+			for (i = minyr; i < maxyr; i++, row += stride) {
+				rowmax = row + COM_NUMBER_OF_CHANNELS * (x + maxxr);
+				rowmin = row + COM_NUMBER_OF_CHANNELS * (x + minxr);
+				for (j = 0; j < COM_NUMBER_OF_CHANNELS; j++) {
+					color[j] += rowmax[j] - rowmin[j];
+				}
+			}
+			for (j = 0; j < COM_NUMBER_OF_CHANNELS; j++) {
+				output[j] = (float)(color[j] * fac);
+			}
+			return;
+		}
+
 		float *srcd = buffer + COM_NUMBER_OF_CHANNELS * ( (y + minyr) * imgx + x + minxr);
 
 		gausstabx = m_maintabs[refradx - 1];
@@ -330,6 +390,11 @@ void GaussianBlurReferenceOperation::deinitExecution()
 		MEM_freeN(this->m_maintabs[i]);
 	}
 	MEM_freeN(this->m_maintabs);
+	if (this->m_rowSums) {
+		MEM_freeN(this->m_rowSums);
+		this->m_rowSums = NULL;
+	}
+	deinitMutex();
 	BlurBaseOperation::deinitExecution();
 }
 
@@ -53,7 +53,15 @@ class GaussianBlurReferenceOperation : public BlurBaseOperation {
 private:
 	float **m_maintabs;
 	
+	/**
+	 * @brief prefix sums of the rows of the input, used by large box filters
+	 * the sum of a row segment is the difference of two entries, so the cost per pixel
+	 * only grows with the vertical size.
+	 */
+	double *m_rowSums;
+	
 	void updateGauss();
+	void updateRowSums(MemoryBuffer *input);
 	int m_filtersizex;
 	int m_filtersizey;
 	float m_radx;
@@ -21,6 +21,7 @@
  */
 
 #include "COM_GaussianXBlurOperation.h"
+#include "COM_PixelVector.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 
@@ -42,6 +43,9 @@ void *GaussianXBlurOperation::initializeTileData(rcti *rect)
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
 	unlockMutex();
+	if (this->m_recursiveRadius > 0.0f) {
+		return getRecursiveBlur((MemoryBuffer *)buffer, rect);
+	}
 	return buffer;
 }
 
@@ -52,27 +56,39 @@ void GaussianXBlurOperation::initExecution()
 	initMutex();
 
 	if (this->m_sizeavailable) {
-		float rad = max_ff(m_size * m_data.sizex, 0.0f);
-		m_filtersize = min_ii(ceil(rad), MAX_GAUSSTAB_RADIUS);
-		
+		initGauss();
+	}
+}
+
+void GaussianXBlurOperation::initGauss()
+{
+	float rad = max_ff(m_size * m_data.sizex, 0.0f);
+	m_filtersize = min_ii(ceil(rad), MAX_GAUSSTAB_RADIUS);
+
+	if (use_recursive_blur(rad)) {
+		initRecursiveBlur(rad, 1);
+	}
+	else {
 		this->m_gausstab = BlurBaseOperation::make_gausstab(rad, m_filtersize);
 	}
 }
 
 void GaussianXBlurOperation::updateGauss()
 {
-	if (this->m_gausstab == NULL) {
+	if (this->m_gausstab == NULL && this->m_recursiveRadius == 0.0f) {
 		updateSize();
-		float rad = max_ff(m_size * m_data.sizex, 0.0f);
-		m_filtersize = min_ii(ceil(rad), MAX_GAUSSTAB_RADIUS);
-		
-		this->m_gausstab = BlurBaseOperation::make_gausstab(rad, m_filtersize);
+		initGauss();
 	}
 }
 
 void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
-	float color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	if (this->m_recursiveRadius > 0.0f) {
+		((MemoryBuffer *)data)->readNoCheck(output, x, y);
+		return;
+	}
+
+	PixelVector color_accum = pixel_set(0.0f);
 	float multiplier_accum = 0.0f;
 	MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 	float *buffer = inputBuffer->getBuffer();
@@ -90,11 +106,11 @@ void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *d
 	int bufferindex = ((xmin - bufferstartx) * 4) + ((ymin - bufferstarty) * 4 * bufferwidth);
 	for (int nx = xmin, index = (xmin - x) + this->m_filtersize; nx < xmax; nx += step, index += step) {
 		const float multiplier = this->m_gausstab[index];
-		madd_v4_v4fl(color_accum, &buffer[bufferindex], multiplier);
+		color_accum = pixel_add(color_accum, pixel_mul(pixel_load(&buffer[bufferindex]), pixel_set(multiplier)));
 		multiplier_accum += multiplier;
 		bufferindex += offsetadd;
 	}
-	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
+	pixel_store(output, pixel_mul(color_accum, pixel_set(1.0f / multiplier_accum)));
 }
 
 void GaussianXBlurOperation::deinitExecution()
@@ -104,6 +120,7 @@ void GaussianXBlurOperation::deinitExecution()
 		MEM_freeN(this->m_gausstab);
 		this->m_gausstab = NULL;
 	}
+	deinitRecursiveBlur();
 
 	deinitMutex();
 }
@@ -124,7 +141,14 @@ bool GaussianXBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadB
 		}
 	}
 	{
-		if (this->m_sizeavailable && this->m_gausstab != NULL) {
+		if (this->m_sizeavailable && this->m_recursiveRadius > 0.0f) {
+			/* the recursive blur needs whole rows */
+			newInput.xmax = this->getWidth();
+			newInput.xmin = 0;
+			newInput.ymax = input->ymax;
+			newInput.ymin = input->ymin;
+		}
+		else if (this->m_sizeavailable && this->m_gausstab != NULL) {
 			newInput.xmax = input->xmax + this->m_filtersize + 1;
 			newInput.xmin = input->xmin - this->m_filtersize - 1;
 			newInput.ymax = input->ymax;
@@ -21,6 +21,7 @@
  */
 
 #include "COM_GaussianYBlurOperation.h"
+#include "COM_PixelVector.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 
@@ -42,6 +43,9 @@ void *GaussianYBlurOperation::initializeTileData(rcti *rect)
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
 	unlockMutex();
+	if (this->m_recursiveRadius > 0.0f) {
+		return getRecursiveBlur((MemoryBuffer *)buffer, rect);
+	}
 	return buffer;
 }
 
@@ -52,27 +56,39 @@ void GaussianYBlurOperation::initExecution()
 	initMutex();
 
 	if (this->m_sizeavailable) {
-		float rad = max_ff(m_size * m_data.sizey, 0.0f);
-		m_filtersize = min_ii(ceil(rad), MAX_GAUSSTAB_RADIUS);
-		
+		initGauss();
+	}
+}
+
+void GaussianYBlurOperation::initGauss()
+{
+	float rad = max_ff(m_size * m_data.sizey, 0.0f);
+	m_filtersize = min_ii(ceil(rad), MAX_GAUSSTAB_RADIUS);
+
+	if (use_recursive_blur(rad)) {
+		initRecursiveBlur(rad, 2);
+	}
+	else {
 		this->m_gausstab = BlurBaseOperation::make_gausstab(rad, m_filtersize);
 	}
 }
 
 void GaussianYBlurOperation::updateGauss()
 {
-	if (this->m_gausstab == NULL) {
+	if (this->m_gausstab == NULL && this->m_recursiveRadius == 0.0f) {
 		updateSize();
-		float rad = max_ff(m_size * m_data.sizey, 0.0f);
-		m_filtersize = min_ii(ceil(rad), MAX_GAUSSTAB_RADIUS);
-		
-		this->m_gausstab = BlurBaseOperation::make_gausstab(rad, m_filtersize);
+		initGauss();
 	}
 }
 
 void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
-	float color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	if (this->m_recursiveRadius > 0.0f) {
+		((MemoryBuffer *)data)->readNoCheck(output, x, y);
+		return;
+	}
+
+	PixelVector color_accum = pixel_set(0.0f);
 	float multiplier_accum = 0.0f;
 	MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 	float *buffer = inputBuffer->getBuffer();
@@ -92,10 +108,10 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
 		index = (ny - y) + this->m_filtersize;
 		int bufferindex = bufferIndexx + ((ny - bufferstarty) * 4 * bufferwidth);
 		const float multiplier = this->m_gausstab[index];
-		madd_v4_v4fl(color_accum, &buffer[bufferindex], multiplier);
+		color_accum = pixel_add(color_accum, pixel_mul(pixel_load(&buffer[bufferindex]), pixel_set(multiplier)));
 		multiplier_accum += multiplier;
 	}
-	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
+	pixel_store(output, pixel_mul(color_accum, pixel_set(1.0f / multiplier_accum)));
 }
 
 void GaussianYBlurOperation::deinitExecution()
@@ -105,6 +121,7 @@ void GaussianYBlurOperation::deinitExecution()
 		MEM_freeN(this->m_gausstab);
 		this->m_gausstab = NULL;
 	}
+	deinitRecursiveBlur();
 
 	deinitMutex();
 }
@@ -125,7 +142,14 @@ bool GaussianYBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadB
 		}
 	}
 	{
-		if (this->m_sizeavailable && this->m_gausstab != NULL) {
+		if (this->m_sizeavailable && this->m_recursiveRadius > 0.0f) {
+			/* the recursive blur needs whole columns */
+			newInput.xmax = input->xmax;
+			newInput.xmin = input->xmin;
+			newInput.ymax = this->getHeight();
+			newInput.ymin = 0;
+		}
+		else if (this->m_sizeavailable && this->m_gausstab != NULL) {
 			newInput.xmax = input->xmax;
 			newInput.xmin = input->xmin;
 			newInput.ymax = input->ymax + this->m_filtersize + 1;
@@ -30,6 +30,7 @@ private:
 	float *m_gausstab;
 	int m_filtersize;
 	void updateGauss();
+	void initGauss();
 public:
 	GaussianYBlurOperation();
 	
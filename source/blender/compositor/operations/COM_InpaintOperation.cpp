@@ -24,6 +24,7 @@
 
 #include "COM_InpaintOperation.h"
 #include "COM_OpenCLDevice.h"
+#include "COM_WorkScheduler.h"
 
 #include "BLI_math.h"
 
@@ -96,24 +97,51 @@ int InpaintSimpleOperation::mdist(int x, int y)
 	return this->m_manhatten_distance[y * width + x];
 }
 
-bool InpaintSimpleOperation::next_pixel(int &x, int &y, int & curr, int iters)
+/* The city block distance to the nearest known pixel is separable, the rows and then the
+ * columns are scanned in both directions, each of them independent of the others. */
+void InpaintSimpleOperation::manhatten_distance_rows(void *userdata, int start, int end)
 {
-	int width = this->getWidth();
+	InpaintSimpleOperation *op = (InpaintSimpleOperation *)userdata;
+	const int width = op->getWidth();
+	const int height = op->getHeight();
 
-	if (curr >= this->m_area_size) {
-		return false;
+	for (int j = start; j < end; j++) {
+		short *m = &op->m_manhatten_distance[j * width];
+
+		for (int i = 0; i < width; i++) {
+			int r = 0;
+			/* no need to clamp here */
+			if (op->get_pixel(i, j)[3] < 1.0f) {
+				r = width + height;
+				if (i > 0)
+					r = min_ii(r, m[i - 1] + 1);
+			}
+			m[i] = r;
+		}
+
+		for (int i = width - 2; i >= 0; i--) {
+			m[i] = min_ii(m[i], m[i + 1] + 1);
+		}
 	}
-	
-	int r = this->m_pixelorder[curr++];
+}
 
-	x = r % width;
-	y = r / width;
+void InpaintSimpleOperation::manhatten_distance_columns(void *userdata, int start, int end)
+{
+	InpaintSimpleOperation *op = (InpaintSimpleOperation *)userdata;
+	const int width = op->getWidth();
+	const int height = op->getHeight();
 
-	if (this->mdist(x, y) > iters) {
-		return false;
+	for (int i = start; i < end; i++) {
+		short *m = &op->m_manhatten_distance[i];
+
+		for (int j = 1; j < height; j++) {
+			m[j * width] = min_ii(m[j * width], m[(j - 1) * width] + 1);
+		}
+
+		for (int j = height - 2; j >= 0; j--) {
+			m[j * width] = min_ii(m[j * width], m[(j + 1) * width] + 1);
+		}
 	}
-	
-	return true;
 }
 
 void InpaintSimpleOperation::calc_manhatten_distance() 
@@ -123,36 +151,13 @@ void InpaintSimpleOperation::calc_manhatten_distance()
 	short *m = this->m_manhatten_distance = (short *)MEM_mallocN(sizeof(short) * width * height, __func__);
 	int *offsets;
 
-	offsets = (int *)MEM_callocN(sizeof(int) * (width + height + 1), "InpaintSimpleOperation offsets");
+	WorkScheduler::parallelRange(height, 16, manhatten_distance_rows, this);
+	WorkScheduler::parallelRange(width, 16, manhatten_distance_columns, this);
 
-	for (int j = 0; j < height; j++) {
-		for (int i = 0; i < width; i++) {
-			int r = 0;
-			/* no need to clamp here */
-			if (this->get_pixel(i, j)[3] < 1.0f) {
-				r = width + height;
-				if (i > 0) 
-					r = min_ii(r, m[j * width + i - 1] + 1);
-				if (j > 0) 
-					r = min_ii(r, m[(j - 1) * width + i] + 1);
-			}
-			m[j * width + i] = r;
-		}
-	}
+	offsets = (int *)MEM_callocN(sizeof(int) * (width + height + 1), "InpaintSimpleOperation offsets");
 
-	for (int j = height - 1; j >= 0; j--) {
-		for (int i = width - 1; i >= 0; i--) {
-			int r = m[j * width + i];
-			
-			if (i + 1 < width) 
-				r = min_ii(r, m[j * width + i + 1] + 1);
-			if (j + 1 < height) 
-				r = min_ii(r, m[(j + 1) * width + i] + 1);
-			
-			m[j * width + i] = r;
-			
-			offsets[r]++;
-		}
+	for (int i = 0; i < width * height; i++) {
+		offsets[m[i]]++;
 	}
 	
 	offsets[0] = 0;
@@ -173,6 +178,22 @@ void InpaintSimpleOperation::calc_manhatten_distance()
 	MEM_freeN(offsets);
 }
 
+typedef struct InpaintPixStepData {
+	InpaintSimpleOperation *op;
+	const int *pixelorder;
+} InpaintPixStepData;
+
+void InpaintSimpleOperation::pix_step_range(void *userdata, int start, int end)
+{
+	InpaintPixStepData *data = (InpaintPixStepData *)userdata;
+	const int width = data->op->getWidth();
+
+	for (int curr = start; curr < end; curr++) {
+		const int r = data->pixelorder[curr];
+		data->op->pix_step(r % width, r / width);
+	}
+}
+
 void InpaintSimpleOperation::pix_step(int x, int y)
 {
 	const int d = this->mdist(x, y);
@@ -227,12 +248,26 @@ void *InpaintSimpleOperation::initializeTileData(rcti *rect)
 
 		this->calc_manhatten_distance();
 
+		/* pix_step only reads pixels closer to the known pixels, so all pixels at the
+		 * same distance can be filled in parallel, one distance after the other */
 		int curr = 0;
-		int x, y;
+		while (curr < this->m_area_size) {
+			const int d = this->m_manhatten_distance[this->m_pixelorder[curr]];
+			if (d > this->m_iterations) {
+				break;
+			}
 
-	
-		while (this->next_pixel(x, y, curr, this->m_iterations)) {
-			this->pix_step(x, y);
+			int end = curr + 1;
+			while (end < this->m_area_size && this->m_manhatten_distance[this->m_pixelorder[end]] == d) {
+				end++;
+			}
+
+			InpaintPixStepData data;
+			data.op = this;
+			data.pixelorder = &this->m_pixelorder[curr];
+			WorkScheduler::parallelRange(end - curr, 1024, pix_step_range, &data);
+
+			curr = end;
 		}
 		this->m_cached_buffer_ready = true;
 	}
@@ -67,8 +67,11 @@ private:
 	void clamp_xy(int &x, int &y);
 	float *get_pixel(int x, int y);
 	int mdist(int x, int y);
-	bool next_pixel(int &x, int &y, int &curr, int iters);
 	void pix_step(int x, int y);
+
+	static void manhatten_distance_rows(void *userdata, int start, int end);
+	static void manhatten_distance_columns(void *userdata, int start, int end);
+	static void pix_step_range(void *userdata, int start, int end);
 };
 
 
@@ -69,6 +69,13 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
 	output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::readInputRows(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int num)
+{
+	this->m_inputValueOperation->readRow(inputValue, x, y, num);
+	this->m_inputColor1Operation->readRow(inputColor1, x, y, num);
+	this->m_inputColor2Operation->readRow(inputColor2, x, y, num);
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	NodeOperationInput *socket;
@@ -129,6 +136,27 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputValue[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor1[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		const PixelVector color1 = pixel_load(&inputColor1[i]);
+		const PixelVector color2 = pixel_load(&inputColor2[i]);
+		const PixelVector result = pixel_add(color1, pixel_mul(pixel_set(value), color2));
+
+		writeRowPixel(&output[i], result, inputColor1[i + 3]);
+	}
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +188,27 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputValue[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor1[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		const PixelVector color1 = pixel_load(&inputColor1[i]);
+		const PixelVector color2 = pixel_load(&inputColor2[i]);
+		const PixelVector result = pixel_add(pixel_mul(pixel_set(1.0f - value), color1), pixel_mul(pixel_set(value), color2));
+
+		writeRowPixel(&output[i], result, inputColor1[i + 3]);
+	}
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -623,6 +672,27 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputValue[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor1[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		const PixelVector color1 = pixel_load(&inputColor1[i]);
+		const PixelVector color2 = pixel_load(&inputColor2[i]);
+		const PixelVector result = pixel_mul(color1, pixel_add(pixel_set(1.0f - value), pixel_mul(pixel_set(value), color2)));
+
+		writeRowPixel(&output[i], result, inputColor1[i + 3]);
+	}
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -740,6 +810,29 @@ void MixScreenOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MixScreenOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputValue[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor1[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	const PixelVector one = pixel_set(1.0f);
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		const PixelVector color1 = pixel_load(&inputColor1[i]);
+		const PixelVector color2 = pixel_load(&inputColor2[i]);
+		const PixelVector factor = pixel_add(pixel_set(1.0f - value), pixel_mul(pixel_set(value), pixel_sub(one, color2)));
+		const PixelVector result = pixel_sub(one, pixel_mul(factor, pixel_sub(one, color1)));
+
+		writeRowPixel(&output[i], result, inputColor1[i + 3]);
+	}
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
@@ -806,6 +899,27 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRow(float *output, int x, int y, int num)
+{
+	float inputValue[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor1[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+	float inputColor2[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	readInputRows(inputValue, inputColor1, inputColor2, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		float value = inputValue[i];
+		if (this->useValueAlphaMultiply()) {
+			value *= inputColor2[i + 3];
+		}
+		const PixelVector color1 = pixel_load(&inputColor1[i]);
+		const PixelVector color2 = pixel_load(&inputColor2[i]);
+		const PixelVector result = pixel_sub(color1, pixel_mul(pixel_set(value), color2));
+
+		writeRowPixel(&output[i], result, inputColor1[i + 3]);
+	}
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
@@ -23,6 +23,7 @@
 #ifndef _COM_MixBaseOperation_h
 #define _COM_MixBaseOperation_h
 #include "COM_NodeOperation.h"
+#include "COM_PixelVector.h"
 
 
 /**
@@ -50,6 +51,20 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+	/**
+	 * read a row of all inputs, for the executeRow implementations
+	 */
+	void readInputRows(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int num);
+
+	inline void writeRowPixel(float output[4], PixelVector color, float alpha)
+	{
+		if (m_useClamp) {
+			color = pixel_clamp(color);
+			CLAMP(alpha, 0.0f, 1.0f);
+		}
+		pixel_store_keep_alpha(output, color, alpha);
+	}
 	
 public:
 	/**
@@ -84,12 +99,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -156,6 +173,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -174,6 +192,7 @@ class MixScreenOperation : public MixBaseOperation {
 public:
 	MixScreenOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -186,6 +205,7 @@ class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int num);
 };
 
 class MixValueOperation : public MixBaseOperation {
@@ -24,9 +24,9 @@
 #include "COM_WriteBufferOperation.h"
 #include "COM_defines.h"
 
-ReadBufferOperation::ReadBufferOperation() : NodeOperation()
+ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
 {
-	this->addOutputSocket(COM_DT_COLOR);
+	this->addOutputSocket(datatype);
 	this->m_single_value = false;
 	this->m_offset = 0;
 	this->m_buffer = NULL;
@@ -94,6 +94,21 @@ void ReadBufferOperation::executePixelFiltered(float output[4], float x, float y
 	}
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int num)
+{
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		float color[4];
+		m_buffer->read(color, 0, 0);
+		for (int i = 0; i < num; i++) {
+			copy_v4_v4(&output[i * COM_NUMBER_OF_CHANNELS], color);
+		}
+	}
+	else {
+		m_buffer->readRow(output, x, y, num);
+	}
+}
+
 bool ReadBufferOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	if (this == readOperation) {
@@ -48,6 +48,18 @@ void SetAlphaOperation::executePixelSampled(float output[4], float x, float y, P
 	output[3] = alphaInput[0];
 }
 
+void SetAlphaOperation::executeRow(float *output, int x, int y, int num)
+{
+	float alphaInput[COM_ROW_SIZE * COM_NUMBER_OF_CHANNELS];
+
+	this->m_inputColor->readRow(output, x, y, num);
+	this->m_inputAlpha->readRow(alphaInput, x, y, num);
+
+	for (int i = 0; i < num * COM_NUMBER_OF_CHANNELS; i += COM_NUMBER_OF_CHANNELS) {
+		output[i + 3] = alphaInput[i];
+	}
+}
+
 void SetAlphaOperation::deinitExecution()
 {
 	this->m_inputColor = NULL;
@@ -21,9 +21,12 @@
  */
 
 #include "COM_TonemapOperation.h"
+#include "COM_WorkScheduler.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_guardedalloc.h"
+
 TonemapOperation::TonemapOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_COLOR, COM_SC_NO_RESIZE);
@@ -108,31 +111,75 @@ bool TonemapOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferO
 	return false;
 }
 
+/* luminance statistics of a row, the rows are summed in parallel and combined afterwards */
+typedef struct TonemapRowSums {
+	float Lav;
+	float cav[3];
+	float lsum;
+	float maxl, minl;
+} TonemapRowSums;
+
+typedef struct TonemapSumData {
+	MemoryBuffer *tile;
+	TonemapRowSums *rows;
+} TonemapSumData;
+
+static void tonemap_sum_rows(void *userdata, int start, int end)
+{
+	TonemapSumData *data = (TonemapSumData *)userdata;
+	const int width = data->tile->getWidth();
+
+	for (int y = start; y < end; y++) {
+		TonemapRowSums *row = &data->rows[y];
+		float *bc = &data->tile->getBuffer()[y * width * COM_NUMBER_OF_CHANNELS];
+		int p = width;
+
+		row->Lav = 0.0f;
+		zero_v3(row->cav);
+		row->lsum = 0.0f;
+		row->maxl = -1e10f;
+		row->minl = 1e10f;
+		while (p--) {
+			float L = rgb_to_luma_y(bc);
+			row->Lav += L;
+			add_v3_v3(row->cav, bc);
+			row->lsum += logf(MAX2(L, 0.0f) + 1e-5f);
+			row->maxl = (L > row->maxl) ? L : row->maxl;
+			row->minl = (L < row->minl) ? L : row->minl;
+			bc += 4;
+		}
+	}
+}
+
 void *TonemapOperation::initializeTileData(rcti *rect)
 {
 	lockMutex();
 	if (this->m_cachedInstance == NULL) {
 		MemoryBuffer *tile = (MemoryBuffer *)this->m_imageReader->initializeTileData(rect);
 		AvgLogLum *data = new AvgLogLum();
+		TonemapSumData sum_data;
+		const int height = tile->getHeight();
 
-		float *buffer = tile->getBuffer();
+		sum_data.tile = tile;
+		sum_data.rows = (TonemapRowSums *)MEM_mallocN(sizeof(TonemapRowSums) * height, __func__);
+		WorkScheduler::parallelRange(height, 16, tonemap_sum_rows, &sum_data);
 
 		float lsum = 0.0f;
-		int p = tile->getWidth() * tile->getHeight();
-		float *bc = buffer;
+		int p = tile->getWidth() * height;
 		float avl, maxl = -1e10f, minl = 1e10f;
 		const float sc = 1.0f / p;
 		float Lav = 0.f;
 		float cav[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-		while (p--) {
-			float L = rgb_to_luma_y(bc);
-			Lav += L;
-			add_v3_v3(cav, bc);
-			lsum += logf(MAX2(L, 0.0f) + 1e-5f);
-			maxl = (L > maxl) ? L : maxl;
-			minl = (L < minl) ? L : minl;
-			bc += 4;
+		for (int y = 0; y < height; y++) {
+			const TonemapRowSums *row = &sum_data.rows[y];
+			Lav += row->Lav;
+			add_v3_v3(cav, row->cav);
+			lsum += row->lsum;
+			maxl = max(maxl, row->maxl);
+			minl = min(minl, row->minl);
 		}
+		MEM_freeN(sum_data.rows);
+
 		data->lav = Lav * sc;
 		mul_v3_v3fl(data->cav, cav, sc);
 		maxl = log((double)maxl + 1e-5); minl = log((double)minl + 1e-5); avl = lsum * sc;
@@ -53,6 +53,7 @@
 #include "BKE_global.h"
 #include "BKE_library.h"
 #include "BKE_main.h"
+#include "BKE_node.h"
 #include "BKE_packedFile.h"
 #include "BKE_report.h"
 #include "BKE_screen.h"
@@ -1866,6 +1867,9 @@ static int image_reload_exec(bContext *C, wmOperator *UNUSED(op))
 	// XXX other users?
 	BKE_image_signal(ima, (sima) ? &sima->iuser : NULL, IMA_SIGNAL_RELOAD);
 
+	/* the compositor may still have results of the old image */
+	ntreeCompositClearCaches();
+
 	WM_event_add_notifier(C, NC_IMAGE | NA_EDITED, ima);
 	
 	return OPERATOR_FINISHED;
@@ -861,6 +861,12 @@ static void node_draw_basis(const bContext *C, ARegion *ar, SpaceNode *snode, bN
 	
 	nodeLabel(ntree, node, showname, sizeof(showname));
 	
+	/* compositor profiling results, the flag is set on the root tree */
+	if (snode->nodetree && (snode->nodetree->flag & NTREE_COM_PROFILE) && node->exec_time > 0.0f) {
+		const size_t len = strlen(showname);
+		BLI_snprintf(showname + len, sizeof(showname) - len, " (%.1f ms)", node->exec_time * 1000.0f);
+	}
+	
 	//if (node->flag & NODE_MUTED)
 	//	BLI_snprintf(showname, sizeof(showname), "[%s]", showname); /* XXX - don't print into self! */
 	
@@ -50,6 +50,7 @@
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
+#include "BKE_screen.h"
 
 #include "RE_engine.h"
 #include "RE_pipeline.h"
@@ -98,6 +99,8 @@ typedef struct CompoJob {
 	float *progress;
 	short need_sync;
 	int recalc_flags;
+	bool use_viewer_visible;
+	rctf viewer_visible;
 } CompoJob;
 
 static void compo_tag_output_nodes(bNodeTree *nodetree, int recalc_flags)
@@ -151,6 +154,54 @@ static int compo_get_recalc_flags(const bContext *C)
 	return recalc_flags;
 }
 
+/* part of the viewer image that is visible in node editor backdrops, in pixels relative to
+ * the image center. returns false when the whole viewer is needed */
+static bool compo_get_viewer_visible(const bContext *C, rctf *r_visible)
+{
+	wmWindowManager *wm = CTX_wm_manager(C);
+	wmWindow *win;
+	bool found = false;
+
+	for (win = wm->windows.first; win; win = win->next) {
+		bScreen *sc = win->screen;
+		ScrArea *sa;
+
+		for (sa = sc->areabase.first; sa; sa = sa->next) {
+			if (sa->spacetype == SPACE_IMAGE) {
+				SpaceImage *sima = sa->spacedata.first;
+				if (sima->image && sima->image->type == IMA_TYPE_COMPOSITE)
+					return false;
+			}
+			else if (sa->spacetype == SPACE_NODE) {
+				SpaceNode *snode = sa->spacedata.first;
+				ARegion *ar = BKE_area_find_region_type(sa, RGN_TYPE_WINDOW);
+				rctf visible;
+
+				if (!(snode->flag & SNODE_BACKDRAW) || !ED_node_is_compositor(snode) || ar == NULL)
+					continue;
+				if (snode->zoom <= 0.0f)
+					return false;
+
+				/* inverse of the backdrop placement in draw_nodespace_back_pix */
+				visible.xmin = -(ar->winx * 0.5f + snode->xof) / snode->zoom;
+				visible.xmax =  (ar->winx * 0.5f - snode->xof) / snode->zoom;
+				visible.ymin = -(ar->winy * 0.5f + snode->yof) / snode->zoom;
+				visible.ymax =  (ar->winy * 0.5f - snode->yof) / snode->zoom;
+
+				if (found) {
+					BLI_rctf_union(r_visible, &visible);
+				}
+				else {
+					*r_visible = visible;
+					found = true;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
 /* called by compo, only to check job 'stop' value */
 static int compo_breakjob(void *cjv)
 {
@@ -202,6 +253,11 @@ static void compo_initjob(void *cjv)
 
 	if (cj->recalc_flags)
 		compo_tag_output_nodes(cj->localtree, cj->recalc_flags);
+
+	if (cj->use_viewer_visible)
+		cj->localtree->viewer_visible = cj->viewer_visible;
+	else
+		cj->localtree->flag &= ~NTREE_VIEWER_VISIBLE;
 }
 
 /* called before redraw notifiers, it moves finished previews over */
@@ -292,6 +348,8 @@ void ED_node_composite_job(const bContext *C, struct bNodeTree *nodetree, Scene
 	cj->scene = scene;
 	cj->ntree = nodetree;
 	cj->recalc_flags = compo_get_recalc_flags(C);
+	if (nodetree->flag & NTREE_VIEWER_VISIBLE)
+		cj->use_viewer_visible = compo_get_viewer_visible(C, &cj->viewer_visible);
 
 	/* setup job */
 	WM_jobs_customdata_set(wm_job, cj, compo_freejob);
@@ -194,6 +194,14 @@ void NODE_OT_view_selected(wmOperatorType *ot)
 
 /* **************** Backround Image Operators ************** */
 
+/* with the viewer visible area option the compositor only calculates the part of the
+ * viewer that is visible in the backdrop, so it is refreshed when that changes */
+static void snode_bg_visible_area_changed(bContext *C, SpaceNode *snode)
+{
+	if (snode->nodetree && (snode->nodetree->flag & NTREE_VIEWER_VISIBLE))
+		ED_area_tag_refresh(CTX_wm_area(C));
+}
+
 typedef struct NodeViewMove {
 	int mvalo[2];
 	int xmin, ymin, xmax, ymax;
@@ -226,6 +234,8 @@ static int snode_bg_viewmove_modal(bContext *C, wmOperator *op, const wmEvent *e
 		case MIDDLEMOUSE:
 		case RIGHTMOUSE:
 
+			snode_bg_visible_area_changed(C, snode);
+
 			MEM_freeN(nvm);
 			op->customdata = NULL;
 
@@ -303,6 +313,7 @@ static int backimage_zoom_exec(bContext *C, wmOperator *op)
 
 	snode->zoom *= fac;
 	ED_region_tag_redraw(ar);
+	snode_bg_visible_area_changed(C, snode);
 	WM_main_add_notifier(NC_NODE | ND_DISPLAY, NULL);
 
 	return OPERATOR_FINISHED;
@@ -361,6 +372,7 @@ static int backimage_fit_exec(bContext *C, wmOperator *UNUSED(op))
 	snode->yof = 0;
 
 	ED_region_tag_redraw(ar);
+	snode_bg_visible_area_changed(C, snode);
 	WM_main_add_notifier(NC_NODE | ND_DISPLAY, NULL);
 
 	return OPERATOR_FINISHED;
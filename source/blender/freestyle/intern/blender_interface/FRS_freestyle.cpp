@@ -95,7 +95,8 @@ static bCallbackFuncStore load_post_callback_funcstore = {
 	NULL, NULL, /* next, prev */
 	load_post_callback, /* func */
 	NULL, /* arg */
-	0 /* alloc */
+	0, /* alloc */
+	NULL /* poll */
 };
 
 //=======================================================
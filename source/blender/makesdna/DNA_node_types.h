@@ -213,7 +213,7 @@ typedef struct bNode {
 	 * and replacing all uses with per-instance data.
 	 */
 	short preview_xsize, preview_ysize;	/* reserved size of the preview rect */
-	int pad2;
+	float exec_time;		/* runtime, time in seconds spent in the node by the last compositor execution (profiling) */
 	struct uiBlock *block;	/* runtime during drawing */
 } bNode;
 
@@ -355,6 +355,8 @@ typedef struct bNodeTree {
 	int chunksize;					/* tile size for compositor engine */
 	
 	rctf viewer_border;
+	rctf viewer_visible;			/* part of the viewer visible in the node editor backdrop, runtime,
+									 * in pixels relative to the center of the image */
 	
 	/* Lists of bNodeSocket to hold default values and own_index.
 	 * Warning! Don't make links to these sockets, input/output nodes are used for that.
@@ -406,6 +408,8 @@ typedef struct bNodeTree {
 #define NTREE_COM_GROUPNODE_BUFFER	8	/* use groupnode buffers */
 #define NTREE_VIEWER_BORDER			16	/* use a border for viewer nodes */
 #define NTREE_IS_LOCALIZED			32	/* tree is localized copy, free when deleting node groups */
+#define NTREE_VIEWER_VISIBLE		64	/* only calculate the part of viewer nodes visible in the backdrop */
+#define NTREE_COM_PROFILE			128	/* measure execution time of nodes */
 
 /* XXX not nice, but needed as a temporary flags
  * for group updates after library linking.
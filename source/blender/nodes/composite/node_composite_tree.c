@@ -169,6 +169,9 @@ static void local_merge(bNodeTree *localtree, bNodeTree *ntree)
 	
 	for (lnode = localtree->nodes.first; lnode; lnode = lnode->next) {
 		if (ntreeNodeExists(ntree, lnode->new_node)) {
+			/* profiling results */
+			lnode->new_node->exec_time = lnode->exec_time;
+			
 			if (ELEM(lnode->type, CMP_NODE_VIEWER, CMP_NODE_SPLITVIEWER)) {
 				if (lnode->id && (lnode->flag & NODE_DO_OUTPUT)) {
 					/* image_merge does sanity check for pointers */
@@ -400,6 +403,14 @@ void ntreeCompositTagGenerators(bNodeTree *ntree)
 	}
 }
 
+/* free results the compositor keeps between executions, for when the data they depend on changed */
+void ntreeCompositClearCaches(void)
+{
+#ifdef WITH_COMPOSITOR
+	COM_clearCaches();
+#endif
+}
+
 /* XXX after render animation system gets a refresh, this call allows composite to end clean */
 void ntreeCompositClearTags(bNodeTree *ntree)
 {
@@ -40,6 +40,7 @@
 #include "BPY_extern.h"
 
 void bpy_app_generic_callback(struct Main *main, struct ID *id, void *arg);
+static int bpy_app_generic_callback_poll(void *arg);
 
 static PyTypeObject BlenderAppCbType;
 
@@ -229,6 +230,7 @@ PyObject *BPY_app_handlers_struct(void)
 			funcstore->func = bpy_app_generic_callback;
 			funcstore->alloc = 0;
 			funcstore->arg = SET_INT_IN_POINTER(pos);
+			funcstore->poll = bpy_app_generic_callback_poll;
 			BLI_callback_add(funcstore, pos);
 		}
 	}
@@ -279,6 +281,12 @@ void BPY_app_handlers_reset(const short do_all)
 	}
 }
 
+/* any python handlers in the list, only reads the list size so no GIL is needed */
+static int bpy_app_generic_callback_poll(void *arg)
+{
+	return PyList_GET_SIZE(py_cb_array[GET_INT_FROM_POINTER(arg)]) > 0;
+}
+
 /* the actual callback - not necessarily called from py */
 void bpy_app_generic_callback(struct Main *UNUSED(main), struct ID *id, void *arg)
 {
@@ -145,6 +145,8 @@ struct Render
 	 * write lock, all external code must use a read lock. internal code is assumed
 	 * to not conflict with writes, so no lock used for that */
 	ThreadRWMutex resultmutex;
+	/* incremented when result is replaced or rendered, so caches of it can be validated */
+	unsigned int result_version;
 	
 	/* window size, display rect, viewplane */
 	int winx, winy;			/* buffer width and height with percentage applied
@@ -131,7 +131,9 @@ Render R;
 
 /* ********* alloc and free ******** */
 
-static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovieHandle *mh, const char *name_override);
+typedef struct RenderAnimPipeline RenderAnimPipeline;
+static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovieHandle *mh, const char *name_override,
+                                   RenderAnimPipeline *pipeline);
 
 static volatile int g_break = 0;
 static int thread_break(void *UNUSED(arg))
@@ -278,9 +280,17 @@ void RE_SwapResult(Render *re, RenderResult **rr)
 	/* for keeping render buffers */
 	if (re) {
 		SWAP(RenderResult *, re->result, *rr);
+		re->result_version++;
 	}
 }
 
+/* changes when the render result is replaced or rendered again, used by the compositor
+ * to detect that render layers it cached are outdated */
+unsigned int RE_GetResultVersion(Render *re)
+{
+	return re->result_version;
+}
+
 
 void RE_ReleaseResult(Render *re)
 {
@@ -2310,8 +2320,13 @@ static void do_render_all_options(Render *re)
 
 	re->i.starttime = PIL_check_seconds_timer();
 
-	/* ensure no images are in memory from previous animated sequences */
-	BKE_image_all_free_anim_ibufs(re->r.cfra);
+	/* incremented again when done, the result can be read while it is rendered */
+	re->result_version++;
+
+	/* ensure no images are in memory from previous animated sequences,
+	 * animations do this in render_anim_pipeline_free_anim_ibufs, keeping the prefetched frames */
+	if ((re->flag & R_ANIMATION) == 0)
+		BKE_image_all_free_anim_ibufs(re->r.cfra);
 
 	if (RE_engine_render(re, 1)) {
 		/* in this case external render overrides all */
@@ -2334,6 +2349,7 @@ static void do_render_all_options(Render *re)
 	}
 	
 	re->i.lastframetime = PIL_check_seconds_timer() - re->i.starttime;
+	re->result_version++;
 	
 	re->stats_draw(re->sdh, &re->i);
 	
@@ -2671,7 +2687,7 @@ void RE_BlenderFrame(Render *re, Main *bmain, Scene *scene, SceneRenderLayer *sr
 				                  &scene->r.im_format, (scene->r.scemode & R_EXTENSION) != 0, false);
 
 				/* reports only used for Movie */
-				do_write_image_or_movie(re, bmain, scene, NULL, name);
+				do_write_image_or_movie(re, bmain, scene, NULL, name, NULL);
 			}
 		}
 
@@ -2696,7 +2712,209 @@ void RE_RenderFreestyleStrokes(Render *re, Main *bmain, Scene *scene, int render
 }
 #endif
 
-static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovieHandle *mh, const char *name_override)
+/* ************************************************************************ */
+/* Frame pipelining of animation renders
+ *
+ * While a frame is rendered, the previous frame is written to disk and the image
+ * sequences used by the compositor are loaded for the next frame, each in a background
+ * thread. At most one frame is written and one frame is prefetched at a time.
+ * When there are render_post handlers the write is finished before they run.
+ */
+
+typedef struct RenderAnimPrefetch {
+	struct RenderAnimPrefetch *next, *prev;
+	Image *ima;
+	ImageUser iuser;
+	int cfra;
+	int cur_frame, frame;  /* image frames used by the current and the prefetched scene frame */
+} RenderAnimPrefetch;
+
+typedef struct RenderAnimWrite {
+	ImBuf *ibuf;
+	char name[FILE_MAX];
+	ImageFormatData im_format;
+	bool ok;
+} RenderAnimWrite;
+
+struct RenderAnimPipeline {
+	ListBase write_thread;
+	RenderAnimWrite *write;
+
+	ListBase prefetch_thread;
+	ListBase prefetch;  /* RenderAnimPrefetch */
+};
+
+static void *render_anim_write_thread(void *data)
+{
+	RenderAnimWrite *write = data;
+
+	/* reported by render_anim_pipeline_write_finish, so the output stays in order */
+	write->ok = BKE_imbuf_write(write->ibuf, write->name, &write->im_format) != 0;
+
+	return NULL;
+}
+
+static void *render_anim_prefetch_thread(void *data)
+{
+	ListBase *prefetch = data;
+	RenderAnimPrefetch *item;
+
+	for (item = prefetch->first; item; item = item->next)
+		BKE_image_prefetch_frame(item->ima, &item->iuser, item->cfra);
+
+	return NULL;
+}
+
+/* can the frame be written in the background, the render result is copied for that */
+static bool render_anim_pipeline_can_write(const ImageFormatData *imf)
+{
+	/* the copy doesn't include the z-buffer */
+	if (imf->flag & R_IMF_FLAG_ZBUF)
+		return false;
+	/* the preview is converted with the view settings of the scene */
+	if (imf->imtype == R_IMF_IMTYPE_OPENEXR && (imf->flag & R_IMF_FLAG_PREVIEW_JPG))
+		return false;
+
+	return true;
+}
+
+/* wait until the previous frame is written, returns false when writing failed */
+static bool render_anim_pipeline_write_finish(RenderAnimPipeline *pipeline)
+{
+	bool ok = true;
+
+	if (pipeline->write) {
+		BLI_end_threads(&pipeline->write_thread);
+
+		ok = pipeline->write->ok;
+		if (ok)
+			printf("Saved: %s\n", pipeline->write->name);
+		else
+			printf("Render error: cannot save %s\n", pipeline->write->name);
+		fflush(stdout);
+
+		IMB_freeImBuf(pipeline->write->ibuf);
+		MEM_freeN(pipeline->write);
+		pipeline->write = NULL;
+	}
+
+	return ok;
+}
+
+static bool render_anim_pipeline_write(RenderAnimPipeline *pipeline, Scene *scene, Object *camera,
+                                       ImBuf *ibuf, const char *name)
+{
+	RenderAnimWrite *write;
+
+	if (!render_anim_pipeline_write_finish(pipeline))
+		return false;
+
+	write = MEM_callocN(sizeof(RenderAnimWrite), "RenderAnimWrite");
+
+	/* the pixels are shared with the render result, which is reused by the next frame */
+	write->ibuf = IMB_dupImBuf(ibuf);
+	if (scene->r.stamp & R_STAMP_ALL)
+		BKE_imbuf_stamp_info(scene, camera, write->ibuf);
+
+	BLI_strncpy(write->name, name, sizeof(write->name));
+	write->im_format = scene->r.im_format;
+
+	pipeline->write = write;
+	BLI_init_threads(&pipeline->write_thread, render_anim_write_thread, 1);
+	BLI_insert_thread(&pipeline->write_thread, write);
+
+	return true;
+}
+
+static void render_anim_prefetch_nodetree(ListBase *prefetch, bNodeTree *ntree, int cur_cfra, int cfra)
+{
+	bNode *node;
+
+	for (node = ntree->nodes.first; node; node = node->next) {
+		if (node->flag & NODE_MUTED)
+			continue;
+
+		if (node->type == CMP_NODE_IMAGE && node->id && node->storage) {
+			Image *ima = (Image *)node->id;
+
+			/* the image type is checked by BKE_image_prefetch_frame, under the image lock */
+			if (ima->source == IMA_SRC_SEQUENCE) {
+				RenderAnimPrefetch *item = MEM_callocN(sizeof(RenderAnimPrefetch), "RenderAnimPrefetch");
+				item->ima = ima;
+				item->iuser = *(ImageUser *)node->storage;
+				item->cfra = cfra;
+				item->cur_frame = BKE_image_user_frame_get(&item->iuser, cur_cfra, 0, NULL);
+				item->frame = BKE_image_user_frame_get(&item->iuser, cfra, 0, NULL);
+				BLI_addtail(prefetch, item);
+			}
+		}
+		else if (node->type == NODE_GROUP && node->id) {
+			render_anim_prefetch_nodetree(prefetch, (bNodeTree *)node->id, cur_cfra, cfra);
+		}
+	}
+}
+
+static void render_anim_pipeline_prefetch_finish(RenderAnimPipeline *pipeline)
+{
+	if (pipeline->prefetch.first) {
+		BLI_end_threads(&pipeline->prefetch_thread);
+		BLI_freelistN(&pipeline->prefetch);
+	}
+}
+
+/* load the image sequences of the compositor for frame cfra */
+static void render_anim_pipeline_prefetch(RenderAnimPipeline *pipeline, Scene *scene, int cfra)
+{
+	render_anim_pipeline_prefetch_finish(pipeline);
+
+	if (!(scene->r.scemode & R_DOCOMP) || !scene->use_nodes || !scene->nodetree)
+		return;
+
+	render_anim_prefetch_nodetree(&pipeline->prefetch, scene->nodetree, scene->r.cfra, cfra);
+
+	if (pipeline->prefetch.first) {
+		BLI_init_threads(&pipeline->prefetch_thread, render_anim_prefetch_thread, 1);
+		BLI_insert_thread(&pipeline->prefetch_thread, &pipeline->prefetch);
+	}
+}
+
+/* free the frames of animated images, except those used by the current and the prefetched
+ * frame. Image frames can have an offset from the scene frame, so the frames of images that
+ * are prefetched are taken from the prefetch list, other images keep the current scene frame */
+static void render_anim_pipeline_free_anim_ibufs(RenderAnimPipeline *pipeline, Render *re)
+{
+	Image *ima;
+
+	for (ima = re->main->image.first; ima; ima = ima->id.next) {
+		RenderAnimPrefetch *item;
+		int sfra = INT_MAX, efra = INT_MIN;
+
+		if (!BKE_image_is_animated(ima))
+			continue;
+
+		for (item = pipeline->prefetch.first; item; item = item->next) {
+			if (item->ima == ima) {
+				sfra = min_iii(sfra, item->cur_frame, item->frame);
+				efra = max_iii(efra, item->cur_frame, item->frame);
+			}
+		}
+
+		if (sfra > efra)
+			sfra = efra = re->r.cfra;
+
+		BKE_image_free_anim_ibufs_range(ima, sfra, efra);
+	}
+}
+
+/* wait for all background work, returns false when writing failed */
+static bool render_anim_pipeline_finish(RenderAnimPipeline *pipeline)
+{
+	render_anim_pipeline_prefetch_finish(pipeline);
+	return render_anim_pipeline_write_finish(pipeline);
+}
+
+static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovieHandle *mh, const char *name_override,
+                                   RenderAnimPipeline *pipeline)
 {
 	char name[FILE_MAX];
 	RenderResult rres;
@@ -2755,12 +2973,19 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 			IMB_colormanagement_imbuf_for_write(ibuf, true, false, &scene->view_settings,
 			                                    &scene->display_settings, &scene->r.im_format);
 
-			ok = BKE_imbuf_write_stamp(scene, camera, ibuf, name, &scene->r.im_format);
-			
-			if (ok == 0) {
-				printf("Render error: cannot save %s\n", name);
+			if (pipeline && render_anim_pipeline_can_write(&scene->r.im_format)) {
+				/* written in the background while the next frame is rendered */
+				ok = render_anim_pipeline_write(pipeline, scene, camera, ibuf, name);
+				printf("Saving: %s", name);
+			}
+			else {
+				ok = BKE_imbuf_write_stamp(scene, camera, ibuf, name, &scene->r.im_format);
+				
+				if (ok == 0) {
+					printf("Render error: cannot save %s\n", name);
+				}
+				else printf("Saved: %s", name);
 			}
-			else printf("Saved: %s", name);
 			
 			/* optional preview images for exr */
 			if (ok && scene->r.im_format.imtype == R_IMF_IMTYPE_OPENEXR && (scene->r.im_format.flag & R_IMF_FLAG_PREVIEW_JPG)) {
@@ -2808,6 +3033,7 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
                     unsigned int lay_override, int sfra, int efra, int tfra)
 {
 	bMovieHandle *mh = BKE_movie_handle_get(scene->r.im_format.imtype);
+	RenderAnimPipeline pipeline = {{NULL}};
 	int cfrao = scene->r.cfra;
 	int nfra, totrendered = 0, totskipped = 0;
 	
@@ -2854,7 +3080,7 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 				totrendered++;
 
 				if (re->test_break(re->tbh) == 0) {
-					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL))
+					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL, NULL))
 						G.is_break = true;
 				}
 
@@ -2914,6 +3140,13 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 
 			re->r.cfra = scene->r.cfra;     /* weak.... */
 
+			/* load the inputs of the next frame while this one is rendered */
+			if (scene->r.cfra + tfra <= efra)
+				render_anim_pipeline_prefetch(&pipeline, scene, scene->r.cfra + tfra);
+
+			/* on the last frame the previous prefetch list still has its frames */
+			render_anim_pipeline_free_anim_ibufs(&pipeline, re);
+
 			/* run callbacs before rendering, before the scene is updated */
 			BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_PRE);
 
@@ -2923,7 +3156,7 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 			
 			if (re->test_break(re->tbh) == 0) {
 				if (!G.is_break)
-					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL))
+					if (!do_write_image_or_movie(re, bmain, scene, mh, NULL, &pipeline))
 						G.is_break = true;
 			}
 			else
@@ -2941,11 +3174,22 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 			}
 
 			if (G.is_break == false) {
+				/* handlers may read the saved file, so it has to be written first */
+				if (BLI_callback_poll(BLI_CB_EVT_RENDER_POST)) {
+					if (!render_anim_pipeline_write_finish(&pipeline)) {
+						G.is_break = true;
+						break;
+					}
+				}
+
 				BLI_callback_exec(re->main, (ID *)scene, BLI_CB_EVT_RENDER_POST); /* keep after file save */
 			}
 		}
 	}
 	
+	if (!render_anim_pipeline_finish(&pipeline))
+		G.is_break = true;
+
 	/* end movie */
 	if (BKE_imtype_is_movie(scene->r.im_format.imtype))
 		mh->end_movie();
@@ -3030,6 +3274,7 @@ bool RE_ReadRenderResult(Scene *scene, Scene *scenode)
 	
 	BLI_rw_mutex_lock(&re->resultmutex, THREAD_LOCK_WRITE);
 	success = render_result_exr_file_read(re, 0);
+	re->result_version++;
 	BLI_rw_mutex_unlock(&re->resultmutex);
 
 	return success;
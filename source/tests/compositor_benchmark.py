@@ -0,0 +1,200 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Runs the compositor on a set of reference node trees and reports the throughput
+and the time spent in each node.
+
+The compositing of each file is executed with profiling enabled, which also
+disables the compositor result cache. Files without render layer nodes only run
+the compositor, otherwise the render time is included in the frame times.
+
+Example Usage:
+
+./blender.bin --background -noaudio --factory-startup \
+    --python source/tests/compositor_benchmark.py -- \
+    --path="/data/compositor_trees" \
+    --match="*.blend" \
+    --frames=10 \
+    --nodes=5 \
+    --report=/tmp/compositor_benchmark.txt
+"""
+
+import os
+import sys
+import time
+
+
+def benchmark_file(filepath, frames, num_nodes, out):
+    import bpy
+
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+
+    scene = bpy.context.scene
+    tree = scene.node_tree
+    if not scene.use_nodes or tree is None:
+        out.write("%s: no compositing nodes, skipped\n" % filepath)
+        return None
+
+    tree.use_profiling = True
+    scene.render.use_compositing = True
+    scene.render.use_sequencer = False
+
+    rd = scene.render
+    scale = rd.resolution_percentage / 100.0
+    pixels = int(rd.resolution_x * scale) * int(rd.resolution_y * scale)
+
+    node_times = {node.name: 0.0 for node in tree.nodes}
+    frame_times = []
+
+    for i in range(frames):
+        scene.frame_set(scene.frame_start + (i % (scene.frame_end - scene.frame_start + 1)))
+
+        t = time.time()
+        bpy.ops.render.render()
+        frame_times.append(time.time() - t)
+
+        for node in tree.nodes:
+            node_times[node.name] += node.execution_time
+
+    total = sum(frame_times)
+    out.write("%s\n" % filepath)
+    out.write("  frames: %d, resolution: %d pixels\n" % (frames, pixels))
+    out.write("  frame time: min %.3f s, mean %.3f s, max %.3f s\n" %
+              (min(frame_times), total / frames, max(frame_times)))
+    out.write("  throughput: %.3f frames/s, %.2f megapixels/s\n" %
+              (frames / total, frames * pixels / total / 1e6))
+
+    node_total = sum(node_times.values())
+    out.write("  node time: %.3f s per frame\n" % (node_total / frames))
+    for name, node_time in sorted(node_times.items(), key=lambda item: -item[1])[:num_nodes]:
+        if node_time > 0.0:
+            out.write("    %10.2f ms %6.2f%%  %s\n" %
+                      (node_time / frames * 1000.0, 100.0 * node_time / node_total, name))
+    out.write("\n")
+    out.flush()
+
+    return total, frames, frames * pixels
+
+
+def compositor_benchmark(path="",
+                         match="*.blend",
+                         frames=1,
+                         nodes=10,
+                         report="",
+                         ):
+    import fnmatch
+
+    path = os.path.abspath(os.path.normpath(path))
+
+    files = []
+    if os.path.isfile(path):
+        files.append(path)
+    else:
+        for dirpath, dirnames, filenames in os.walk(path):
+            dirnames.sort()
+            for filename in sorted(filenames):
+                if fnmatch.fnmatch(filename, match):
+                    files.append(os.path.join(dirpath, filename))
+
+    if not files:
+        print("No files found in %r matching %r" % (path, match))
+        return
+
+    outputs = [sys.stdout]
+    if report:
+        outputs.append(open(report, "w"))
+
+    class Tee:
+        def write(self, text):
+            for out in outputs:
+                out.write(text)
+
+        def flush(self):
+            for out in outputs:
+                out.flush()
+
+    out = Tee()
+
+    total_time = 0.0
+    total_frames = 0
+    total_pixels = 0
+    for filepath in files:
+        result = benchmark_file(filepath, frames, nodes, out)
+        if result:
+            total_time += result[0]
+            total_frames += result[1]
+            total_pixels += result[2]
+
+    if total_time > 0.0:
+        out.write("Total: %d files, %d frames in %.3f s, %.3f frames/s, %.2f megapixels/s\n" %
+                  (len(files), total_frames, total_time,
+                   total_frames / total_time, total_pixels / total_time / 1e6))
+    out.flush()
+
+    for out in outputs[1:]:
+        out.close()
+
+
+def main():
+    import optparse
+
+    # get the args passed to blender after "--", all of which are ignored by blender specifically
+    # so python may receive its own arguments
+    argv = sys.argv
+
+    if "--" not in argv:
+        argv = []  # as if no args are passed
+    else:
+        argv = argv[argv.index("--") + 1:]  # get all args after "--"
+
+    # When --help or no args are given, print this help
+    usage_text = ("Run blender in background mode with this script:\n"
+                  "  blender --background --python " + __file__ + " -- [options]")
+
+    parser = optparse.OptionParser(usage=usage_text)
+
+    parser.add_option("-p", "--path", dest="path",
+                      help="Blend file or directory with reference node trees", metavar="PATH")
+    parser.add_option("-m", "--match", dest="match", default="*.blend",
+                      help="Wildcard to match blend files in the directory", metavar="MATCH")
+    parser.add_option("-f", "--frames", dest="frames", type="int", default=1,
+                      help="Number of frames to composite per file", metavar="FRAMES")
+    parser.add_option("-n", "--nodes", dest="nodes", type="int", default=10,
+                      help="Number of slowest nodes to report per file", metavar="NODES")
+    parser.add_option("-r", "--report", dest="report", default="",
+                      help="Also write the report to this file", metavar="FILE")
+
+    options, args = parser.parse_args(argv)
+
+    if not options.path:
+        parser.print_help()
+        return
+
+    compositor_benchmark(path=options.path,
+                         match=options.match,
+                         frames=max(options.frames, 1),
+                         nodes=options.nodes,
+                         report=options.report,
+                         )
+
+
+if __name__ == "__main__":
+    main()
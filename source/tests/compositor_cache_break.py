@@ -0,0 +1,129 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# ./blender.bin --background -noaudio --factory-startup --python source/tests/compositor_cache_break.py
+
+"""
+Checks that a cancelled compositor execution leaves nothing in the result cache.
+
+With debug value 3001 the compositor cancels its execution after a number of
+break checks, in the middle of calculating the buffers of the blur nodes. The
+next execution must calculate them again and give the same result as an
+execution without the result cache.
+"""
+
+import os
+import shutil
+import tempfile
+import unittest
+
+import bpy
+
+DEBUG_BREAK_VALUE = 3001
+
+
+def setup_scene():
+    scene = bpy.context.scene
+    render = scene.render
+    render.resolution_x = 512
+    render.resolution_y = 512
+    render.resolution_percentage = 100
+    render.use_compositing = True
+    render.use_sequencer = False
+    render.image_settings.file_format = 'OPEN_EXR'
+
+    scene.use_nodes = True
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    # no render layers, so only the compositor runs
+    mask = tree.nodes.new("CompositorNodeEllipseMask")
+    mask.width = 0.4
+    mask.height = 0.2
+
+    blur_x = tree.nodes.new("CompositorNodeBlur")
+    blur_x.filter_type = 'GAUSS'
+    blur_x.size_x = 40
+
+    blur_y = tree.nodes.new("CompositorNodeBlur")
+    blur_y.filter_type = 'GAUSS'
+    blur_y.size_y = 40
+
+    composite = tree.nodes.new("CompositorNodeComposite")
+
+    tree.links.new(mask.outputs[0], blur_x.inputs[0])
+    tree.links.new(blur_x.outputs[0], blur_y.inputs[0])
+    tree.links.new(blur_y.outputs[0], composite.inputs[0])
+
+    return tree
+
+
+def render_pixels(filepath):
+    bpy.ops.render.render()
+    bpy.data.images["Render Result"].save_render(filepath)
+
+    image = bpy.data.images.load(filepath)
+    pixels = list(image.pixels)
+    bpy.data.images.remove(image)
+
+    return pixels
+
+
+class CompositorCacheBreakTesting(unittest.TestCase):
+    def setUp(self):
+        self.tree = setup_scene()
+        self.tempdir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        bpy.app.debug_value = 0
+        shutil.rmtree(self.tempdir)
+
+    def test_cancelled_execution_not_cached(self):
+        # profiling disables the result cache
+        self.tree.use_profiling = True
+        reference = render_pixels(os.path.join(self.tempdir, "reference.exr"))
+        self.tree.use_profiling = False
+
+        bpy.app.debug_value = DEBUG_BREAK_VALUE
+        bpy.ops.render.render()
+        bpy.app.debug_value = 0
+
+        result = render_pixels(os.path.join(self.tempdir, "result.exr"))
+
+        self.assertEqual(len(result), len(reference))
+        max_error = max(abs(a - b) for a, b in zip(result, reference))
+        self.assertLess(max_error, 1e-5)
+
+
+def test_main():
+    from test import support
+
+    try:
+        support.run_unittest(CompositorCacheBreakTesting)
+    except:
+        import traceback
+        traceback.print_exc()
+
+        # alert CTest we failed
+        import sys
+        sys.exit(1)
+
+if __name__ == '__main__':
+    test_main()